@@ -19,7 +19,9 @@
 #ifndef MCP23016_H
 #define MCP23016_H
 
+#include <stddef.h>
 #include <stdint.h>
+#include <time.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -35,6 +37,19 @@ extern "C" {
  * @{
  */
 
+/**
+ * @brief Maximum number of samples that may be captured by
+ * mcp23016_get_port_burst().
+ *
+ * The Linux i2c-dev driver rejects messages longer than 8192 bytes.
+ */
+#define MCP23016_BURST_MAX	(8192 / sizeof(uint16_t))
+
+/**
+ * @brief Maximum number of MCP23016 devices on a single I2C bus.
+ */
+#define MCP23016_DEVICE_MAX	8
+
 /**
  * @enum mcp23016_control
  * @brief Enum that describes I/O control values.
@@ -44,6 +59,26 @@ enum mcp23016_control {
 	MCP23016_CONTROL_IARES_FAST = 1		/**< Fast interrupt activity resolution (200us). */
 };
 
+/**
+ * @enum mcp23016_port
+ * @brief Enum that describes 8-bit ports.
+ */
+enum mcp23016_port {
+	MCP23016_PORT_0 = 0,	/**< Port 0 (@c GP0.0 - @c GP0.7). */
+	MCP23016_PORT_1 = 1	/**< Port 1 (@c GP1.0 - @c GP1.7). */
+};
+
+/**
+ * @struct mcp23016_config
+ * @brief Structure that describes a device configuration.
+ */
+struct mcp23016_config {
+	uint16_t output;	/**< Output latch value (@c OLAT0 and @c OLAT1). */
+	uint16_t polarity;	/**< Input polarity value (@c IPOL0 and @c IPOL1). */
+	uint16_t direction;	/**< I/O direction value (@c IODIR0 and @c IODIR1). */
+	uint16_t control;	/**< I/O control value (@c IOCON0 and @c IOCON1). */
+};
+
 /**
  * @struct mcp23016_device
  * @brief Handle to a MCP23016 device.
@@ -66,7 +101,8 @@ struct mcp23016_device *mcp23016_open(const char *path, unsigned int num);
  *
  * @param dev Pointer to a MCP23016 device handle.
  *
- * Once closed, @p dev is no longer valid for use.
+ * Once closed, @p dev is no longer valid for use. If @p dev was opened by
+ * calling mcp23016_open_on_bus(), its reference to the bus is released.
  */
 void mcp23016_close(struct mcp23016_device *dev);
 
@@ -77,9 +113,28 @@ void mcp23016_close(struct mcp23016_device *dev);
  * @param dev Pointer to a MCP23016 device handle.
  *
  * @return 0 on success, or -1 on error with @c errno set appropriately.
+ *
+ * This function applies the POR defaults using a single combined I2C
+ * transfer. Unlike mcp23016_configure(), all pins are made inputs before the
+ * output latches are cleared so that outputs are not momentarily driven low.
  */
 int mcp23016_reset(struct mcp23016_device *dev);
 
+/**
+ * @brief Apply a device configuration and clear interrupt status.
+ *
+ * @param dev    Pointer to a MCP23016 device handle.
+ * @param config Pointer to the configuration to apply.
+ *
+ * @return 0 on success, or -1 on error with @c errno set appropriately.
+ *
+ * This function writes each register described by @p config followed by a
+ * read of the @c INTCAP0 and @c INTCAP1 registers using a single combined I2C
+ * transfer. The output latches are written before the I/O direction so that
+ * pins configured as outputs do not drive stale values.
+ */
+int mcp23016_configure(struct mcp23016_device *dev, const struct mcp23016_config *config);
+
 /**
  * @brief Get the port value.
  *
@@ -106,6 +161,74 @@ int mcp23016_get_port(struct mcp23016_device *dev, uint16_t *val);
  */
 int mcp23016_set_port(struct mcp23016_device *dev, uint16_t val);
 
+/**
+ * @brief Get consecutive port values using a single read.
+ *
+ * @param dev     Pointer to a MCP23016 device handle.
+ * @param samples Pointer to an array of values to receive.
+ * @param n       Number of values to receive; must not exceed
+ *                #MCP23016_BURST_MAX.
+ *
+ * @return 0 on success, or -1 on error with @c errno set appropriately.
+ *
+ * This function returns @p n consecutive values of the @c GP0 and @c GP1
+ * registers in the low and high bytes, respectively. As the MCP23016
+ * alternates between the registers of a pair when read continuously, the
+ * register address is written only once, and each value costs two bytes on
+ * the bus.
+ */
+int mcp23016_get_port_burst(struct mcp23016_device *dev, uint16_t *samples, size_t n);
+
+/**
+ * @brief Set consecutive port values using continuous writes.
+ *
+ * @param dev   Pointer to a MCP23016 device handle.
+ * @param vals  Pointer to an array of values to set.
+ * @param n     Number of values in @p vals.
+ * @param count Number of times to output @p vals.
+ *
+ * @return 0 on success, or -1 on error with @c errno set appropriately.
+ *
+ * This function writes each value of @p vals to the @c GP0 and @c GP1
+ * registers in the low and high bytes, respectively, repeating the pattern
+ * @p count times. As the MCP23016 alternates between the registers of a pair
+ * when written continuously, values are streamed using as few messages as
+ * possible, and each value costs two bytes on the bus. The rate at which
+ * values are output is therefore determined by the I2C bus clock.
+ *
+ * If an error occurs, the number of values output is indeterminate.
+ */
+int mcp23016_set_port_stream(struct mcp23016_device *dev, const uint16_t *vals, size_t n,
+		unsigned int count);
+
+/**
+ * @brief Get the port value of a single 8-bit port.
+ *
+ * @param dev  Pointer to a MCP23016 device handle.
+ * @param port The port to access.
+ * @param val  Pointer to the value to receive.
+ *
+ * @return 0 on success, or -1 on error with @c errno set appropriately.
+ *
+ * This function returns the value of the @c GP0 or @c GP1 register
+ * using 8-bit access, which requires one less byte on the bus.
+ */
+int mcp23016_get_port8(struct mcp23016_device *dev, enum mcp23016_port port, uint8_t *val);
+
+/**
+ * @brief Set the port value of a single 8-bit port.
+ *
+ * @param dev  Pointer to a MCP23016 device handle.
+ * @param port The port to access.
+ * @param val  The value to set.
+ *
+ * @return 0 on success, or -1 on error with @c errno set appropriately.
+ *
+ * This function writes the value of the @c GP0 or @c GP1 register
+ * using 8-bit access, which requires one less byte on the bus.
+ */
+int mcp23016_set_port8(struct mcp23016_device *dev, enum mcp23016_port port, uint8_t val);
+
 /**
  * @brief Get the output latch value.
  *
@@ -132,6 +255,107 @@ int mcp23016_get_output(struct mcp23016_device *dev, uint16_t *val);
  */
 int mcp23016_set_output(struct mcp23016_device *dev, uint16_t val);
 
+/**
+ * @brief Get the output latch value of a single 8-bit port.
+ *
+ * @param dev  Pointer to a MCP23016 device handle.
+ * @param port The port to access.
+ * @param val  Pointer to the value to receive.
+ *
+ * @return 0 on success, or -1 on error with @c errno set appropriately.
+ *
+ * This function returns the value of the @c OLAT0 or @c OLAT1 register
+ * using 8-bit access, which requires one less byte on the bus.
+ */
+int mcp23016_get_output8(struct mcp23016_device *dev, enum mcp23016_port port, uint8_t *val);
+
+/**
+ * @brief Set the output latch value of a single 8-bit port.
+ *
+ * @param dev  Pointer to a MCP23016 device handle.
+ * @param port The port to access.
+ * @param val  The value to set.
+ *
+ * @return 0 on success, or -1 on error with @c errno set appropriately.
+ *
+ * This function writes the value of the @c OLAT0 or @c OLAT1 register
+ * using 8-bit access, which requires one less byte on the bus.
+ */
+int mcp23016_set_output8(struct mcp23016_device *dev, enum mcp23016_port port, uint8_t val);
+
+/**
+ * @brief Write output latch pins.
+ *
+ * @param dev  Pointer to a MCP23016 device handle.
+ * @param mask Mask of pins to modify.
+ * @param val  The value to set; bits not present in @p mask are ignored.
+ *
+ * @return 0 on success, or -1 on error with @c errno set appropriately.
+ *
+ * This function modifies the pins in @p mask of the @c OLAT0 and @c OLAT1
+ * registers in the low and high bytes, respectively. The output latch value
+ * last read from or written to the device is used as the basis for the new
+ * value, which permits pins to be modified using a single write regardless
+ * of whether the register cache is enabled. If the output latch value is not
+ * known, it is first read from the device. See mcp23016_invalidate_cache() if
+ * the device may have been modified by other means.
+ *
+ * If @p mask is confined to a single 8-bit port, the corresponding register
+ * is written using 8-bit access.
+ */
+int mcp23016_write_pins(struct mcp23016_device *dev, uint16_t mask, uint16_t val);
+
+/**
+ * @brief Set output latch pins.
+ *
+ * @param dev  Pointer to a MCP23016 device handle.
+ * @param mask Mask of pins to set.
+ *
+ * @return 0 on success, or -1 on error with @c errno set appropriately.
+ *
+ * This function is equivalent to calling:
+ * @code
+ * mcp23016_write_pins(dev, mask, mask);
+ * @endcode
+ */
+static inline int mcp23016_set_pins(struct mcp23016_device *dev, uint16_t mask)
+{
+	return mcp23016_write_pins(dev, mask, mask);
+}
+
+/**
+ * @brief Clear output latch pins.
+ *
+ * @param dev  Pointer to a MCP23016 device handle.
+ * @param mask Mask of pins to clear.
+ *
+ * @return 0 on success, or -1 on error with @c errno set appropriately.
+ *
+ * This function is equivalent to calling:
+ * @code
+ * mcp23016_write_pins(dev, mask, 0x0000);
+ * @endcode
+ */
+static inline int mcp23016_clear_pins(struct mcp23016_device *dev, uint16_t mask)
+{
+	return mcp23016_write_pins(dev, mask, 0x0000);
+}
+
+/**
+ * @brief Toggle output latch pins.
+ *
+ * @param dev  Pointer to a MCP23016 device handle.
+ * @param mask Mask of pins to toggle.
+ *
+ * @return 0 on success, or -1 on error with @c errno set appropriately.
+ *
+ * This function inverts the pins in @p mask of the @c OLAT0 and @c OLAT1
+ * registers in the low and high bytes, respectively. See
+ * mcp23016_write_pins() for details on how the output latch value is
+ * determined.
+ */
+int mcp23016_toggle_pins(struct mcp23016_device *dev, uint16_t mask);
+
 /**
  * @brief Get the input polarity value.
  *
@@ -158,6 +382,34 @@ int mcp23016_get_polarity(struct mcp23016_device *dev, uint16_t *val);
  */
 int mcp23016_set_polarity(struct mcp23016_device *dev, uint16_t val);
 
+/**
+ * @brief Get the input polarity value of a single 8-bit port.
+ *
+ * @param dev  Pointer to a MCP23016 device handle.
+ * @param port The port to access.
+ * @param val  Pointer to the value to receive.
+ *
+ * @return 0 on success, or -1 on error with @c errno set appropriately.
+ *
+ * This function returns the value of the @c IPOL0 or @c IPOL1 register
+ * using 8-bit access, which requires one less byte on the bus.
+ */
+int mcp23016_get_polarity8(struct mcp23016_device *dev, enum mcp23016_port port, uint8_t *val);
+
+/**
+ * @brief Set the input polarity value of a single 8-bit port.
+ *
+ * @param dev  Pointer to a MCP23016 device handle.
+ * @param port The port to access.
+ * @param val  The value to set.
+ *
+ * @return 0 on success, or -1 on error with @c errno set appropriately.
+ *
+ * This function writes the value of the @c IPOL0 or @c IPOL1 register
+ * using 8-bit access, which requires one less byte on the bus.
+ */
+int mcp23016_set_polarity8(struct mcp23016_device *dev, enum mcp23016_port port, uint8_t val);
+
 /**
  * @brief Get the I/O direction value.
  *
@@ -184,6 +436,34 @@ int mcp23016_get_direction(struct mcp23016_device *dev, uint16_t *val);
  */
 int mcp23016_set_direction(struct mcp23016_device *dev, uint16_t val);
 
+/**
+ * @brief Get the I/O direction value of a single 8-bit port.
+ *
+ * @param dev  Pointer to a MCP23016 device handle.
+ * @param port The port to access.
+ * @param val  Pointer to the value to receive.
+ *
+ * @return 0 on success, or -1 on error with @c errno set appropriately.
+ *
+ * This function returns the value of the @c IODIR0 or @c IODIR1 register
+ * using 8-bit access, which requires one less byte on the bus.
+ */
+int mcp23016_get_direction8(struct mcp23016_device *dev, enum mcp23016_port port, uint8_t *val);
+
+/**
+ * @brief Set the I/O direction value of a single 8-bit port.
+ *
+ * @param dev  Pointer to a MCP23016 device handle.
+ * @param port The port to access.
+ * @param val  The value to set.
+ *
+ * @return 0 on success, or -1 on error with @c errno set appropriately.
+ *
+ * This function writes the value of the @c IODIR0 or @c IODIR1 register
+ * using 8-bit access, which requires one less byte on the bus.
+ */
+int mcp23016_set_direction8(struct mcp23016_device *dev, enum mcp23016_port port, uint8_t val);
+
 /**
  * @brief Get the interrupt capture value.
  *
@@ -197,6 +477,40 @@ int mcp23016_set_direction(struct mcp23016_device *dev, uint16_t val);
  */
 int mcp23016_get_interrupt(struct mcp23016_device *dev, uint16_t *val);
 
+/**
+ * @struct mcp23016_interrupt_state
+ * @brief Struct that describes pin state when servicing an interrupt.
+ */
+struct mcp23016_interrupt_state {
+	uint16_t previous;	/**< Port value when the previous interrupt was serviced. */
+	uint16_t captured;	/**< Port value captured when the interrupt occurred. */
+	uint16_t current;	/**< Port value when the interrupt was serviced. */
+	uint16_t changed;	/**< Mask of pins that changed state at least once. */
+	uint16_t missed;	/**< Mask of pins that changed state more than once. */
+};
+
+/**
+ * @brief Service an interrupt by reading the captured and current port
+ * values.
+ *
+ * @param dev   Pointer to a MCP23016 device handle.
+ * @param state Pointer to the interrupt state.
+ *
+ * @return 0 on success, or -1 on error with @c errno set appropriately.
+ *
+ * This function reads the @c INTCAP0 and @c INTCAP1 registers followed by the
+ * @c GP0 and @c GP1 registers using a single combined transfer. As the
+ * device only captures the port value at the first change, pins that change
+ * state again before the interrupt is serviced are only visible in the
+ * current port value. Pins in @c missed passed through an intermediate state
+ * between @c previous and @c current, such as a pulse that returned to its
+ * previous value.
+ *
+ * The @c current field is used as the previous port value and must be
+ * initialized before the first call, eg. using mcp23016_get_port().
+ */
+int mcp23016_service_interrupt(struct mcp23016_device *dev, struct mcp23016_interrupt_state *state);
+
 /**
  * @brief Clear interrupt status.
  *
@@ -243,6 +557,140 @@ int mcp23016_get_control(struct mcp23016_device *dev, uint16_t *val);
  */
 int mcp23016_set_control(struct mcp23016_device *dev, uint16_t val);
 
+/**
+ * @brief Enable the register cache.
+ *
+ * @param dev Pointer to a MCP23016 device handle.
+ *
+ * The register cache holds shadow copies of the @c OLAT, @c IPOL, @c IODIR,
+ * and @c IOCON registers, which only change when written by the host. Once
+ * enabled, reads of these registers are served from the cache without
+ * accessing the I2C bus. Cache entries are populated whenever a register is
+ * read from or written to the device; see mcp23016_refresh_cache() to
+ * populate all entries at once. The @c GP and @c INTCAP registers are never
+ * cached.
+ *
+ * The register cache is disabled by default.
+ */
+void mcp23016_enable_cache(struct mcp23016_device *dev);
+
+/**
+ * @brief Disable the register cache.
+ *
+ * @param dev Pointer to a MCP23016 device handle.
+ *
+ * Once disabled, all register reads access the I2C bus.
+ */
+void mcp23016_disable_cache(struct mcp23016_device *dev);
+
+/**
+ * @brief Invalidate the register cache.
+ *
+ * @param dev Pointer to a MCP23016 device handle.
+ *
+ * This function should be called if the device may have been modified by
+ * means other than @p dev, such as another process or a power cycle.
+ */
+void mcp23016_invalidate_cache(struct mcp23016_device *dev);
+
+/**
+ * @brief Refresh the register cache.
+ *
+ * @param dev Pointer to a MCP23016 device handle.
+ *
+ * @return 0 on success, or -1 on error with @c errno set appropriately.
+ *
+ * This function reads each cacheable register from the device, replacing the
+ * contents of the cache.
+ */
+int mcp23016_refresh_cache(struct mcp23016_device *dev);
+
+/**
+ * @defgroup bus Shared Bus
+ *
+ * @brief Shared bus functions.
+ *
+ * These functions manage a handle to an I2C bus, which can be shared by
+ * multiple devices. Devices opened on a shared bus use a single I2C
+ * character device handle, which reduces file descriptor usage and permits
+ * combining transfers across devices. Use of these functions is considered
+ * optional.
+ *
+ * @{
+ */
+
+/**
+ * @struct mcp23016_bus
+ * @brief Handle to a shared I2C bus.
+ */
+struct mcp23016_bus;
+
+/**
+ * @brief Open the I2C bus specified by @p path.
+ *
+ * @param path Pointer to an I2C character device.
+ *
+ * @return Pointer to a shared bus handle, or @c NULL on error with @c errno
+ * set appropriately.
+ */
+struct mcp23016_bus *mcp23016_bus_open(const char *path);
+
+/**
+ * @brief Release a reference to a shared bus handle.
+ *
+ * @param bus Pointer to a shared bus handle.
+ *
+ * Shared bus handles are reference counted; each device opened on the bus
+ * holds a reference, which is released by mcp23016_close(). Once the last
+ * reference is released, the I2C character device handle is closed and
+ * associated memory is freed. The caller's reference to @p bus is no longer
+ * valid for use.
+ */
+void mcp23016_bus_close(struct mcp23016_bus *bus);
+
+/**
+ * @brief Open the MCP23016 device specified by @p num on a shared bus.
+ *
+ * @param bus Pointer to a shared bus handle.
+ * @param num Relative position of device on I2C bus (ie. @c AD0-2).
+ *
+ * @return Pointer to a MCP23016 device handle, or @c NULL on error with @c
+ * errno set appropriately.
+ *
+ * The device handle holds a reference to @p bus until closed by calling
+ * mcp23016_close().
+ */
+struct mcp23016_device *mcp23016_open_on_bus(struct mcp23016_bus *bus, unsigned int num);
+
+/**
+ * @struct mcp23016_output
+ * @brief Structure that describes an output latch value for a device.
+ */
+struct mcp23016_output {
+	struct mcp23016_device *dev;	/**< Pointer to a MCP23016 device handle. */
+	uint16_t val;			/**< The value to set. */
+};
+
+/**
+ * @brief Set the output latch values of multiple devices on a shared bus.
+ *
+ * @param bus     Pointer to a shared bus handle.
+ * @param outputs Pointer to an array of output latch values.
+ * @param n       Number of values in @p outputs; must not exceed
+ *                #MCP23016_DEVICE_MAX.
+ *
+ * @return 0 on success, or -1 on error with @c errno set appropriately.
+ *
+ * This function writes the value of the @c OLAT0 and @c OLAT1 registers of
+ * each device in @p outputs using a single combined I2C transfer, which
+ * minimizes skew between devices. Each device must have been opened on
+ * @p bus by calling mcp23016_open_on_bus().
+ */
+int mcp23016_bus_set_output(struct mcp23016_bus *bus, const struct mcp23016_output *outputs,
+		size_t n);
+
+/** @} **/
+
 /**
  * @defgroup interrupt Interrupt Output
  *
@@ -256,6 +704,37 @@ int mcp23016_set_control(struct mcp23016_device *dev, uint16_t val);
  * @{
  */
 
+/**
+ * @enum mcp23016_interrupt_flags
+ * @brief Enum that describes interrupt flags.
+ */
+enum mcp23016_interrupt_flags {
+	MCP23016_INTERRUPT_EVENTS = 1 << 0	/**< Request edge events on interrupt assertion. */
+};
+
+/**
+ * @enum mcp23016_interrupt_clock
+ * @brief Enum that describes edge event clocks.
+ */
+enum mcp23016_interrupt_clock {
+	MCP23016_CLOCK_MONOTONIC = 0,	/**< Use @c CLOCK_MONOTONIC (default). */
+	MCP23016_CLOCK_REALTIME,	/**< Use @c CLOCK_REALTIME. */
+	MCP23016_CLOCK_HTE		/**< Use the hardware timestamp engine. */
+};
+
+/**
+ * @struct mcp23016_interrupt_config
+ * @brief Struct that describes interrupt configuration.
+ *
+ * Fields that are zero select the default behavior.
+ */
+struct mcp23016_interrupt_config {
+	int flags;			/**< Bitwise OR of #mcp23016_interrupt_flags values. */
+	unsigned long debounce_period;	/**< Debounce period in microseconds, or 0 to disable. */
+	size_t event_buffer_size;	/**< Number of edge events buffered, or 0 for the default. */
+	enum mcp23016_interrupt_clock event_clock; /**< Clock used for edge event timestamps. */
+};
+
 /**
  * @struct mcp23016_interrupt
  * @brief Handle to a MCP23016 interrupt.
@@ -274,24 +753,1688 @@ struct mcp23016_interrupt;
 struct mcp23016_interrupt *mcp23016_interrupt_open(const char *path, unsigned int offset);
 
 /**
- * @brief Close a MCP23016 interrupt handle and free associated memory.
+ * @brief Open the MCP23016 interrupt specified by @p path and @p offset with
+ * @p flags.
  *
- * @param intr Pointer to a MCP23016 interrupt handle.
+ * @param path   Pointer to a GPIO character device.
+ * @param offset GPIO line offset.
+ * @param flags  Bitwise OR of #mcp23016_interrupt_flags values.
  *
- * Once closed, @p interrupt is no longer valid for use.
+ * @return Pointer to a MCP23016 interrupt handle, or @c NULL on error with @c
+ * errno set appropriately.
+ *
+ * If #MCP23016_INTERRUPT_EVENTS is specified, the GPIO line is requested for
+ * edge events, which are generated on the falling edge of the interrupt
+ * output. See mcp23016_interrupt_wait() for more details.
  */
-void mcp23016_interrupt_close(struct mcp23016_interrupt *intr);
+struct mcp23016_interrupt *mcp23016_interrupt_open_flags(const char *path, unsigned int offset,
+		int flags);
 
 /**
- * @brief Check interrupt output status.
+ * @brief Open the MCP23016 interrupt specified by @p path and @p offset with
+ * @p config.
  *
- * @param intr Pointer to a MCP23016 interrupt handle.
+ * @param path   Pointer to a GPIO character device.
+ * @param offset GPIO line offset.
+ * @param config Pointer to the interrupt configuration.
  *
- * @return Interrupt status (0 or 1) on success, or -1 on error with @c errno
- * set appropriately.
- */
+ * @return Pointer to a MCP23016 interrupt handle, or @c NULL on error with @c
+ * errno set appropriately.
+ *
+ * Debouncing is performed by the kernel, which filters interrupt output
+ * assertions shorter than the debounce period before edge events are
+ * generated. Edge events are buffered by the kernel and read by
+ * mcp23016_interrupt_read_events() in batches of up to @c event_buffer_size
+ * events per system call.
+ *
+ * These features require libgpiod v2. If the library was built against
+ * libgpiod v1, @c NULL is returned with @c errno set to @c ENOTSUP if a
+ * debounce period or an event clock other than #MCP23016_CLOCK_MONOTONIC is
+ * requested, and @c event_buffer_size is ignored.
+ */
+struct mcp23016_interrupt *mcp23016_interrupt_open_config(const char *path, unsigned int offset,
+		const struct mcp23016_interrupt_config *config);
+
+/**
+ * @brief Close a MCP23016 interrupt handle and free associated memory.
+ *
+ * @param intr Pointer to a MCP23016 interrupt handle.
+ *
+ * Once closed, @p interrupt is no longer valid for use.
+ */
+void mcp23016_interrupt_close(struct mcp23016_interrupt *intr);
+
+/**
+ * @brief Check interrupt output status.
+ *
+ * @param intr Pointer to a MCP23016 interrupt handle.
+ *
+ * @return Interrupt status (0 or 1) on success, or -1 on error with @c errno
+ * set appropriately.
+ */
 int mcp23016_has_interrupt(struct mcp23016_interrupt *intr);
 
+/**
+ * @brief Wait for interrupt output assertion.
+ *
+ * @param intr    Pointer to a MCP23016 interrupt handle.
+ * @param timeout Pointer to the maximum time to wait, or @c NULL to wait
+ *                indefinitely.
+ *
+ * @return 1 if an edge event occurred, 0 if the timeout expired, or -1 on
+ * error with @c errno set appropriately.
+ *
+ * This function blocks until the interrupt output is asserted, consuming a
+ * single edge event. @p intr must have been opened with the
+ * #MCP23016_INTERRUPT_EVENTS flag.
+ *
+ * As edge events are only generated on assertion, an interrupt output that is
+ * already asserted will not generate an additional event. If the interrupt
+ * output is shared by multiple devices, callers should service each device
+ * and check mcp23016_has_interrupt() before waiting again.
+ */
+int mcp23016_interrupt_wait(struct mcp23016_interrupt *intr, const struct timespec *timeout);
+
+/**
+ * @brief Get the edge event file descriptor.
+ *
+ * @param intr Pointer to a MCP23016 interrupt handle.
+ *
+ * @return File descriptor on success, or -1 on error with @c errno set
+ * appropriately.
+ *
+ * This function returns a file descriptor that becomes readable when edge
+ * events are pending, which permits waiting for interrupts using poll(),
+ * epoll(), or similar. Pending events should be consumed by calling
+ * mcp23016_interrupt_read_events(). @p intr must have been opened with the
+ * #MCP23016_INTERRUPT_EVENTS flag.
+ *
+ * The file descriptor is owned by @p intr and must not be closed by the
+ * caller.
+ */
+int mcp23016_interrupt_get_fd(struct mcp23016_interrupt *intr);
+
+/**
+ * @brief Consume pending edge events without blocking.
+ *
+ * @param intr Pointer to a MCP23016 interrupt handle.
+ *
+ * @return Number of events consumed on success, or -1 on error with @c errno
+ * set appropriately.
+ *
+ * @p intr must have been opened with the #MCP23016_INTERRUPT_EVENTS flag.
+ */
+int mcp23016_interrupt_read_events(struct mcp23016_interrupt *intr);
+
+/** @} **/
+
+/**
+ * @defgroup debounce Debounce
+ *
+ * @brief Software debounce functions.
+ *
+ * These functions manage a debounce filter, which suppresses input state
+ * changes caused by contact bounce. An input change is only reported once
+ * the input has remained in its new state for the window configured for
+ * that pin. All 16 pins are filtered at once using bitwise operations, so
+ * the cost of an update does not depend on the number of pins bouncing.
+ *
+ * Filters may be driven from a sampling loop by calling
+ * mcp23016_debounce_update() once per period, or from interrupts by calling
+ * mcp23016_debounce_update_at() with the time of each input change. Times
+ * are measured in nanoseconds, which permits the timestamps of events popped
+ * from an event ring to be used directly. Use of these functions is
+ * considered optional.
+ *
+ * @{
+ */
+
+/**
+ * @brief Maximum debounce window, measured in periods.
+ */
+#define MCP23016_DEBOUNCE_MAX	255
+
+/**
+ * @struct mcp23016_debounce
+ * @brief Handle to a MCP23016 debounce filter.
+ */
+struct mcp23016_debounce;
+
+/**
+ * @brief Create a debounce filter.
+ *
+ * @param initial Initial pin state.
+ * @param period  Period in nanoseconds.
+ *
+ * @return Pointer to a MCP23016 debounce filter handle, or @c NULL on error
+ * with @c errno set appropriately.
+ *
+ * @p period is the sampling period when driven by mcp23016_debounce_update(),
+ * and the resolution of debounce windows when driven by
+ * mcp23016_debounce_update_at(). All windows are initially empty.
+ */
+struct mcp23016_debounce *mcp23016_debounce_create(uint16_t initial, uint64_t period);
+
+/**
+ * @brief Destroy a debounce filter and free associated memory.
+ *
+ * @param db Pointer to a MCP23016 debounce filter handle.
+ *
+ * Once destroyed, @p db is no longer valid for use.
+ */
+void mcp23016_debounce_destroy(struct mcp23016_debounce *db);
+
+/**
+ * @brief Set the debounce window for a mask of pins.
+ *
+ * @param db     Pointer to a MCP23016 debounce filter handle.
+ * @param mask   Mask of pins to configure.
+ * @param window Window in nanoseconds, or 0 to disable debouncing.
+ *
+ * @return 0 on success, or -1 on error with @c errno set appropriately.
+ *
+ * @p window is rounded up to a whole number of periods, which may not exceed
+ * #MCP23016_DEBOUNCE_MAX.
+ */
+int mcp23016_debounce_set_window(struct mcp23016_debounce *db, uint16_t mask, uint64_t window);
+
+/**
+ * @brief Update a debounce filter with a sampled input value.
+ *
+ * @param db  Pointer to a MCP23016 debounce filter handle.
+ * @param raw Sampled input value, such as returned by mcp23016_get_port().
+ *
+ * @return Mask of pins whose debounced state changed.
+ *
+ * Each call accounts for a single period.
+ */
+uint16_t mcp23016_debounce_update(struct mcp23016_debounce *db, uint16_t raw);
+
+/**
+ * @brief Update a debounce filter with an input value observed at @p now.
+ *
+ * @param db  Pointer to a MCP23016 debounce filter handle.
+ * @param raw Input value, such as an interrupt capture value.
+ * @param now @c CLOCK_MONOTONIC time in nanoseconds.
+ *
+ * @return Mask of pins whose debounced state changed.
+ *
+ * The time elapsed since the previous update is accounted to the previous
+ * input value. As a change is only reported once its window has elapsed,
+ * callers should call this function again with the same input value after
+ * the longest window while mcp23016_debounce_get_pending() is non-zero.
+ */
+uint16_t mcp23016_debounce_update_at(struct mcp23016_debounce *db, uint16_t raw, uint64_t now);
+
+/**
+ * @brief Get the debounced pin state.
+ *
+ * @param db Pointer to a MCP23016 debounce filter handle.
+ *
+ * @return Debounced pin state.
+ */
+uint16_t mcp23016_debounce_get_state(const struct mcp23016_debounce *db);
+
+/**
+ * @brief Get the pins waiting for their debounce window to elapse.
+ *
+ * @param db Pointer to a MCP23016 debounce filter handle.
+ *
+ * @return Mask of pins whose input value differs from the debounced state.
+ */
+uint16_t mcp23016_debounce_get_pending(const struct mcp23016_debounce *db);
+
+/** @} **/
+
+/**
+ * @defgroup ring Event Ring
+ *
+ * @brief Event ring functions.
+ *
+ * These functions manage a fixed-capacity ring of input change events,
+ * which permits events to be passed from a thread servicing interrupts to a
+ * consumer thread without locking or allocating memory. A ring may be
+ * attached to an interrupt dispatcher or shared interrupt group, which push
+ * an event each time an interrupt is serviced with pins that changed state.
+ *
+ * Rings support exactly one producer and one consumer thread; all push
+ * functions must be called from the same thread, as must all pop functions.
+ * Events that cannot be pushed because the ring is full are dropped and
+ * counted; see mcp23016_ring_get_overflow().
+ *
+ * @{
+ */
+
+/**
+ * @struct mcp23016_event
+ * @brief Struct that describes an input change event.
+ */
+struct mcp23016_event {
+	uint64_t timestamp;	/**< @c CLOCK_MONOTONIC time in nanoseconds. */
+	unsigned int device;	/**< Device position (0-7). */
+	uint16_t intcap;	/**< Captured port value. */
+	uint16_t changed;	/**< Mask of pins that changed state. */
+};
+
+/**
+ * @struct mcp23016_ring
+ * @brief Handle to a MCP23016 event ring.
+ */
+struct mcp23016_ring;
+
+/**
+ * @brief Create an event ring holding up to @p capacity events.
+ *
+ * @param capacity Number of events; must be a power of two.
+ *
+ * @return Pointer to a MCP23016 event ring handle, or @c NULL on error with
+ * @c errno set appropriately.
+ */
+struct mcp23016_ring *mcp23016_ring_create(size_t capacity);
+
+/**
+ * @brief Destroy an event ring and free associated memory.
+ *
+ * @param ring Pointer to a MCP23016 event ring handle.
+ *
+ * Once destroyed, @p ring is no longer valid for use. The ring must first be
+ * detached from any dispatcher or group it was attached to.
+ */
+void mcp23016_ring_destroy(struct mcp23016_ring *ring);
+
+/**
+ * @brief Get the capacity of an event ring.
+ *
+ * @param ring Pointer to a MCP23016 event ring handle.
+ *
+ * @return Number of events the ring can hold.
+ */
+size_t mcp23016_ring_capacity(const struct mcp23016_ring *ring);
+
+/**
+ * @brief Push an event to an event ring.
+ *
+ * @param ring  Pointer to a MCP23016 event ring handle.
+ * @param event Pointer to the event to push.
+ *
+ * @return 0 on success, or -1 with @c errno set to @c ENOBUFS if the ring is
+ * full.
+ *
+ * This function must only be called by the producer thread.
+ */
+int mcp23016_ring_push(struct mcp23016_ring *ring, const struct mcp23016_event *event);
+
+/**
+ * @brief Pop up to @p n events from an event ring.
+ *
+ * @param ring   Pointer to a MCP23016 event ring handle.
+ * @param events Pointer to an array to store events.
+ * @param n      Maximum number of events to pop.
+ *
+ * @return Number of events popped, which may be 0 if the ring is empty.
+ *
+ * This function does not block and must only be called by the consumer
+ * thread.
+ */
+size_t mcp23016_ring_pop(struct mcp23016_ring *ring, struct mcp23016_event *events, size_t n);
+
+/**
+ * @brief Get the number of events dropped because the ring was full.
+ *
+ * @param ring Pointer to a MCP23016 event ring handle.
+ *
+ * @return Number of events dropped since the ring was created.
+ *
+ * This function may be called from any thread.
+ */
+uint64_t mcp23016_ring_get_overflow(const struct mcp23016_ring *ring);
+
+/** @} **/
+
+/**
+ * @defgroup snapshot Input Snapshot
+ *
+ * @brief Input snapshot functions.
+ *
+ * These functions manage an input snapshot, which publishes the last input
+ * state read from a device to any number of threads. Snapshots are updated
+ * by a single thread, such as the thread running an interrupt dispatcher;
+ * see mcp23016_dispatcher_set_snapshot(). Reading a snapshot does not
+ * access the I2C bus, block, or make system calls. Use of these functions
+ * is considered optional.
+ *
+ * @{
+ */
+
+/**
+ * @struct mcp23016_input
+ * @brief Struct that describes published input state.
+ */
+struct mcp23016_input {
+	uint64_t sequence;	/**< Number of times the snapshot was published. */
+	uint64_t timestamp;	/**< @c CLOCK_MONOTONIC time in nanoseconds. */
+	uint16_t port;		/**< Port value. */
+	uint16_t intcap;	/**< Interrupt capture value. */
+};
+
+/**
+ * @struct mcp23016_snapshot
+ * @brief Handle to a MCP23016 input snapshot.
+ */
+struct mcp23016_snapshot;
+
+/**
+ * @brief Create an input snapshot.
+ *
+ * @return Pointer to a MCP23016 input snapshot handle, or @c NULL on error
+ * with @c errno set appropriately.
+ *
+ * The snapshot is initially unpublished, with a sequence number of 0.
+ */
+struct mcp23016_snapshot *mcp23016_snapshot_create(void);
+
+/**
+ * @brief Destroy an input snapshot and free associated memory.
+ *
+ * @param snap Pointer to a MCP23016 input snapshot handle.
+ *
+ * The snapshot must be detached from any dispatcher it was attached to.
+ */
+void mcp23016_snapshot_destroy(struct mcp23016_snapshot *snap);
+
+/**
+ * @brief Publish input state to a snapshot.
+ *
+ * @param snap   Pointer to a MCP23016 input snapshot handle.
+ * @param port   Port value.
+ * @param intcap Interrupt capture value.
+ *
+ * The timestamp is set to the current time and the sequence number is
+ * incremented. Snapshots support exactly one publishing thread.
+ */
+void mcp23016_snapshot_publish(struct mcp23016_snapshot *snap, uint16_t port, uint16_t intcap);
+
+/**
+ * @brief Read the published input state of a snapshot.
+ *
+ * @param snap  Pointer to a MCP23016 input snapshot handle.
+ * @param input Pointer to the input state.
+ *
+ * This function may be called from any number of threads. If the snapshot
+ * is published while being read, the read is retried, so @p input always
+ * holds a consistent state.
+ */
+void mcp23016_snapshot_read(const struct mcp23016_snapshot *snap, struct mcp23016_input *input);
+
+/** @} **/
+
+/**
+ * @defgroup dispatcher Interrupt Dispatcher
+ *
+ * @brief Interrupt dispatcher functions.
+ *
+ * These functions manage an interrupt dispatcher, which determines the pins
+ * that changed state when the interrupt output of a device is asserted and
+ * invokes handlers registered for those pins. Each interrupt is serviced by
+ * a single combined transfer using mcp23016_service_interrupt(); dispatching
+ * does not allocate memory. Use of these functions is considered optional.
+ *
+ * @{
+ */
+
+/**
+ * @enum mcp23016_edge
+ * @brief Enum that describes pin edges.
+ */
+enum mcp23016_edge {
+	MCP23016_EDGE_RISING = 1 << 0,	/**< Pin changed from 0 to 1. */
+	MCP23016_EDGE_FALLING = 1 << 1,	/**< Pin changed from 1 to 0. */
+	MCP23016_EDGE_BOTH = MCP23016_EDGE_RISING | MCP23016_EDGE_FALLING /**< Pin changed state. */
+};
+
+/**
+ * @brief Maximum number of mask handlers per dispatcher.
+ */
+#define MCP23016_MASK_HANDLER_MAX	8
+
+/**
+ * @brief Pin handler function.
+ *
+ * @param dev  Pointer to the MCP23016 device handle.
+ * @param pin  The pin that changed state (0-15).
+ * @param edge The edge that occurred.
+ * @param arg  Pointer to user data.
+ */
+typedef void (*mcp23016_pin_handler)(struct mcp23016_device *dev, unsigned int pin,
+		enum mcp23016_edge edge, void *arg);
+
+/**
+ * @brief Mask handler function.
+ *
+ * @param dev     Pointer to the MCP23016 device handle.
+ * @param rising  Mask of pins that changed from 0 to 1.
+ * @param falling Mask of pins that changed from 1 to 0.
+ * @param arg     Pointer to user data.
+ */
+typedef void (*mcp23016_mask_handler)(struct mcp23016_device *dev, uint16_t rising,
+		uint16_t falling, void *arg);
+
+/**
+ * @struct mcp23016_dispatcher_stats
+ * @brief Struct that describes interrupt dispatcher statistics.
+ */
+struct mcp23016_dispatcher_stats {
+	uint64_t edges;		/**< Number of edge events consumed. */
+	uint64_t services;	/**< Number of interrupts serviced. */
+	uint64_t merged;	/**< Number of edge events merged by coalescing. */
+};
+
+/**
+ * @struct mcp23016_dispatcher
+ * @brief Handle to a MCP23016 interrupt dispatcher.
+ */
+struct mcp23016_dispatcher;
+
+/**
+ * @brief Create an interrupt dispatcher for @p dev.
+ *
+ * @param dev  Pointer to a MCP23016 device handle.
+ * @param intr Pointer to a MCP23016 interrupt handle, or @c NULL if
+ *             interrupts are detected by the caller.
+ *
+ * @return Pointer to a MCP23016 interrupt dispatcher handle, or @c NULL on
+ * error with @c errno set appropriately.
+ *
+ * This function reads the port value, which is used to determine pin state
+ * changes when the first interrupt is dispatched. Pending interrupts are
+ * cleared.
+ */
+struct mcp23016_dispatcher *mcp23016_dispatcher_create(struct mcp23016_device *dev,
+		struct mcp23016_interrupt *intr);
+
+/**
+ * @brief Destroy an interrupt dispatcher and free associated memory.
+ *
+ * @param disp Pointer to a MCP23016 interrupt dispatcher handle.
+ *
+ * Once destroyed, @p disp is no longer valid for use. The device and
+ * interrupt handles are not closed.
+ */
+void mcp23016_dispatcher_destroy(struct mcp23016_dispatcher *disp);
+
+/**
+ * @brief Set the handler for a single pin.
+ *
+ * @param disp  Pointer to a MCP23016 interrupt dispatcher handle.
+ * @param pin   The pin to handle (0-15).
+ * @param edges Bitwise OR of #mcp23016_edge values to handle.
+ * @param fn    Pointer to a handler function, or @c NULL to remove the
+ *              handler.
+ * @param arg   Pointer to user data passed to @p fn.
+ *
+ * @return 0 on success, or -1 on error with @c errno set appropriately.
+ */
+int mcp23016_dispatcher_set_pin_handler(struct mcp23016_dispatcher *disp, unsigned int pin,
+		int edges, mcp23016_pin_handler fn, void *arg);
+
+/**
+ * @brief Add a handler for a mask of pins.
+ *
+ * @param disp  Pointer to a MCP23016 interrupt dispatcher handle.
+ * @param mask  Mask of pins to handle.
+ * @param edges Bitwise OR of #mcp23016_edge values to handle.
+ * @param fn    Pointer to a handler function.
+ * @param arg   Pointer to user data passed to @p fn.
+ *
+ * @return 0 on success, or -1 on error with @c errno set appropriately.
+ *
+ * Mask handlers are invoked once per interrupt with the pins in @p mask that
+ * changed state. A pin that changed state again after the interrupt was
+ * captured is reported as both rising and falling. At most
+ * #MCP23016_MASK_HANDLER_MAX mask handlers may be added to a dispatcher.
+ */
+int mcp23016_dispatcher_add_mask_handler(struct mcp23016_dispatcher *disp, uint16_t mask,
+		int edges, mcp23016_mask_handler fn, void *arg);
+
+/**
+ * @brief Attach an event ring to an interrupt dispatcher.
+ *
+ * @param disp Pointer to a MCP23016 interrupt dispatcher handle.
+ * @param ring Pointer to a MCP23016 event ring handle, or @c NULL to detach
+ *             the current ring.
+ *
+ * Once attached, a single event is pushed to @p ring each time an interrupt
+ * is dispatched with pins that changed state. The event mask includes pins
+ * that changed state after the interrupt was captured. The thread dispatching
+ * interrupts becomes the producer for @p ring.
+ */
+void mcp23016_dispatcher_set_ring(struct mcp23016_dispatcher *disp, struct mcp23016_ring *ring);
+
+/**
+ * @brief Attach an input snapshot to an interrupt dispatcher.
+ *
+ * @param disp Pointer to a MCP23016 interrupt dispatcher handle.
+ * @param snap Pointer to a MCP23016 input snapshot handle, or @c NULL to
+ *             detach.
+ *
+ * Once attached, the current input state is published immediately and
+ * after each interrupt is serviced. The thread dispatching interrupts is
+ * the only thread that may publish to @p snap.
+ */
+void mcp23016_dispatcher_set_snapshot(struct mcp23016_dispatcher *disp,
+		struct mcp23016_snapshot *snap);
+
+/**
+ * @brief Set the interrupt coalescing window of an interrupt dispatcher.
+ *
+ * @param disp      Pointer to a MCP23016 interrupt dispatcher handle.
+ * @param window_ns Coalescing window in nanoseconds, or 0 to disable.
+ * @param max_edges Maximum number of edge events per window, or 0 for no
+ *                  limit.
+ *
+ * @return 0 on success, or -1 on error with @c errno set appropriately.
+ *
+ * When coalescing is enabled, mcp23016_dispatcher_run() continues to consume
+ * edge events after the first until @p window_ns elapses or @p max_edges
+ * events have been consumed, then services the interrupt once. Bursts of
+ * changes are dispatched as a single change set, which bounds bus load at
+ * one interrupt service per window. Edges of pins that changed state more
+ * than once during the window may be merged.
+ *
+ * The dispatcher must have been created with an interrupt handle opened
+ * with the #MCP23016_INTERRUPT_EVENTS flag. Coalescing is disabled by
+ * default.
+ */
+int mcp23016_dispatcher_set_coalesce(struct mcp23016_dispatcher *disp, uint64_t window_ns,
+		unsigned int max_edges);
+
+/**
+ * @brief Get interrupt dispatcher statistics.
+ *
+ * @param disp  Pointer to a MCP23016 interrupt dispatcher handle.
+ * @param stats Pointer to the statistics.
+ *
+ * If the dispatcher is only serviced by mcp23016_dispatcher_run() using edge
+ * events, the number of edge events consumed is the sum of interrupts
+ * serviced and edge events merged by coalescing.
+ */
+void mcp23016_dispatcher_get_stats(struct mcp23016_dispatcher *disp,
+		struct mcp23016_dispatcher_stats *stats);
+
+/**
+ * @brief Dispatch an interrupt.
+ *
+ * @param disp Pointer to a MCP23016 interrupt dispatcher handle.
+ *
+ * @return 0 on success, or -1 on error with @c errno set appropriately.
+ *
+ * This function reads the captured and current port values using
+ * mcp23016_service_interrupt(), determines the pins that changed state since
+ * the last interrupt, and invokes the handlers registered for those pins.
+ * Mask handlers are invoked first, followed by pin handlers in ascending pin
+ * order.
+ *
+ * Edges leading up to the captured value are dispatched before edges that
+ * occurred after the capture. A pin that changed state again before the
+ * interrupt was serviced is dispatched twice, once for each edge, so that
+ * short pulses are not lost.
+ */
+int mcp23016_dispatcher_dispatch(struct mcp23016_dispatcher *disp);
+
+/**
+ * @brief Wait for and dispatch an interrupt.
+ *
+ * @param disp    Pointer to a MCP23016 interrupt dispatcher handle.
+ * @param timeout Pointer to the maximum time to wait, or @c NULL to wait
+ *                indefinitely.
+ *
+ * @return 1 if an interrupt was dispatched, 0 if no interrupt occurred, or
+ * -1 on error with @c errno set appropriately.
+ *
+ * If the interrupt handle was opened with the #MCP23016_INTERRUPT_EVENTS
+ * flag, this function blocks until the interrupt output is asserted or
+ * @p timeout expires. Otherwise, the interrupt output status is checked
+ * without blocking and @p timeout is ignored.
+ */
+int mcp23016_dispatcher_run(struct mcp23016_dispatcher *disp, const struct timespec *timeout);
+
+/** @} **/
+
+/**
+ * @defgroup group Shared Interrupt Group
+ *
+ * @brief Shared interrupt group functions.
+ *
+ * These functions manage a group of devices whose interrupt outputs are
+ * wired together and connected to a single GPIO line. As the device that
+ * asserted the interrupt output cannot be determined from the line alone,
+ * the @c INTCAP0 and @c INTCAP1 registers of every device in the group are
+ * read using a single combined transfer. Devices in a group must share the
+ * same I2C bus; see mcp23016_open_on_bus().
+ *
+ * @{
+ */
+
+/**
+ * @brief Group handler function.
+ *
+ * @param dev     Pointer to the MCP23016 device handle.
+ * @param val     Interrupt capture value.
+ * @param changed Mask of pins that changed state.
+ * @param arg     Pointer to user data.
+ */
+typedef void (*mcp23016_group_handler)(struct mcp23016_device *dev, uint16_t val,
+		uint16_t changed, void *arg);
+
+/**
+ * @struct mcp23016_group
+ * @brief Handle to a MCP23016 shared interrupt group.
+ */
+struct mcp23016_group;
+
+/**
+ * @brief Create a shared interrupt group for @p n devices.
+ *
+ * @param intr Pointer to a MCP23016 interrupt handle.
+ * @param devs Pointer to an array of MCP23016 device handles.
+ * @param n    Number of devices (1-#MCP23016_DEVICE_MAX).
+ *
+ * @return Pointer to a MCP23016 shared interrupt group handle, or @c NULL on
+ * error with @c errno set appropriately.
+ *
+ * This function reads the interrupt capture value of each device, which is
+ * used to determine pin state changes when the first interrupt is serviced.
+ * Pending interrupts are cleared.
+ */
+struct mcp23016_group *mcp23016_group_create(struct mcp23016_interrupt *intr,
+		struct mcp23016_device *const *devs, size_t n);
+
+/**
+ * @brief Destroy a shared interrupt group and free associated memory.
+ *
+ * @param grp Pointer to a MCP23016 shared interrupt group handle.
+ *
+ * Once destroyed, @p grp is no longer valid for use. The device and
+ * interrupt handles are not closed.
+ */
+void mcp23016_group_destroy(struct mcp23016_group *grp);
+
+/**
+ * @brief Attach an event ring to a shared interrupt group.
+ *
+ * @param grp  Pointer to a MCP23016 shared interrupt group handle.
+ * @param ring Pointer to a MCP23016 event ring handle, or @c NULL to detach
+ *             the current ring.
+ *
+ * Once attached, an event is pushed to @p ring for each device whose
+ * captured value changed. The thread servicing interrupts becomes the
+ * producer for @p ring.
+ */
+void mcp23016_group_set_ring(struct mcp23016_group *grp, struct mcp23016_ring *ring);
+
+/**
+ * @brief Service an asserted interrupt output.
+ *
+ * @param grp Pointer to a MCP23016 shared interrupt group handle.
+ * @param fn  Pointer to a handler function, or @c NULL if changes are only
+ *            recorded to an event ring.
+ * @param arg Pointer to user data passed to @p fn.
+ *
+ * @return 0 on success, or -1 on error with @c errno set appropriately.
+ *
+ * This function reads the interrupt capture registers of all devices and
+ * invokes @p fn for each device whose captured value changed. Devices are
+ * read again until the interrupt output is no longer asserted, which
+ * ensures interrupts asserted while servicing are not lost. If the
+ * interrupt output remains asserted after a bounded number of reads, -1 is
+ * returned with @c errno set to @c EAGAIN.
+ */
+int mcp23016_group_service(struct mcp23016_group *grp, mcp23016_group_handler fn, void *arg);
+
+/**
+ * @brief Wait for and service an interrupt.
+ *
+ * @param grp     Pointer to a MCP23016 shared interrupt group handle.
+ * @param timeout Pointer to the maximum time to wait, or @c NULL to wait
+ *                indefinitely.
+ * @param fn      Pointer to a handler function, or @c NULL.
+ * @param arg     Pointer to user data passed to @p fn.
+ *
+ * @return 1 if an interrupt was serviced, 0 if no interrupt occurred, or -1
+ * on error with @c errno set appropriately.
+ *
+ * See mcp23016_dispatcher_run() for details on how @p timeout is handled.
+ */
+int mcp23016_group_run(struct mcp23016_group *grp, const struct timespec *timeout,
+		mcp23016_group_handler fn, void *arg);
+
+/** @} **/
+
+/**
+ * @defgroup queue Asynchronous Requests
+ *
+ * @brief Asynchronous request functions.
+ *
+ * These functions manage a request queue, which performs register accesses
+ * for devices on a shared I2C bus without blocking the caller. Requests are
+ * performed in submission order by a worker thread owned by the queue.
+ * Requests are allocated by the caller, which permits any number of
+ * requests to be in flight across devices on the bus without allocating
+ * memory. Use of these functions is considered optional.
+ *
+ * @{
+ */
+
+/**
+ * @enum mcp23016_request_op
+ * @brief Enum that describes request operations.
+ */
+enum mcp23016_request_op {
+	MCP23016_REQUEST_GET,		/**< Read a register value. */
+	MCP23016_REQUEST_SET		/**< Write a register value. */
+};
+
+/**
+ * @enum mcp23016_register
+ * @brief Enum that describes device registers.
+ */
+enum mcp23016_register {
+	MCP23016_REGISTER_PORT,		/**< Port value; see mcp23016_get_port(). */
+	MCP23016_REGISTER_OUTPUT,	/**< Output latch value; see mcp23016_get_output(). */
+	MCP23016_REGISTER_POLARITY,	/**< Input polarity; see mcp23016_get_polarity(). */
+	MCP23016_REGISTER_DIRECTION,	/**< I/O direction; see mcp23016_get_direction(). */
+	MCP23016_REGISTER_INTERRUPT,	/**< Interrupt capture value (read-only). */
+	MCP23016_REGISTER_CONTROL	/**< Control value; see mcp23016_get_control(). */
+};
+
+struct mcp23016_request;
+
+/**
+ * @brief Request completion function.
+ *
+ * @param req Pointer to the completed request.
+ * @param arg Pointer to user data.
+ */
+typedef void (*mcp23016_request_callback)(struct mcp23016_request *req, void *arg);
+
+/**
+ * @struct mcp23016_request
+ * @brief Struct that describes an asynchronous request.
+ */
+struct mcp23016_request {
+	struct mcp23016_device *dev;	/**< Pointer to a MCP23016 device handle. */
+	enum mcp23016_request_op op;	/**< Request operation. */
+	enum mcp23016_register reg;	/**< Device register. */
+	uint16_t val;			/**< Value to write, or value read on completion. */
+	int error;			/**< 0 on success, or @c errno value on error. */
+	mcp23016_request_callback fn;	/**< Pointer to a completion function, or @c NULL. */
+	void *arg;			/**< Pointer to user data passed to @c fn. */
+	struct mcp23016_request *next;	/**< Reserved for internal use. */
+};
+
+/**
+ * @struct mcp23016_queue
+ * @brief Handle to a MCP23016 request queue.
+ */
+struct mcp23016_queue;
+
+/**
+ * @brief Create a request queue for @p bus.
+ *
+ * @param bus Pointer to a shared bus handle.
+ *
+ * @return Pointer to a MCP23016 request queue handle, or @c NULL on error
+ * with @c errno set appropriately.
+ *
+ * The queue holds a reference to @p bus and starts a worker thread that
+ * performs requests until the queue is destroyed.
+ */
+struct mcp23016_queue *mcp23016_queue_create(struct mcp23016_bus *bus);
+
+/**
+ * @brief Destroy a request queue and free associated memory.
+ *
+ * @param queue Pointer to a MCP23016 request queue handle.
+ *
+ * Requests submitted before calling this function are completed before the
+ * worker thread exits. Completed requests that have not been reaped are
+ * discarded. Once destroyed, @p queue is no longer valid for use.
+ */
+void mcp23016_queue_destroy(struct mcp23016_queue *queue);
+
+/**
+ * @brief Submit an asynchronous request.
+ *
+ * @param queue Pointer to a MCP23016 request queue handle.
+ * @param req   Pointer to the request.
+ *
+ * @return 0 on success, or -1 on error with @c errno set appropriately.
+ *
+ * The device referenced by @p req must have been opened on the bus of
+ * @p queue by calling mcp23016_open_on_bus(). @p req is owned by the queue
+ * until it completes and must not be modified or freed by the caller.
+ *
+ * If @c fn is set, it is called from the worker thread once the request
+ * completes and must not block. Otherwise, the completed request is added
+ * to the queue, which may be consumed by calling mcp23016_queue_reap().
+ *
+ * The device must not be accessed by other threads while requests are in
+ * flight.
+ */
+int mcp23016_queue_submit(struct mcp23016_queue *queue, struct mcp23016_request *req);
+
+/**
+ * @brief Get the completion file descriptor.
+ *
+ * @param queue Pointer to a MCP23016 request queue handle.
+ *
+ * @return File descriptor.
+ *
+ * This function returns an eventfd that becomes readable when completed
+ * requests are available, which permits waiting for completions using
+ * poll(), epoll(), or similar. Completed requests should be consumed by
+ * calling mcp23016_queue_reap().
+ *
+ * The file descriptor is owned by @p queue and must not be closed by the
+ * caller.
+ */
+int mcp23016_queue_get_fd(struct mcp23016_queue *queue);
+
+/**
+ * @brief Consume completed requests without blocking.
+ *
+ * @param queue Pointer to a MCP23016 request queue handle.
+ * @param reqs  Pointer to an array of request pointers.
+ * @param n     Number of entries in @p reqs.
+ *
+ * @return Number of completed requests stored in @p reqs.
+ *
+ * Requests are returned in completion order, which is the order in which
+ * they were submitted.
+ */
+size_t mcp23016_queue_reap(struct mcp23016_queue *queue, struct mcp23016_request **reqs,
+		size_t n);
+
+/** @} **/
+
+/**
+ * @defgroup owner Bus Owner
+ *
+ * @brief Bus owner functions.
+ *
+ * These functions manage a bus owner, which performs all register writes
+ * for devices on a shared I2C bus from a single thread. Other threads
+ * enqueue commands using a bounded lock-free queue, which does not require
+ * callers to synchronize access to device handles. Consecutive commands that
+ * update the same register are merged by the bus owner thread and written
+ * once; writes are performed in the order commands were enqueued. Use of
+ * these functions is considered optional.
+ *
+ * @{
+ */
+
+/**
+ * @struct mcp23016_owner_stats
+ * @brief Struct that describes bus owner statistics.
+ */
+struct mcp23016_owner_stats {
+	uint64_t commands;	/**< Number of commands performed. */
+	uint64_t writes;	/**< Number of register writes. */
+	uint64_t errors;	/**< Number of failed register accesses. */
+};
+
+/**
+ * @struct mcp23016_owner
+ * @brief Handle to a MCP23016 bus owner.
+ */
+struct mcp23016_owner;
+
+/**
+ * @brief Create a bus owner for @p bus holding up to @p capacity commands.
+ *
+ * @param bus      Pointer to a shared bus handle.
+ * @param capacity Number of commands; must be a power of two.
+ *
+ * @return Pointer to a MCP23016 bus owner handle, or @c NULL on error with
+ * @c errno set appropriately.
+ *
+ * The bus owner holds a reference to @p bus and starts a thread that
+ * performs commands until the bus owner is destroyed.
+ */
+struct mcp23016_owner *mcp23016_owner_create(struct mcp23016_bus *bus, size_t capacity);
+
+/**
+ * @brief Destroy a bus owner and free associated memory.
+ *
+ * @param owner Pointer to a MCP23016 bus owner handle.
+ *
+ * Commands enqueued before calling this function are performed before the
+ * bus owner thread exits. Once destroyed, @p owner is no longer valid for
+ * use.
+ */
+void mcp23016_owner_destroy(struct mcp23016_owner *owner);
+
+/**
+ * @brief Enqueue a write of the pins specified by @p mask to a register.
+ *
+ * @param owner Pointer to a MCP23016 bus owner handle.
+ * @param dev   Pointer to a MCP23016 device handle.
+ * @param reg   Device register.
+ * @param mask  Mask of pins to write.
+ * @param val   Pin values.
+ *
+ * @return 0 on success, or -1 on error with @c errno set appropriately.
+ *
+ * This function may be called from any thread and does not block. Pins are
+ * set by passing @p mask as @p val, and cleared by passing 0. If @p mask is
+ * @c 0xffff, the register is written without reading its current value.
+ * Otherwise, the current value is read by the bus owner thread, which is
+ * served from the register cache if enabled; see mcp23016_enable_cache().
+ *
+ * Consecutive commands that update the same register are merged in the
+ * order they were enqueued; commands to other registers are not reordered.
+ * If the queue is full, -1 is returned with @c errno set to @c EAGAIN. Only
+ * #MCP23016_REGISTER_OUTPUT, #MCP23016_REGISTER_POLARITY,
+ * #MCP23016_REGISTER_DIRECTION, and #MCP23016_REGISTER_CONTROL may be
+ * written.
+ *
+ * The device must have been opened on the bus of @p owner by calling
+ * mcp23016_open_on_bus() and must not be accessed by other threads while
+ * commands are pending.
+ */
+int mcp23016_owner_write(struct mcp23016_owner *owner, struct mcp23016_device *dev,
+		enum mcp23016_register reg, uint16_t mask, uint16_t val);
+
+/**
+ * @brief Get bus owner statistics.
+ *
+ * @param owner Pointer to a MCP23016 bus owner handle.
+ * @param stats Pointer to the statistics.
+ *
+ * The number of commands merged is the difference between commands
+ * performed and register writes.
+ */
+void mcp23016_owner_get_stats(struct mcp23016_owner *owner, struct mcp23016_owner_stats *stats);
+
+/** @} **/
+
+/**
+ * @defgroup poller Adaptive Poller
+ *
+ * @brief Adaptive poller functions.
+ *
+ * These functions manage a poller, which samples the port values of devices
+ * on a shared I2C bus from a background thread when interrupt output is not
+ * available. All devices are read using a single combined transfer. The
+ * sampling period is reduced to the minimum when pins change state and is
+ * doubled each time a sample is taken without changes, up to the maximum.
+ * Use of these functions is considered optional.
+ *
+ * @{
+ */
+
+/**
+ * @struct mcp23016_poller_config
+ * @brief Struct that describes a poller configuration.
+ */
+struct mcp23016_poller_config {
+	uint64_t min_period;	/**< Minimum sampling period in nanoseconds. */
+	uint64_t max_period;	/**< Maximum sampling period in nanoseconds. */
+	uint32_t bandwidth;	/**< Maximum bus bandwidth in bytes per second, or 0 for no limit. */
+};
+
+/**
+ * @struct mcp23016_poller_stats
+ * @brief Struct that describes poller statistics.
+ */
+struct mcp23016_poller_stats {
+	uint64_t samples;	/**< Number of samples taken. */
+	uint64_t changes;	/**< Number of samples with pins that changed state. */
+	uint64_t errors;	/**< Number of failed samples. */
+	uint64_t period;	/**< Current sampling period in nanoseconds. */
+};
+
+/**
+ * @brief Poller handler function.
+ *
+ * @param dev     Pointer to the MCP23016 device handle.
+ * @param val     Port value.
+ * @param changed Mask of pins that changed state.
+ * @param arg     Pointer to user data.
+ */
+typedef void (*mcp23016_poller_handler)(struct mcp23016_device *dev, uint16_t val,
+		uint16_t changed, void *arg);
+
+/**
+ * @struct mcp23016_poller
+ * @brief Handle to a MCP23016 poller.
+ */
+struct mcp23016_poller;
+
+/**
+ * @brief Create a poller for @p bus.
+ *
+ * @param bus    Pointer to a shared bus handle.
+ * @param config Pointer to the poller configuration.
+ *
+ * @return Pointer to a MCP23016 poller handle, or @c NULL on error with
+ * @c errno set appropriately.
+ *
+ * The poller holds a reference to @p bus. If @c bandwidth is set, the
+ * minimum sampling period is raised as needed so that sampling all devices
+ * does not exceed it. Sampling begins once mcp23016_poller_start() is
+ * called.
+ */
+struct mcp23016_poller *mcp23016_poller_create(struct mcp23016_bus *bus,
+		const struct mcp23016_poller_config *config);
+
+/**
+ * @brief Destroy a poller and free associated memory.
+ *
+ * @param poller Pointer to a MCP23016 poller handle.
+ *
+ * If started, the poller thread is stopped before returning. Once
+ * destroyed, @p poller is no longer valid for use.
+ */
+void mcp23016_poller_destroy(struct mcp23016_poller *poller);
+
+/**
+ * @brief Add a device to a poller.
+ *
+ * @param poller Pointer to a MCP23016 poller handle.
+ * @param dev    Pointer to a MCP23016 device handle.
+ * @param snap   Pointer to a MCP23016 input snapshot handle, or @c NULL.
+ *
+ * @return 0 on success, or -1 on error with @c errno set appropriately.
+ *
+ * @p dev must have been opened on the bus of @p poller by calling
+ * mcp23016_open_on_bus(). If @p snap is set, each sample of @p dev is
+ * published to it. Devices may not be added once the poller is started.
+ */
+int mcp23016_poller_add_device(struct mcp23016_poller *poller, struct mcp23016_device *dev,
+		struct mcp23016_snapshot *snap);
+
+/**
+ * @brief Set the handler of a poller.
+ *
+ * @param poller Pointer to a MCP23016 poller handle.
+ * @param fn     Pointer to a handler function, or @c NULL.
+ * @param arg    Pointer to user data passed to @p fn.
+ *
+ * @p fn is called from the poller thread for each device with pins that
+ * changed state and must not block. The handler may not be set once the
+ * poller is started.
+ */
+void mcp23016_poller_set_handler(struct mcp23016_poller *poller, mcp23016_poller_handler fn,
+		void *arg);
+
+/**
+ * @brief Start the poller thread.
+ *
+ * @param poller Pointer to a MCP23016 poller handle.
+ *
+ * @return 0 on success, or -1 on error with @c errno set appropriately.
+ *
+ * The first sample establishes the initial port values; handlers are not
+ * called for it. Devices must not be accessed by other threads while the
+ * poller is started.
+ */
+int mcp23016_poller_start(struct mcp23016_poller *poller);
+
+/**
+ * @brief Get poller statistics.
+ *
+ * @param poller Pointer to a MCP23016 poller handle.
+ * @param stats  Pointer to the statistics.
+ */
+void mcp23016_poller_get_stats(struct mcp23016_poller *poller, struct mcp23016_poller_stats *stats);
+
+/** @} **/
+
+/**
+ * @defgroup capture Capture File
+ *
+ * @brief Capture file functions.
+ *
+ * These functions manage a capture file, which records port values of
+ * devices over long periods in a compact binary format. A capture file
+ * consists of a header describing the devices, sampling period, and clock,
+ * followed by fixed-size records of a timestamp and one port value per
+ * device. The file is preallocated when created and accessed through a
+ * shared memory mapping, so records are appended without system calls.
+ * Capture files are stored in host byte order. Use of these functions is
+ * considered optional.
+ *
+ * @{
+ */
+
+/**
+ * @brief Flag that overwrites the oldest records once a capture file is full.
+ */
+#define MCP23016_CAPTURE_WRAP	(1 << 0)
+
+/**
+ * @struct mcp23016_capture_info
+ * @brief Struct that describes a capture file.
+ */
+struct mcp23016_capture_info {
+	unsigned int devices[MCP23016_DEVICE_MAX]; /**< Device positions (0-7). */
+	size_t num_devices;	/**< Number of devices. */
+	uint64_t period;	/**< Sampling period in nanoseconds, or 0 if unknown. */
+	clockid_t clock;	/**< Clock used for timestamps. */
+	uint64_t capacity;	/**< Maximum number of records. */
+	int flags;		/**< Capture flags. */
+};
+
+/**
+ * @struct mcp23016_capture
+ * @brief Handle to a MCP23016 capture file.
+ */
+struct mcp23016_capture;
+
+/**
+ * @brief Create a capture file.
+ *
+ * @param path Path to the capture file.
+ * @param info Pointer to a description of the capture file.
+ *
+ * @return Pointer to a MCP23016 capture file handle, or @c NULL on error with
+ * @c errno set appropriately.
+ *
+ * An existing file at @p path is truncated. Storage for @c capacity records
+ * is allocated before returning, which ensures appending records does not
+ * fail for lack of space on the underlying file system.
+ */
+struct mcp23016_capture *mcp23016_capture_create(const char *path,
+		const struct mcp23016_capture_info *info);
+
+/**
+ * @brief Open an existing capture file for reading.
+ *
+ * @param path Path to the capture file.
+ *
+ * @return Pointer to a MCP23016 capture file handle, or @c NULL on error with
+ * @c errno set appropriately.
+ *
+ * If @p path is not a capture file, or was written by a host of differing
+ * byte order, @c NULL is returned with @c errno set to @c EINVAL. A capture
+ * file may be opened while records are appended by another process.
+ */
+struct mcp23016_capture *mcp23016_capture_open(const char *path);
+
+/**
+ * @brief Close a capture file and free associated memory.
+ *
+ * @param cap Pointer to a MCP23016 capture file handle.
+ *
+ * Once closed, @p cap is no longer valid for use. Appended records are
+ * written back to the file by the kernel; see mcp23016_capture_sync().
+ */
+void mcp23016_capture_close(struct mcp23016_capture *cap);
+
+/**
+ * @brief Get the description of a capture file.
+ *
+ * @param cap  Pointer to a MCP23016 capture file handle.
+ * @param info Pointer to the description.
+ */
+void mcp23016_capture_get_info(struct mcp23016_capture *cap, struct mcp23016_capture_info *info);
+
+/**
+ * @brief Append a record to a capture file.
+ *
+ * @param cap       Pointer to a MCP23016 capture file handle.
+ * @param timestamp Time of the record in nanoseconds.
+ * @param vals      Pointer to an array of port values, one for each device.
+ *
+ * @return 0 on success, or -1 on error with @c errno set appropriately.
+ *
+ * If the capture file is full, the oldest record is overwritten when
+ * created with the #MCP23016_CAPTURE_WRAP flag; otherwise, -1 is returned
+ * with @c errno set to @c ENOSPC. Only one thread may append records.
+ */
+int mcp23016_capture_append(struct mcp23016_capture *cap, uint64_t timestamp,
+		const uint16_t *vals);
+
+/**
+ * @brief Get the number of records in a capture file.
+ *
+ * @param cap Pointer to a MCP23016 capture file handle.
+ *
+ * @return Number of records that may be read, which does not exceed the
+ * capacity of the capture file.
+ */
+uint64_t mcp23016_capture_count(struct mcp23016_capture *cap);
+
+/**
+ * @brief Read a record from a capture file.
+ *
+ * @param cap       Pointer to a MCP23016 capture file handle.
+ * @param index     Index of the record, where 0 is the oldest record.
+ * @param timestamp Pointer to the time of the record in nanoseconds.
+ * @param vals      Pointer to an array of port values, one for each device.
+ *
+ * @return 0 on success, or -1 on error with @c errno set appropriately.
+ *
+ * If @p index is not less than mcp23016_capture_count(), -1 is returned with
+ * @c errno set to @c ERANGE. If the record was overwritten while being read,
+ * -1 is returned with @c errno set to @c EAGAIN.
+ *
+ * The oldest record changes as records are appended to a capture file
+ * created with the #MCP23016_CAPTURE_WRAP flag; use
+ * mcp23016_capture_read_record() to read such a file while it is being
+ * appended to.
+ */
+int mcp23016_capture_read(struct mcp23016_capture *cap, uint64_t index, uint64_t *timestamp,
+		uint16_t *vals);
+
+/**
+ * @brief Get the number of the oldest record in a capture file.
+ *
+ * @param cap Pointer to a MCP23016 capture file handle.
+ *
+ * @return Number of the oldest record that may be read, where records are
+ * numbered in the order they were appended starting from 0.
+ */
+uint64_t mcp23016_capture_first(struct mcp23016_capture *cap);
+
+/**
+ * @brief Read a record from a capture file by record number.
+ *
+ * @param cap       Pointer to a MCP23016 capture file handle.
+ * @param record    Number of the record; see mcp23016_capture_first().
+ * @param timestamp Pointer to the time of the record in nanoseconds.
+ * @param vals      Pointer to an array of port values, one for each device.
+ *
+ * @return 0 on success, or -1 on error with @c errno set appropriately.
+ *
+ * If @p record has not been appended, -1 is returned with @c errno set to
+ * @c ERANGE. If the record was overwritten before or while being read, -1
+ * is returned with @c errno set to @c EAGAIN.
+ */
+int mcp23016_capture_read_record(struct mcp23016_capture *cap, uint64_t record,
+		uint64_t *timestamp, uint16_t *vals);
+
+/**
+ * @brief Write appended records back to a capture file.
+ *
+ * @param cap Pointer to a MCP23016 capture file handle.
+ *
+ * @return 0 on success, or -1 on error with @c errno set appropriately.
+ *
+ * This function blocks until records are written to storage and should not
+ * be called from a thread appending records on a fixed period.
+ */
+int mcp23016_capture_sync(struct mcp23016_capture *cap);
+
+/** @} **/
+
+/**
+ * @defgroup sampler Real-Time Sampler
+ *
+ * @brief Real-time sampler functions.
+ *
+ * These functions manage a sampler, which samples the port values of
+ * devices on a shared I2C bus at a fixed period from a dedicated thread.
+ * The sampler thread sleeps until absolute deadlines, may be scheduled
+ * using @c SCHED_FIFO and pinned to a CPU, and does not allocate memory
+ * once started. Samples are pushed to an event ring allocated in advance
+ * by the caller, recorded to a capture file, or both. Use of these
+ * functions is considered optional.
+ *
+ * @{
+ */
+
+/**
+ * @struct mcp23016_sampler_config
+ * @brief Struct that describes a sampler configuration.
+ */
+struct mcp23016_sampler_config {
+	uint64_t period;	/**< Sampling period in nanoseconds. */
+	int priority;		/**< @c SCHED_FIFO priority, or 0 to inherit scheduling. */
+	int cpu;		/**< CPU the sampler thread is pinned to, or -1. */
+};
+
+/**
+ * @struct mcp23016_sampler_stats
+ * @brief Struct that describes sampler statistics.
+ */
+struct mcp23016_sampler_stats {
+	uint64_t samples;	/**< Number of samples taken. */
+	uint64_t overruns;	/**< Number of periods missed. */
+	uint64_t errors;	/**< Number of failed samples. */
+};
+
+/**
+ * @struct mcp23016_sampler
+ * @brief Handle to a MCP23016 sampler.
+ */
+struct mcp23016_sampler;
+
+/**
+ * @brief Create a sampler for @p bus.
+ *
+ * @param bus    Pointer to a shared bus handle.
+ * @param config Pointer to the sampler configuration.
+ *
+ * @return Pointer to a MCP23016 sampler handle, or @c NULL on error with
+ * @c errno set appropriately.
+ *
+ * The sampler holds a reference to @p bus. Sampling begins once
+ * mcp23016_sampler_start() is called.
+ */
+struct mcp23016_sampler *mcp23016_sampler_create(struct mcp23016_bus *bus,
+		const struct mcp23016_sampler_config *config);
+
+/**
+ * @brief Destroy a sampler and free associated memory.
+ *
+ * @param sampler Pointer to a MCP23016 sampler handle.
+ *
+ * If started, the sampler thread is stopped before returning, which may
+ * take up to one period. Once destroyed, @p sampler is no longer valid for
+ * use.
+ */
+void mcp23016_sampler_destroy(struct mcp23016_sampler *sampler);
+
+/**
+ * @brief Add a device to a sampler.
+ *
+ * @param sampler Pointer to a MCP23016 sampler handle.
+ * @param dev     Pointer to a MCP23016 device handle.
+ *
+ * @return 0 on success, or -1 on error with @c errno set appropriately.
+ *
+ * @p dev must have been opened on the bus of @p sampler by calling
+ * mcp23016_open_on_bus(). Devices may not be added once the sampler is
+ * started.
+ */
+int mcp23016_sampler_add_device(struct mcp23016_sampler *sampler, struct mcp23016_device *dev);
+
+/**
+ * @brief Attach a capture file to a sampler.
+ *
+ * @param sampler Pointer to a MCP23016 sampler handle.
+ * @param cap     Pointer to a MCP23016 capture file handle, or @c NULL to
+ *                detach the current capture file.
+ *
+ * @return 0 on success, or -1 on error with @c errno set appropriately.
+ *
+ * Once started, each sample appends one record to @p cap. The devices of
+ * @p cap must match the devices added to @p sampler, in the same order, and
+ * timestamps must use @c CLOCK_MONOTONIC; otherwise, mcp23016_sampler_start()
+ * fails with @c errno set to @c EINVAL. Samples that do not fit in @p cap
+ * are counted as errors. A capture file may not be attached once the
+ * sampler is started.
+ */
+int mcp23016_sampler_set_capture(struct mcp23016_sampler *sampler, struct mcp23016_capture *cap);
+
+/**
+ * @brief Start the sampler thread.
+ *
+ * @param sampler Pointer to a MCP23016 sampler handle.
+ * @param ring    Pointer to a MCP23016 event ring handle, or @c NULL if
+ *                samples are only recorded to a capture file.
+ *
+ * @return 0 on success, or -1 on error with @c errno set appropriately.
+ *
+ * Each sample pushes one event per device to @p ring, in the order devices
+ * were added, with @c intcap set to the port value and @c changed set to
+ * the pins that changed state since the previous sample. All events of a
+ * sample share the same timestamp, which is taken before the devices are
+ * read. If neither @p ring nor a capture file is given, -1 is returned with
+ * @c errno set to @c EINVAL.
+ *
+ * The memory of @p sampler, @p ring, the attached capture file mapping, and
+ * the sampler thread stack is locked before sampling begins. Setting
+ * @c priority requires the @c CAP_SYS_NICE capability; -1 is returned with
+ * @c errno set to @c EPERM otherwise. The thread consuming @p ring is the
+ * only thread that may pop events; see mcp23016_ring_pop().
+ */
+int mcp23016_sampler_start(struct mcp23016_sampler *sampler, struct mcp23016_ring *ring);
+
+/**
+ * @brief Get sampler statistics.
+ *
+ * @param sampler Pointer to a MCP23016 sampler handle.
+ * @param stats   Pointer to the statistics.
+ *
+ * Periods are missed when sampling takes longer than the period or the
+ * sampler thread is delayed; missed periods are skipped rather than
+ * sampled late.
+ */
+void mcp23016_sampler_get_stats(struct mcp23016_sampler *sampler,
+		struct mcp23016_sampler_stats *stats);
+
+/** @} **/
+
+/**
+ * @defgroup history Port History
+ *
+ * @brief Port history encoding functions.
+ *
+ * These functions encode the port values of a device sampled over time into
+ * a compact byte stream, and decode the stream back into samples. Only
+ * changes are stored: a changed sample is encoded as the exclusive-or of
+ * the previous and current port values followed by the time elapsed since
+ * the previous stored sample, and consecutive unchanged samples are encoded
+ * as a single run. Integers are encoded as variable-length quantities of 7
+ * bits per byte, so samples that change few pins at short intervals cost
+ * few bytes. Use of these functions is considered optional.
+ *
+ * Timestamps of unchanged samples other than the last of a run are not
+ * stored; they are reconstructed evenly spaced over the run, which is exact
+ * for samples taken at a fixed period. All other timestamps and all port
+ * values are reconstructed exactly.
+ *
+ * @{
+ */
+
+/**
+ * @brief Maximum number of bytes written by mcp23016_encoder_put() and
+ * mcp23016_encoder_flush().
+ */
+#define MCP23016_ENCODE_MAX	33
+
+/**
+ * @struct mcp23016_encoder
+ * @brief Handle to a MCP23016 port history encoder.
+ */
+struct mcp23016_encoder;
+
+/**
+ * @brief Create a port history encoder.
+ *
+ * @return Pointer to a MCP23016 port history encoder handle, or @c NULL on
+ * error with @c errno set appropriately.
+ */
+struct mcp23016_encoder *mcp23016_encoder_create(void);
+
+/**
+ * @brief Destroy a port history encoder and free associated memory.
+ *
+ * @param enc Pointer to a MCP23016 port history encoder handle.
+ *
+ * Once destroyed, @p enc is no longer valid for use. Samples of a pending
+ * run are discarded; see mcp23016_encoder_flush().
+ */
+void mcp23016_encoder_destroy(struct mcp23016_encoder *enc);
+
+/**
+ * @brief Reset a port history encoder to begin a new stream.
+ *
+ * @param enc Pointer to a MCP23016 port history encoder handle.
+ *
+ * Samples of a pending run are discarded. The first sample of a stream is
+ * always encoded as a change relative to a port value of 0 at a timestamp
+ * of 0.
+ */
+void mcp23016_encoder_reset(struct mcp23016_encoder *enc);
+
+/**
+ * @brief Encode a sample.
+ *
+ * @param enc       Pointer to a MCP23016 port history encoder handle.
+ * @param timestamp Time of the sample in nanoseconds.
+ * @param val       Port value.
+ * @param buf       Pointer to a buffer of at least #MCP23016_ENCODE_MAX
+ *                  bytes.
+ *
+ * @return Number of bytes written to @p buf.
+ *
+ * If @p val is unchanged, the sample extends the pending run and nothing is
+ * written. Otherwise, the pending run, if any, is written followed by the
+ * change. This function does not allocate memory or make system calls, and
+ * may be called from a sampling loop.
+ */
+size_t mcp23016_encoder_put(struct mcp23016_encoder *enc, uint64_t timestamp, uint16_t val,
+		void *buf);
+
+/**
+ * @brief Write the pending run of unchanged samples.
+ *
+ * @param enc Pointer to a MCP23016 port history encoder handle.
+ * @param buf Pointer to a buffer of at least #MCP23016_ENCODE_MAX bytes.
+ *
+ * @return Number of bytes written to @p buf.
+ *
+ * This function should be called before the stream is stored, and may be
+ * called periodically to bound the number of samples lost should the
+ * encoder be destroyed before the next change.
+ */
+size_t mcp23016_encoder_flush(struct mcp23016_encoder *enc, void *buf);
+
+/**
+ * @struct mcp23016_decoder
+ * @brief Handle to a MCP23016 port history decoder.
+ */
+struct mcp23016_decoder;
+
+/**
+ * @brief Create a port history decoder for an encoded stream.
+ *
+ * @param buf  Pointer to the encoded stream.
+ * @param size Size of the encoded stream in bytes.
+ *
+ * @return Pointer to a MCP23016 port history decoder handle, or @c NULL on
+ * error with @c errno set appropriately.
+ *
+ * @p buf is not copied and must remain valid until the decoder is
+ * destroyed.
+ */
+struct mcp23016_decoder *mcp23016_decoder_create(const void *buf, size_t size);
+
+/**
+ * @brief Destroy a port history decoder and free associated memory.
+ *
+ * @param dec Pointer to a MCP23016 port history decoder handle.
+ *
+ * Once destroyed, @p dec is no longer valid for use.
+ */
+void mcp23016_decoder_destroy(struct mcp23016_decoder *dec);
+
+/**
+ * @brief Decode samples.
+ *
+ * @param dec        Pointer to a MCP23016 port history decoder handle.
+ * @param timestamps Pointer to an array of timestamps to receive, or
+ *                   @c NULL.
+ * @param vals       Pointer to an array of port values to receive.
+ * @param n          Pointer to the maximum number of samples to receive; on
+ *                   return, the number of samples received.
+ *
+ * @return 0 on success, or -1 on error with @c errno set appropriately.
+ *
+ * Samples are decoded in the order they were encoded; runs are expanded
+ * across calls as needed. Once the end of the stream is reached, 0 is
+ * returned with @p n set to 0. If the stream is malformed or truncated, -1
+ * is returned with @c errno set to @c EBADMSG once the samples preceding
+ * the error have been received.
+ */
+int mcp23016_decoder_read(struct mcp23016_decoder *dec, uint64_t *timestamps, uint16_t *vals,
+		size_t *n);
+
+/** @} **/
+
+/**
+ * @defgroup transpose Bit Transpose
+ *
+ * @brief Bit transpose functions.
+ *
+ * These functions transpose an array of port values into 16 packed
+ * bitstreams, one for each pin, and back. Bit @c j of word @c w of a
+ * bitstream holds the state of the pin in sample <tt>64 * w + j</tt>.
+ * Questions asked of a single pin across many samples, such as its duty
+ * cycle or number of edges, may then be answered a word at a time. Vector
+ * instructions are used where available (SSE2 and AVX2 on x86, NEON on
+ * AArch64), with a portable fallback. Use of these functions is considered
+ * optional.
+ *
+ * @{
+ */
+
+/**
+ * @brief Number of words in a bitstream of @p n samples.
+ *
+ * @param n Number of samples.
+ *
+ * @return Number of 64-bit words.
+ *
+ * The bitstreams of all pins are stored consecutively; the bitstream of a
+ * pin starts at word <tt>pin * mcp23016_bitstream_words(n)</tt>.
+ */
+size_t mcp23016_bitstream_words(size_t n);
+
+/**
+ * @brief Transpose port values into per-pin bitstreams.
+ *
+ * @param samples Pointer to an array of @p n port values.
+ * @param n       Number of port values.
+ * @param bits    Pointer to an array of <tt>16 * mcp23016_bitstream_words(n)</tt>
+ *                words to receive the bitstreams.
+ *
+ * Bits beyond the last sample of each bitstream are cleared.
+ */
+void mcp23016_transpose(const uint16_t *samples, size_t n, uint64_t *bits);
+
+/**
+ * @brief Transpose per-pin bitstreams into port values.
+ *
+ * @param bits    Pointer to an array of <tt>16 * mcp23016_bitstream_words(n)</tt>
+ *                words holding the bitstreams.
+ * @param n       Number of port values.
+ * @param samples Pointer to an array of @p n port values to receive.
+ *
+ * This function is the inverse of mcp23016_transpose().
+ */
+void mcp23016_untranspose(const uint64_t *bits, size_t n, uint16_t *samples);
+
+/**
+ * @brief Count the samples in which a pin is high.
+ *
+ * @param bits Pointer to the bitstream of a pin.
+ * @param n    Number of samples.
+ *
+ * @return Number of samples in which the pin is high.
+ *
+ * The duty cycle of the pin is the returned value divided by @p n.
+ */
+uint64_t mcp23016_bitstream_high(const uint64_t *bits, size_t n);
+
+/**
+ * @brief Count the edges of a pin.
+ *
+ * @param bits    Pointer to the bitstream of a pin.
+ * @param n       Number of samples.
+ * @param rising  Pointer to the number of rising edges.
+ * @param falling Pointer to the number of falling edges.
+ *
+ * An edge is counted for each sample whose state differs from the state of
+ * the preceding sample; the first sample never counts as an edge.
+ */
+void mcp23016_bitstream_edges(const uint64_t *bits, size_t n, uint64_t *rising,
+		uint64_t *falling);
+
 /** @} **/
 /** @} **/
 
@@ -0,0 +1,352 @@
+/* SPDX-License-Identifier: LGPL-2.1-or-later */
+/*
+ * Copyright (C) 2021 Steven Stallion <sstallion@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mcp23016-private.h"
+
+#include <assert.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/* Records hold a timestamp followed by one port value per device and are
+ * padded so that timestamps remain naturally aligned.
+ */
+static inline size_t capture_record_size(size_t num_devs)
+{
+	size_t size = sizeof(uint64_t) + num_devs * sizeof(uint16_t);
+
+	return (size + sizeof(uint64_t) - 1) & ~(sizeof(uint64_t) - 1);
+}
+
+static void capture_init(struct mcp23016_capture *cap, struct capture_header *hdr, size_t size)
+{
+	cap->hdr = hdr;
+	cap->records = (uint8_t *)hdr + hdr->header_size;
+	cap->size = size;
+	cap->record_size = hdr->record_size;
+	cap->capacity = hdr->capacity;
+}
+
+struct mcp23016_capture *mcp23016_capture_create(const char *path,
+		const struct mcp23016_capture_info *info)
+{
+	struct mcp23016_capture *cap;
+	struct capture_header *hdr;
+	size_t record_size, size, i;
+	int fd, res;
+
+	assert(path != NULL);
+	assert(info != NULL);
+
+	if (info->num_devices == 0 || info->num_devices > MCP23016_DEVICE_MAX ||
+	    info->capacity == 0 || (info->flags & ~MCP23016_CAPTURE_WRAP) != 0) {
+		errno = EINVAL;
+		return NULL;
+	}
+
+	for (i = 0; i < info->num_devices; i++) {
+		if (info->devices[i] >= MCP23016_DEVICE_MAX) {
+			errno = EINVAL;
+			return NULL;
+		}
+	}
+
+	record_size = capture_record_size(info->num_devices);
+	if (info->capacity > (SIZE_MAX - sizeof(*hdr)) / record_size) {
+		errno = EFBIG;
+		return NULL;
+	}
+	size = sizeof(*hdr) + info->capacity * record_size;
+
+	cap = calloc(1, sizeof(*cap));
+	if (cap == NULL)
+		return NULL;
+
+	fd = open(path, O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0666);
+	if (fd < 0)
+		goto err;
+
+	/* Blocks are allocated up front so that stores to the mapping never
+	 * fault for lack of space once appending begins.
+	 */
+	res = posix_fallocate(fd, 0, size);
+	if (res != 0) {
+		errno = res;
+		goto err_unlink;
+	}
+
+	hdr = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	if (hdr == MAP_FAILED)
+		goto err_unlink;
+
+	close(fd);
+
+	memcpy(hdr->magic, CAPTURE_MAGIC, sizeof(hdr->magic));
+	hdr->version = CAPTURE_VERSION;
+	hdr->header_size = sizeof(*hdr);
+	hdr->record_size = record_size;
+	hdr->num_devs = info->num_devices;
+	for (i = 0; i < info->num_devices; i++)
+		hdr->devices[i] = info->devices[i];
+	hdr->period = info->period;
+	hdr->clock = info->clock;
+	hdr->flags = info->flags;
+	hdr->capacity = info->capacity;
+	atomic_init(&hdr->head, 0);
+	atomic_init(&hdr->count, 0);
+
+	capture_init(cap, hdr, size);
+	cap->writable = 1;
+	return cap;
+err_unlink:
+	res = errno;
+	close(fd);
+	unlink(path);
+	errno = res;
+err:
+	free(cap);
+	return NULL;
+}
+
+static int capture_valid(const struct capture_header *hdr, size_t size)
+{
+	if (memcmp(hdr->magic, CAPTURE_MAGIC, sizeof(hdr->magic)) != 0 ||
+	    hdr->version != CAPTURE_VERSION ||
+	    hdr->header_size != sizeof(*hdr) ||
+	    hdr->num_devs == 0 || hdr->num_devs > MCP23016_DEVICE_MAX ||
+	    hdr->record_size != capture_record_size(hdr->num_devs) ||
+	    hdr->capacity == 0)
+		return 0;
+
+	/* Files written by a host of differing byte order fail the version
+	 * check above; the capacity must also fit within the file.
+	 */
+	return hdr->capacity <= (size - sizeof(*hdr)) / hdr->record_size;
+}
+
+struct mcp23016_capture *mcp23016_capture_open(const char *path)
+{
+	struct mcp23016_capture *cap;
+	struct capture_header *hdr;
+	struct stat st;
+	int fd, res;
+
+	assert(path != NULL);
+
+	cap = calloc(1, sizeof(*cap));
+	if (cap == NULL)
+		return NULL;
+
+	fd = open(path, O_RDONLY | O_CLOEXEC);
+	if (fd < 0)
+		goto err;
+
+	if (fstat(fd, &st) < 0)
+		goto err_close;
+
+	if ((uint64_t)st.st_size < sizeof(*hdr) || (uint64_t)st.st_size > SIZE_MAX) {
+		errno = EINVAL;
+		goto err_close;
+	}
+
+	hdr = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	if (hdr == MAP_FAILED)
+		goto err_close;
+
+	close(fd);
+
+	if (!capture_valid(hdr, st.st_size)) {
+		munmap(hdr, st.st_size);
+		errno = EINVAL;
+		goto err;
+	}
+
+	capture_init(cap, hdr, st.st_size);
+	return cap;
+err_close:
+	res = errno;
+	close(fd);
+	errno = res;
+err:
+	free(cap);
+	return NULL;
+}
+
+void mcp23016_capture_close(struct mcp23016_capture *cap)
+{
+	assert(cap != NULL);
+
+	munmap(cap->hdr, cap->size);
+
+	free(cap);
+}
+
+void mcp23016_capture_get_info(struct mcp23016_capture *cap, struct mcp23016_capture_info *info)
+{
+	const struct capture_header *hdr;
+	size_t i;
+
+	assert(cap != NULL);
+	assert(info != NULL);
+
+	hdr = cap->hdr;
+
+	memset(info, 0, sizeof(*info));
+	for (i = 0; i < hdr->num_devs; i++)
+		info->devices[i] = hdr->devices[i];
+	info->num_devices = hdr->num_devs;
+	info->period = hdr->period;
+	info->clock = hdr->clock;
+	info->capacity = hdr->capacity;
+	info->flags = hdr->flags;
+}
+
+int mcp23016_capture_append(struct mcp23016_capture *cap, uint64_t timestamp,
+		const uint16_t *vals)
+{
+	uint8_t *rec;
+
+	assert(cap != NULL);
+	assert(vals != NULL);
+
+	if (!cap->writable) {
+		errno = EBADF;
+		return -1;
+	}
+
+	if (cap->count >= cap->capacity && !(cap->hdr->flags & MCP23016_CAPTURE_WRAP)) {
+		errno = ENOSPC;
+		return -1;
+	}
+
+	/* Readers detect records overwritten while being read by checking
+	 * the number of records started; the release fence orders it before
+	 * the record stores once the oldest record is overwritten.
+	 */
+	atomic_store_explicit(&cap->hdr->head, cap->count + 1, memory_order_relaxed);
+	if (cap->count >= cap->capacity)
+		atomic_thread_fence(memory_order_release);
+
+	rec = cap->records + cap->slot * cap->record_size;
+	memcpy(rec, &timestamp, sizeof(timestamp));
+	memcpy(rec + sizeof(timestamp), vals, cap->hdr->num_devs * sizeof(*vals));
+
+	if (++cap->slot == cap->capacity)
+		cap->slot = 0;
+
+	/* Readers observe the record once the count is published. */
+	atomic_store_explicit(&cap->hdr->count, ++cap->count, memory_order_release);
+	return 0;
+}
+
+uint64_t mcp23016_capture_count(struct mcp23016_capture *cap)
+{
+	uint64_t count;
+
+	assert(cap != NULL);
+
+	count = atomic_load_explicit(&cap->hdr->count, memory_order_acquire);
+	return count < cap->capacity ? count : cap->capacity;
+}
+
+uint64_t mcp23016_capture_first(struct mcp23016_capture *cap)
+{
+	uint64_t count;
+
+	assert(cap != NULL);
+
+	count = atomic_load_explicit(&cap->hdr->count, memory_order_acquire);
+	return count > cap->capacity ? count - cap->capacity : 0;
+}
+
+static int capture_read_record(struct mcp23016_capture *cap, uint64_t record,
+		uint64_t *timestamp, uint16_t *vals)
+{
+	const uint8_t *rec;
+	uint64_t head;
+
+	rec = cap->records + (record % cap->capacity) * cap->record_size;
+	memcpy(timestamp, rec, sizeof(*timestamp));
+	memcpy(vals, rec + sizeof(*timestamp), cap->hdr->num_devs * sizeof(*vals));
+
+	/* A record is overwritten by the record started one capacity
+	 * later.
+	 */
+	atomic_thread_fence(memory_order_acquire);
+	head = atomic_load_explicit(&cap->hdr->head, memory_order_relaxed);
+	if (record + cap->capacity < head) {
+		errno = EAGAIN;
+		return -1;
+	}
+	return 0;
+}
+
+int mcp23016_capture_read(struct mcp23016_capture *cap, uint64_t index, uint64_t *timestamp,
+		uint16_t *vals)
+{
+	uint64_t count, first;
+
+	assert(cap != NULL);
+	assert(timestamp != NULL);
+	assert(vals != NULL);
+
+	count = atomic_load_explicit(&cap->hdr->count, memory_order_acquire);
+	first = count > cap->capacity ? count - cap->capacity : 0;
+	if (index >= count - first) {
+		errno = ERANGE;
+		return -1;
+	}
+
+	return capture_read_record(cap, first + index, timestamp, vals);
+}
+
+int mcp23016_capture_read_record(struct mcp23016_capture *cap, uint64_t record,
+		uint64_t *timestamp, uint16_t *vals)
+{
+	uint64_t count;
+
+	assert(cap != NULL);
+	assert(timestamp != NULL);
+	assert(vals != NULL);
+
+	count = atomic_load_explicit(&cap->hdr->count, memory_order_acquire);
+	if (record >= count) {
+		errno = ERANGE;
+		return -1;
+	}
+
+	if (record + cap->capacity < count) {
+		errno = EAGAIN;
+		return -1;
+	}
+
+	return capture_read_record(cap, record, timestamp, vals);
+}
+
+int mcp23016_capture_sync(struct mcp23016_capture *cap)
+{
+	assert(cap != NULL);
+
+	return msync(cap->hdr, cap->size, MS_SYNC);
+}
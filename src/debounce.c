@@ -0,0 +1,182 @@
+/* SPDX-License-Identifier: LGPL-2.1-or-later */
+/*
+ * Copyright (C) 2021 Steven Stallion <sstallion@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mcp23016-private.h"
+
+#include <assert.h>
+#include <errno.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+/* Debounce state is kept in vertical counters: bit n of count[i] holds bit
+ * i of the counter for pin n. This permits all pins to be updated using a
+ * fixed number of bitwise operations regardless of how many are bouncing.
+ */
+
+static void debounce_add(uint16_t *count, unsigned int ticks)
+{
+	uint16_t carry = 0;
+	size_t i;
+
+	for (i = 0; i < DEBOUNCE_PLANES; i++) {
+		uint16_t c = count[i];
+		uint16_t k = -(uint16_t)((ticks >> i) & 1);
+
+		count[i] = c ^ k ^ carry;
+		carry = (c & k) | (carry & (c ^ k));
+	}
+
+	/* Counters saturate rather than wrap. */
+	for (i = 0; i < DEBOUNCE_PLANES; i++)
+		count[i] |= carry;
+}
+
+static uint16_t debounce_expired(const uint16_t *count, const uint16_t *window)
+{
+	uint16_t gt = 0, eq = 0xffff;
+	size_t i;
+
+	for (i = DEBOUNCE_PLANES; i-- > 0;) {
+		gt |= eq & count[i] & ~window[i];
+		eq &= ~(count[i] ^ window[i]);
+	}
+	return gt | eq;
+}
+
+static void debounce_sample(struct mcp23016_debounce *db, uint16_t raw)
+{
+	uint16_t diff = raw ^ db->state;
+	size_t i;
+
+	/* Pins that match the debounced state restart their window. */
+	db->raw = raw;
+	for (i = 0; i < DEBOUNCE_PLANES; i++)
+		db->count[i] &= diff;
+}
+
+static void debounce_advance(struct mcp23016_debounce *db, unsigned int ticks)
+{
+	uint16_t diff = db->raw ^ db->state;
+	uint16_t done;
+	size_t i;
+
+	debounce_add(db->count, ticks);
+	for (i = 0; i < DEBOUNCE_PLANES; i++)
+		db->count[i] &= diff;
+
+	done = diff & debounce_expired(db->count, db->window);
+	db->state ^= done;
+	for (i = 0; i < DEBOUNCE_PLANES; i++)
+		db->count[i] &= ~done;
+}
+
+struct mcp23016_debounce *mcp23016_debounce_create(uint16_t initial, uint64_t period)
+{
+	struct mcp23016_debounce *db;
+
+	if (period == 0) {
+		errno = EINVAL;
+		return NULL;
+	}
+
+	db = calloc(1, sizeof(*db));
+	if (db == NULL)
+		return NULL;
+
+	db->state = initial;
+	db->raw = initial;
+	db->period = period;
+	return db;
+}
+
+void mcp23016_debounce_destroy(struct mcp23016_debounce *db)
+{
+	assert(db != NULL);
+
+	free(db);
+}
+
+int mcp23016_debounce_set_window(struct mcp23016_debounce *db, uint16_t mask, uint64_t window)
+{
+	uint64_t ticks;
+	size_t i;
+
+	assert(db != NULL);
+
+	/* Windows are rounded up to a whole number of periods. */
+	ticks = window / db->period + (window % db->period != 0);
+	if (ticks > MCP23016_DEBOUNCE_MAX) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	for (i = 0; i < DEBOUNCE_PLANES; i++) {
+		db->window[i] &= ~mask;
+		db->window[i] |= mask & -(uint16_t)((ticks >> i) & 1);
+	}
+	return 0;
+}
+
+uint16_t mcp23016_debounce_update(struct mcp23016_debounce *db, uint16_t raw)
+{
+	uint16_t state;
+
+	assert(db != NULL);
+
+	state = db->state;
+	debounce_sample(db, raw);
+	debounce_advance(db, 1);
+	return state ^ db->state;
+}
+
+uint16_t mcp23016_debounce_update_at(struct mcp23016_debounce *db, uint16_t raw, uint64_t now)
+{
+	uint64_t ticks = 0;
+	uint16_t state;
+
+	assert(db != NULL);
+
+	if (now > db->last) {
+		ticks = (now - db->last) / db->period;
+		db->last += ticks * db->period;
+	}
+
+	/* Time elapsed since the last update is accounted to the previous
+	 * input value before the new value is applied; pins with an empty
+	 * window change state immediately.
+	 */
+	state = db->state;
+	debounce_advance(db, ticks > MCP23016_DEBOUNCE_MAX ? MCP23016_DEBOUNCE_MAX : ticks);
+	debounce_sample(db, raw);
+	debounce_advance(db, 0);
+	return state ^ db->state;
+}
+
+uint16_t mcp23016_debounce_get_state(const struct mcp23016_debounce *db)
+{
+	assert(db != NULL);
+
+	return db->state;
+}
+
+uint16_t mcp23016_debounce_get_pending(const struct mcp23016_debounce *db)
+{
+	assert(db != NULL);
+
+	return db->raw ^ db->state;
+}
@@ -0,0 +1,291 @@
+/* SPDX-License-Identifier: LGPL-2.1-or-later */
+/*
+ * Copyright (C) 2021 Steven Stallion <sstallion@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mcp23016-private.h"
+
+#include <assert.h>
+#include <errno.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <time.h>
+
+static inline uint16_t edge_mask(int edges, enum mcp23016_edge edge, uint16_t mask)
+{
+	return (edges & edge) ? mask : 0;
+}
+
+struct mcp23016_dispatcher *mcp23016_dispatcher_create(struct mcp23016_device *dev,
+		struct mcp23016_interrupt *intr)
+{
+	struct mcp23016_dispatcher *disp;
+
+	assert(dev != NULL);
+
+	disp = calloc(1, sizeof(*disp));
+	if (disp == NULL)
+		return NULL;
+
+	disp->dev = dev;
+	disp->intr = intr;
+
+	/* Reading the port value establishes the initial pin state and
+	 * clears pending interrupts.
+	 */
+	if (mcp23016_get_port(dev, &disp->state.current) < 0)
+		goto err;
+
+	return disp;
+err:
+	free(disp);
+	return NULL;
+}
+
+void mcp23016_dispatcher_destroy(struct mcp23016_dispatcher *disp)
+{
+	assert(disp != NULL);
+
+	free(disp);
+}
+
+int mcp23016_dispatcher_set_pin_handler(struct mcp23016_dispatcher *disp, unsigned int pin,
+		int edges, mcp23016_pin_handler fn, void *arg)
+{
+	assert(disp != NULL);
+
+	if (pin >= ARRAY_SIZE(disp->pin_handlers)) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	if (fn == NULL)
+		edges = 0;
+
+	disp->pin_handlers[pin].fn = fn;
+	disp->pin_handlers[pin].arg = arg;
+
+	disp->rising_pins &= ~BIT(pin);
+	disp->rising_pins |= edge_mask(edges, MCP23016_EDGE_RISING, BIT(pin));
+	disp->falling_pins &= ~BIT(pin);
+	disp->falling_pins |= edge_mask(edges, MCP23016_EDGE_FALLING, BIT(pin));
+	return 0;
+}
+
+int mcp23016_dispatcher_add_mask_handler(struct mcp23016_dispatcher *disp, uint16_t mask,
+		int edges, mcp23016_mask_handler fn, void *arg)
+{
+	size_t i;
+
+	assert(disp != NULL);
+	assert(fn != NULL);
+
+	i = disp->num_mask_handlers;
+	if (i >= ARRAY_SIZE(disp->mask_handlers)) {
+		errno = ENOSPC;
+		return -1;
+	}
+
+	disp->mask_handlers[i].rising = edge_mask(edges, MCP23016_EDGE_RISING, mask);
+	disp->mask_handlers[i].falling = edge_mask(edges, MCP23016_EDGE_FALLING, mask);
+	disp->mask_handlers[i].fn = fn;
+	disp->mask_handlers[i].arg = arg;
+
+	disp->num_mask_handlers++;
+	return 0;
+}
+
+void mcp23016_dispatcher_set_ring(struct mcp23016_dispatcher *disp, struct mcp23016_ring *ring)
+{
+	assert(disp != NULL);
+
+	disp->ring = ring;
+}
+
+void mcp23016_dispatcher_set_snapshot(struct mcp23016_dispatcher *disp,
+		struct mcp23016_snapshot *snap)
+{
+	assert(disp != NULL);
+
+	disp->snap = snap;
+	if (snap != NULL)
+		mcp23016_snapshot_publish(snap, disp->state.current, disp->state.captured);
+}
+
+int mcp23016_dispatcher_set_coalesce(struct mcp23016_dispatcher *disp, uint64_t window_ns,
+		unsigned int max_edges)
+{
+	assert(disp != NULL);
+
+	if (window_ns != 0 &&
+	    (disp->intr == NULL || !(disp->intr->flags & MCP23016_INTERRUPT_EVENTS))) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	disp->coalesce_window = window_ns;
+	disp->coalesce_max = max_edges;
+	return 0;
+}
+
+void mcp23016_dispatcher_get_stats(struct mcp23016_dispatcher *disp,
+		struct mcp23016_dispatcher_stats *stats)
+{
+	assert(disp != NULL);
+	assert(stats != NULL);
+
+	*stats = disp->stats;
+}
+
+static int coalesce(struct mcp23016_dispatcher *disp)
+{
+	uint64_t deadline, now;
+	struct timespec remaining;
+	unsigned int edges = 1;
+	int res;
+
+	/* The interrupt is serviced once the window elapses or the edge
+	 * limit is reached; each wait consumes a single edge event.
+	 */
+	deadline = monotonic_ns() + disp->coalesce_window;
+	while (disp->coalesce_max == 0 || edges < disp->coalesce_max) {
+		now = monotonic_ns();
+		if (now >= deadline)
+			break;
+
+		remaining.tv_sec = (deadline - now) / 1000000000;
+		remaining.tv_nsec = (deadline - now) % 1000000000;
+
+		res = mcp23016_interrupt_wait(disp->intr, &remaining);
+		if (res < 0)
+			return res;
+		if (res == 0)
+			break;
+
+		disp->stats.edges++;
+		disp->stats.merged++;
+		edges++;
+	}
+	return 0;
+}
+
+static void dispatch_pins(struct mcp23016_dispatcher *disp, uint16_t prev, uint16_t val)
+{
+	uint16_t changed, rising, falling;
+	unsigned int pins, pin;
+
+	changed = val ^ prev;
+	rising = changed & val;
+	falling = changed & ~val;
+
+	/* Only pins with registered handlers are visited; each iteration
+	 * clears the lowest set bit.
+	 */
+	pins = (rising & disp->rising_pins) | (falling & disp->falling_pins);
+	while (pins != 0) {
+		pin = __builtin_ctz(pins);
+		pins &= pins - 1;
+
+		disp->pin_handlers[pin].fn(disp->dev, pin,
+				(rising & BIT(pin)) ? MCP23016_EDGE_RISING : MCP23016_EDGE_FALLING,
+				disp->pin_handlers[pin].arg);
+	}
+}
+
+int mcp23016_dispatcher_dispatch(struct mcp23016_dispatcher *disp)
+{
+	uint16_t previous, captured, current, rising, falling;
+	size_t i;
+	int res;
+
+	assert(disp != NULL);
+
+	res = mcp23016_service_interrupt(disp->dev, &disp->state);
+	if (res < 0)
+		return res;
+
+	disp->stats.services++;
+
+	previous = disp->state.previous;
+	captured = disp->state.captured;
+	current = disp->state.current;
+
+	if (disp->snap != NULL)
+		mcp23016_snapshot_publish(disp->snap, current, captured);
+
+	/* Edges up to the captured value are combined with edges that
+	 * occurred after the capture; a pin that changed state more than
+	 * once is reported as both rising and falling.
+	 */
+	rising = ((previous ^ captured) & captured) | ((captured ^ current) & current);
+	falling = ((previous ^ captured) & ~captured) | ((captured ^ current) & ~current);
+	if ((rising | falling) == 0)
+		return 0;
+
+	if (disp->ring != NULL)
+		mcp23016_ring_record(disp->ring, disp->dev, captured, rising | falling);
+
+	for (i = 0; i < disp->num_mask_handlers; i++) {
+		uint16_t r = rising & disp->mask_handlers[i].rising;
+		uint16_t f = falling & disp->mask_handlers[i].falling;
+
+		if (r | f)
+			disp->mask_handlers[i].fn(disp->dev, r, f, disp->mask_handlers[i].arg);
+	}
+
+	/* Pin handlers are invoked in the order edges occurred: edges up to
+	 * the captured value, followed by edges that occurred after the
+	 * capture.
+	 */
+	dispatch_pins(disp, previous, captured);
+	dispatch_pins(disp, captured, current);
+	return 0;
+}
+
+int mcp23016_dispatcher_run(struct mcp23016_dispatcher *disp, const struct timespec *timeout)
+{
+	int res;
+
+	assert(disp != NULL);
+
+	if (disp->intr == NULL) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	if (disp->intr->flags & MCP23016_INTERRUPT_EVENTS)
+		res = mcp23016_interrupt_wait(disp->intr, timeout);
+	else
+		res = mcp23016_has_interrupt(disp->intr);
+	if (res <= 0)
+		return res;
+
+	if (disp->intr->flags & MCP23016_INTERRUPT_EVENTS) {
+		disp->stats.edges++;
+
+		if (disp->coalesce_window != 0) {
+			res = coalesce(disp);
+			if (res < 0)
+				return res;
+		}
+	}
+
+	res = mcp23016_dispatcher_dispatch(disp);
+	if (res < 0)
+		return res;
+
+	return 1;
+}
@@ -0,0 +1,146 @@
+/* SPDX-License-Identifier: LGPL-2.1-or-later */
+/*
+ * Copyright (C) 2021 Steven Stallion <sstallion@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mcp23016-private.h"
+
+#include <assert.h>
+#include <errno.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <time.h>
+
+struct mcp23016_group *mcp23016_group_create(struct mcp23016_interrupt *intr,
+		struct mcp23016_device *const *devs, size_t n)
+{
+	struct mcp23016_group *grp;
+	size_t i;
+
+	assert(intr != NULL);
+	assert(devs != NULL);
+
+	if (n == 0 || n > MCP23016_DEVICE_MAX) {
+		errno = EINVAL;
+		return NULL;
+	}
+
+	for (i = 0; i < n; i++) {
+		assert(devs[i] != NULL);
+
+		if (devs[i]->i2c_dev != devs[0]->i2c_dev) {
+			errno = EINVAL;
+			return NULL;
+		}
+	}
+
+	grp = calloc(1, sizeof(*grp));
+	if (grp == NULL)
+		return NULL;
+
+	grp->intr = intr;
+	for (i = 0; i < n; i++)
+		grp->devs[i] = devs[i];
+	grp->num_devs = n;
+
+	/* Changes are determined by comparing interrupt capture values, so
+	 * the initial state is read from the same registers; devices that
+	 * have not asserted the interrupt output since retain their capture
+	 * values. Reading also clears pending interrupts on all devices.
+	 */
+	if (mcp23016_register_read_multi(grp->devs, grp->num_devs, REG_INTCAP0, grp->last) < 0)
+		goto err;
+
+	return grp;
+err:
+	free(grp);
+	return NULL;
+}
+
+void mcp23016_group_destroy(struct mcp23016_group *grp)
+{
+	assert(grp != NULL);
+
+	free(grp);
+}
+
+void mcp23016_group_set_ring(struct mcp23016_group *grp, struct mcp23016_ring *ring)
+{
+	assert(grp != NULL);
+
+	grp->ring = ring;
+}
+
+int mcp23016_group_service(struct mcp23016_group *grp, mcp23016_group_handler fn, void *arg)
+{
+	uint16_t vals[MCP23016_DEVICE_MAX];
+	unsigned int pass;
+	size_t i;
+	int res;
+
+	assert(grp != NULL);
+
+	/* The interrupt output is shared by all devices in the group; a
+	 * device may assert it again while others are being serviced, so
+	 * devices are read until the output is no longer asserted.
+	 */
+	for (pass = 0; pass < GROUP_PASS_MAX; pass++) {
+		res = mcp23016_register_read_multi(grp->devs, grp->num_devs, REG_INTCAP0, vals);
+		if (res < 0)
+			return res;
+
+		for (i = 0; i < grp->num_devs; i++) {
+			uint16_t changed = vals[i] ^ grp->last[i];
+
+			grp->last[i] = vals[i];
+			if (changed == 0)
+				continue;
+
+			if (grp->ring != NULL)
+				mcp23016_ring_record(grp->ring, grp->devs[i], vals[i], changed);
+			if (fn != NULL)
+				fn(grp->devs[i], vals[i], changed, arg);
+		}
+
+		res = mcp23016_has_interrupt(grp->intr);
+		if (res <= 0)
+			return res;
+	}
+
+	errno = EAGAIN;
+	return -1;
+}
+
+int mcp23016_group_run(struct mcp23016_group *grp, const struct timespec *timeout,
+		mcp23016_group_handler fn, void *arg)
+{
+	int res;
+
+	assert(grp != NULL);
+
+	if (grp->intr->flags & MCP23016_INTERRUPT_EVENTS)
+		res = mcp23016_interrupt_wait(grp->intr, timeout);
+	else
+		res = mcp23016_has_interrupt(grp->intr);
+	if (res <= 0)
+		return res;
+
+	res = mcp23016_group_service(grp, fn, arg);
+	if (res < 0)
+		return res;
+
+	return 1;
+}
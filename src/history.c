@@ -0,0 +1,261 @@
+/* SPDX-License-Identifier: LGPL-2.1-or-later */
+/*
+ * Copyright (C) 2021 Steven Stallion <sstallion@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mcp23016-private.h"
+
+#include <assert.h>
+#include <errno.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+/* Each record begins with a header whose low bit selects the record type:
+ * a change carries the exclusive-or of the port values in the remaining
+ * bits followed by the time elapsed since the last stored sample, and a run
+ * carries the number of unchanged samples followed by the time elapsed up
+ * to the last sample of the run.
+ */
+#define RECORD_CHANGE	0
+#define RECORD_RUN	1
+
+/* Maximum number of bytes in an encoded 64-bit integer */
+#define VARINT_MAX	10
+
+_Static_assert(MCP23016_ENCODE_MAX == 2 * VARINT_MAX + 3 + VARINT_MAX,
+	       "invalid encode size");
+
+static inline size_t varint_put(uint8_t *buf, uint64_t x)
+{
+	size_t n = 0;
+
+	while (x >= 0x80) {
+		buf[n++] = x | 0x80;
+		x >>= 7;
+	}
+	buf[n++] = x;
+	return n;
+}
+
+static inline int varint_get(struct mcp23016_decoder *dec, uint64_t *x)
+{
+	const uint8_t *pos = dec->pos;
+	unsigned int shift;
+	uint64_t val = 0;
+
+	for (shift = 0; shift < 7 * VARINT_MAX; shift += 7) {
+		if (pos == dec->end)
+			return -1;
+
+		val |= (uint64_t)(*pos & 0x7f) << shift;
+		if (!(*pos++ & 0x80)) {
+			dec->pos = pos;
+			*x = val;
+			return 0;
+		}
+	}
+	return -1;
+}
+
+struct mcp23016_encoder *mcp23016_encoder_create(void)
+{
+	return calloc(1, sizeof(struct mcp23016_encoder));
+}
+
+void mcp23016_encoder_destroy(struct mcp23016_encoder *enc)
+{
+	assert(enc != NULL);
+
+	free(enc);
+}
+
+void mcp23016_encoder_reset(struct mcp23016_encoder *enc)
+{
+	assert(enc != NULL);
+
+	enc->timestamp = 0;
+	enc->last = 0;
+	enc->run = 0;
+	enc->val = 0;
+	enc->stored = 0;
+}
+
+static size_t encoder_put_run(struct mcp23016_encoder *enc, uint8_t *buf)
+{
+	size_t n;
+
+	n = varint_put(buf, enc->run << 1 | RECORD_RUN);
+	n += varint_put(buf + n, enc->last - enc->timestamp);
+
+	enc->timestamp = enc->last;
+	enc->run = 0;
+	return n;
+}
+
+size_t mcp23016_encoder_put(struct mcp23016_encoder *enc, uint64_t timestamp, uint16_t val,
+		void *buf)
+{
+	uint8_t *p = buf;
+	size_t n = 0;
+
+	assert(enc != NULL);
+	assert(buf != NULL);
+
+	/* The first sample is always stored as a change, even if no pins
+	 * differ from the initial value of 0, so that its timestamp is
+	 * reconstructed exactly.
+	 */
+	if (enc->stored && val == enc->val) {
+		enc->last = timestamp;
+		enc->run++;
+		return 0;
+	}
+
+	if (enc->run > 0)
+		n = encoder_put_run(enc, p);
+
+	/* Elapsed time is computed modulo 2^64, so timestamps that go
+	 * backwards are still reconstructed exactly.
+	 */
+	n += varint_put(p + n, (uint64_t)(enc->val ^ val) << 1 | RECORD_CHANGE);
+	n += varint_put(p + n, timestamp - enc->timestamp);
+
+	enc->timestamp = timestamp;
+	enc->last = timestamp;
+	enc->val = val;
+	enc->stored = 1;
+	return n;
+}
+
+size_t mcp23016_encoder_flush(struct mcp23016_encoder *enc, void *buf)
+{
+	assert(enc != NULL);
+	assert(buf != NULL);
+
+	if (enc->run == 0)
+		return 0;
+
+	return encoder_put_run(enc, buf);
+}
+
+struct mcp23016_decoder *mcp23016_decoder_create(const void *buf, size_t size)
+{
+	struct mcp23016_decoder *dec;
+
+	assert(buf != NULL || size == 0);
+
+	dec = calloc(1, sizeof(*dec));
+	if (dec == NULL)
+		return NULL;
+
+	dec->pos = buf;
+	dec->end = dec->pos + size;
+	return dec;
+}
+
+void mcp23016_decoder_destroy(struct mcp23016_decoder *dec)
+{
+	assert(dec != NULL);
+
+	free(dec);
+}
+
+/* Records are decoded in place; on error the position is left at the start
+ * of the malformed record so that the error is reported again.
+ */
+static int decoder_next(struct mcp23016_decoder *dec)
+{
+	const uint8_t *start = dec->pos;
+	uint64_t hdr, elapsed;
+
+	if (varint_get(dec, &hdr) < 0 || varint_get(dec, &elapsed) < 0)
+		goto err;
+
+	/* Streams begin with a change, which is the only change that may
+	 * be empty.
+	 */
+	if ((hdr & 1) == RECORD_RUN) {
+		if ((hdr >> 1) == 0 || !dec->started)
+			goto err;
+
+		dec->run = hdr >> 1;
+		dec->step = elapsed / dec->run;
+		dec->run_end = dec->timestamp + elapsed;
+	} else {
+		if (((hdr >> 1) == 0 && dec->started) || (hdr >> 1) > UINT16_MAX)
+			goto err;
+
+		dec->val ^= hdr >> 1;
+		dec->timestamp += elapsed;
+	}
+	dec->started = 1;
+	return 0;
+err:
+	dec->pos = start;
+	errno = EBADMSG;
+	return -1;
+}
+
+int mcp23016_decoder_read(struct mcp23016_decoder *dec, uint64_t *timestamps, uint16_t *vals,
+		size_t *n)
+{
+	size_t i = 0;
+
+	assert(dec != NULL);
+	assert(vals != NULL);
+	assert(n != NULL);
+
+	while (i < *n) {
+		if (dec->run > 0) {
+			/* The last sample of a run carries its stored
+			 * timestamp; remaining samples are evenly spaced.
+			 */
+			while (dec->run > 1 && i < *n) {
+				dec->timestamp += dec->step;
+				if (timestamps != NULL)
+					timestamps[i] = dec->timestamp;
+				vals[i++] = dec->val;
+				dec->run--;
+			}
+			if (dec->run == 1 && i < *n) {
+				dec->timestamp = dec->run_end;
+				if (timestamps != NULL)
+					timestamps[i] = dec->timestamp;
+				vals[i++] = dec->val;
+				dec->run = 0;
+			}
+			continue;
+		}
+
+		if (dec->pos == dec->end)
+			break;
+
+		if (decoder_next(dec) < 0) {
+			if (i > 0)
+				break;
+			return -1;
+		}
+
+		if (dec->run == 0) {
+			if (timestamps != NULL)
+				timestamps[i] = dec->timestamp;
+			vals[i++] = dec->val;
+		}
+	}
+
+	*n = i;
+	return 0;
+}
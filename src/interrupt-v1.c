@@ -0,0 +1,167 @@
+/* SPDX-License-Identifier: LGPL-2.1-or-later */
+/*
+ * Copyright (C) 2021 Steven Stallion <sstallion@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mcp23016-private.h"
+
+#include <assert.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <time.h>
+#include <gpiod.h>
+
+struct mcp23016_interrupt *mcp23016_interrupt_open_config(const char *path, unsigned int offset,
+		const struct mcp23016_interrupt_config *config)
+{
+	struct mcp23016_interrupt *intr;
+	int res, errsv;
+
+	assert(path != NULL);
+	assert(config != NULL);
+
+	/* libgpiod v1 does not support debouncing or selecting the event
+	 * clock; the event buffer size is fixed by the kernel.
+	 */
+	if (config->debounce_period != 0 || config->event_clock != MCP23016_CLOCK_MONOTONIC) {
+		errno = ENOTSUP;
+		return NULL;
+	}
+
+	intr = calloc(1, sizeof(*intr));
+	if (intr == NULL)
+		return NULL;
+
+	intr->flags = config->flags;
+
+	intr->gpio_chip = gpiod_chip_open(path);
+	if (intr->gpio_chip == NULL)
+		goto err;
+
+	intr->gpio_line = gpiod_chip_get_line(intr->gpio_chip, offset);
+	if (intr->gpio_line == NULL)
+		goto err;
+
+	/* The interrupt output is active-low; edge events are requested on
+	 * the rising edge of the logical value, which corresponds to the
+	 * falling edge of the interrupt output.
+	 */
+	if (intr->flags & MCP23016_INTERRUPT_EVENTS)
+		res = gpiod_line_request_rising_edge_events_flags(intr->gpio_line, CONSUMER,
+				GPIOD_LINE_REQUEST_FLAG_ACTIVE_LOW);
+	else
+		res = gpiod_line_request_input_flags(intr->gpio_line, CONSUMER,
+				GPIOD_LINE_REQUEST_FLAG_ACTIVE_LOW);
+	if (res < 0)
+		goto err;
+
+	return intr;
+err:
+	errsv = errno;
+
+	if (intr->gpio_line != NULL)
+		gpiod_line_release(intr->gpio_line);
+
+	if (intr->gpio_chip != NULL)
+		gpiod_chip_close(intr->gpio_chip);
+
+	free(intr);
+
+	errno = errsv;
+	return NULL;
+}
+
+void mcp23016_interrupt_close(struct mcp23016_interrupt *intr)
+{
+	assert(intr != NULL);
+
+	gpiod_line_release(intr->gpio_line);
+	gpiod_chip_close(intr->gpio_chip);
+
+	free(intr);
+}
+
+int mcp23016_has_interrupt(struct mcp23016_interrupt *intr)
+{
+	return gpiod_line_get_value(intr->gpio_line);
+}
+
+int mcp23016_interrupt_wait(struct mcp23016_interrupt *intr, const struct timespec *timeout)
+{
+	struct gpiod_line_event event;
+	int res;
+
+	assert(intr != NULL);
+
+	if (!(intr->flags & MCP23016_INTERRUPT_EVENTS)) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	res = gpiod_line_event_wait(intr->gpio_line, timeout);
+	if (res <= 0)
+		return res;
+
+	res = gpiod_line_event_read(intr->gpio_line, &event);
+	if (res < 0)
+		return res;
+
+	return 1;
+}
+
+int mcp23016_interrupt_get_fd(struct mcp23016_interrupt *intr)
+{
+	assert(intr != NULL);
+
+	if (!(intr->flags & MCP23016_INTERRUPT_EVENTS)) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	return gpiod_line_event_get_fd(intr->gpio_line);
+}
+
+int mcp23016_interrupt_read_events(struct mcp23016_interrupt *intr)
+{
+	static const struct timespec timeout = {0};
+	struct gpiod_line_event events[EVENT_CHUNK];
+	int res, count = 0;
+
+	assert(intr != NULL);
+
+	if (!(intr->flags & MCP23016_INTERRUPT_EVENTS)) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	/* Reading edge events blocks if none are pending; poll the line
+	 * before each read to drain pending events without blocking.
+	 */
+	for (;;) {
+		res = gpiod_line_event_wait(intr->gpio_line, &timeout);
+		if (res < 0)
+			return res;
+		if (res == 0)
+			break;
+
+		res = gpiod_line_event_read_multiple(intr->gpio_line, events, ARRAY_SIZE(events));
+		if (res < 0)
+			return res;
+
+		count += res;
+	}
+	return count;
+}
@@ -0,0 +1,236 @@
+/* SPDX-License-Identifier: LGPL-2.1-or-later */
+/*
+ * Copyright (C) 2021 Steven Stallion <sstallion@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mcp23016-private.h"
+
+#include <assert.h>
+#include <errno.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <time.h>
+#include <gpiod.h>
+
+static const enum gpiod_line_clock event_clocks[] = {
+	[MCP23016_CLOCK_MONOTONIC] = GPIOD_LINE_CLOCK_MONOTONIC,
+	[MCP23016_CLOCK_REALTIME] = GPIOD_LINE_CLOCK_REALTIME,
+	[MCP23016_CLOCK_HTE] = GPIOD_LINE_CLOCK_HTE
+};
+
+struct mcp23016_interrupt *mcp23016_interrupt_open_config(const char *path, unsigned int offset,
+		const struct mcp23016_interrupt_config *config)
+{
+	struct mcp23016_interrupt *intr;
+	struct gpiod_chip *chip = NULL;
+	struct gpiod_line_settings *settings = NULL;
+	struct gpiod_line_config *line_cfg = NULL;
+	struct gpiod_request_config *req_cfg = NULL;
+	size_t event_buffer_size;
+	int errsv;
+
+	assert(path != NULL);
+	assert(config != NULL);
+
+	if (config->event_clock >= ARRAY_SIZE(event_clocks)) {
+		errno = EINVAL;
+		return NULL;
+	}
+
+	intr = calloc(1, sizeof(*intr));
+	if (intr == NULL)
+		return NULL;
+
+	intr->flags = config->flags;
+	intr->offset = offset;
+
+	event_buffer_size = config->event_buffer_size;
+	if (event_buffer_size == 0)
+		event_buffer_size = EVENT_CHUNK;
+
+	chip = gpiod_chip_open(path);
+	if (chip == NULL)
+		goto err;
+
+	settings = gpiod_line_settings_new();
+	if (settings == NULL)
+		goto err;
+
+	/* The interrupt output is active-low; edge events are requested on
+	 * the rising edge of the logical value, which corresponds to the
+	 * falling edge of the interrupt output.
+	 */
+	if (gpiod_line_settings_set_direction(settings, GPIOD_LINE_DIRECTION_INPUT) < 0)
+		goto err;
+
+	gpiod_line_settings_set_active_low(settings, true);
+
+	if (intr->flags & MCP23016_INTERRUPT_EVENTS) {
+		if (gpiod_line_settings_set_edge_detection(settings, GPIOD_LINE_EDGE_RISING) < 0)
+			goto err;
+
+		if (gpiod_line_settings_set_event_clock(settings,
+				event_clocks[config->event_clock]) < 0)
+			goto err;
+	}
+
+	gpiod_line_settings_set_debounce_period_us(settings, config->debounce_period);
+
+	line_cfg = gpiod_line_config_new();
+	if (line_cfg == NULL)
+		goto err;
+
+	if (gpiod_line_config_add_line_settings(line_cfg, &offset, 1, settings) < 0)
+		goto err;
+
+	req_cfg = gpiod_request_config_new();
+	if (req_cfg == NULL)
+		goto err;
+
+	gpiod_request_config_set_consumer(req_cfg, CONSUMER);
+	gpiod_request_config_set_event_buffer_size(req_cfg, event_buffer_size);
+
+	intr->gpio_request = gpiod_chip_request_lines(chip, req_cfg, line_cfg);
+	if (intr->gpio_request == NULL)
+		goto err;
+
+	/* Edge events are read into a buffer that is allocated once to
+	 * avoid allocating memory when servicing interrupts.
+	 */
+	if (intr->flags & MCP23016_INTERRUPT_EVENTS) {
+		intr->gpio_events = gpiod_edge_event_buffer_new(event_buffer_size);
+		if (intr->gpio_events == NULL)
+			goto err;
+	}
+
+	/* Line requests remain valid once the chip is closed. */
+	gpiod_request_config_free(req_cfg);
+	gpiod_line_config_free(line_cfg);
+	gpiod_line_settings_free(settings);
+	gpiod_chip_close(chip);
+	return intr;
+err:
+	errsv = errno;
+
+	if (intr->gpio_request != NULL)
+		gpiod_line_request_release(intr->gpio_request);
+
+	if (req_cfg != NULL)
+		gpiod_request_config_free(req_cfg);
+
+	if (line_cfg != NULL)
+		gpiod_line_config_free(line_cfg);
+
+	if (settings != NULL)
+		gpiod_line_settings_free(settings);
+
+	if (chip != NULL)
+		gpiod_chip_close(chip);
+
+	free(intr);
+
+	errno = errsv;
+	return NULL;
+}
+
+void mcp23016_interrupt_close(struct mcp23016_interrupt *intr)
+{
+	assert(intr != NULL);
+
+	if (intr->gpio_events != NULL)
+		gpiod_edge_event_buffer_free(intr->gpio_events);
+
+	gpiod_line_request_release(intr->gpio_request);
+
+	free(intr);
+}
+
+int mcp23016_has_interrupt(struct mcp23016_interrupt *intr)
+{
+	return gpiod_line_request_get_value(intr->gpio_request, intr->offset);
+}
+
+int mcp23016_interrupt_wait(struct mcp23016_interrupt *intr, const struct timespec *timeout)
+{
+	int64_t timeout_ns = -1;
+	int res;
+
+	assert(intr != NULL);
+
+	if (!(intr->flags & MCP23016_INTERRUPT_EVENTS)) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	if (timeout != NULL)
+		timeout_ns = (int64_t)timeout->tv_sec * 1000000000 + timeout->tv_nsec;
+
+	res = gpiod_line_request_wait_edge_events(intr->gpio_request, timeout_ns);
+	if (res <= 0)
+		return res;
+
+	res = gpiod_line_request_read_edge_events(intr->gpio_request, intr->gpio_events, 1);
+	if (res < 0)
+		return res;
+
+	return 1;
+}
+
+int mcp23016_interrupt_get_fd(struct mcp23016_interrupt *intr)
+{
+	assert(intr != NULL);
+
+	if (!(intr->flags & MCP23016_INTERRUPT_EVENTS)) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	return gpiod_line_request_get_fd(intr->gpio_request);
+}
+
+int mcp23016_interrupt_read_events(struct mcp23016_interrupt *intr)
+{
+	size_t capacity;
+	int res, count = 0;
+
+	assert(intr != NULL);
+
+	if (!(intr->flags & MCP23016_INTERRUPT_EVENTS)) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	/* Reading edge events blocks if none are pending; poll the request
+	 * before each read to drain pending events without blocking. Each
+	 * read consumes up to a full buffer of events.
+	 */
+	capacity = gpiod_edge_event_buffer_get_capacity(intr->gpio_events);
+	for (;;) {
+		res = gpiod_line_request_wait_edge_events(intr->gpio_request, 0);
+		if (res < 0)
+			return res;
+		if (res == 0)
+			break;
+
+		res = gpiod_line_request_read_edge_events(intr->gpio_request, intr->gpio_events,
+				capacity);
+		if (res < 0)
+			return res;
+
+		count += res;
+	}
+	return count;
+}
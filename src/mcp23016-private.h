@@ -25,10 +25,20 @@
 
 #include <mcp23016.h>
 
+#include <pthread.h>
+#include <semaphore.h>
+#include <stdalign.h>
+#include <stdatomic.h>
 #include <stdint.h>
+#include <time.h>
+#include <linux/i2c.h>
 #include <gpiod.h>
 #include <i2cd.h>
 
+#define ARRAY_SIZE(x)	(sizeof(x) / sizeof((x)[0]))
+
+#define BIT(x)		(1U << (x))
+
 #define LOW(x)		(((x) >> 0) & 0xff)
 #define HIGH(x)		(((x) >> 8) & 0xff)
 
@@ -43,6 +53,8 @@ extern const char *__progname;
 #define BASE_ADDR	0x20
 #define END_ADDR	0x27
 
+_Static_assert(END_ADDR - BASE_ADDR + 1 == MCP23016_DEVICE_MAX, "invalid device address range");
+
 /* Register Addresses */
 #define REG_GP0		0x00	/* General Purpose I/O Port Register 0 */
 #define REG_GP1		0x01	/* General Purpose I/O Port Register 1 */
@@ -57,17 +69,323 @@ extern const char *__progname;
 #define REG_IOCON0	0x0a	/* I/O Expander Control Register 0 */
 #define REG_IOCON1	0x0b	/* I/O Expander Control Register 1 */
 
+/* Maximum number of values written per message by mcp23016_set_port_stream() */
+#define STREAM_CHUNK	256
+
+/* Maximum number of edge events read at once by mcp23016_interrupt_read_events() */
+#define EVENT_CHUNK	16
+
+/* Maximum number of times devices are read by mcp23016_group_service() */
+#define GROUP_PASS_MAX	16
+
+/* Number of bit planes in debounce counters */
+#define DEBOUNCE_PLANES	8
+
+_Static_assert(MCP23016_DEBOUNCE_MAX == (1 << DEBOUNCE_PLANES) - 1, "invalid debounce window range");
+
+/* Maximum number of registers written per batch by the bus owner thread */
+#define OWNER_BATCH	32
+
+/* Bytes transferred per device sampled by the poller: two address bytes,
+ * a register address, and a 16-bit value.
+ */
+#define POLLER_SAMPLE_BYTES 5
+
+/* Size of the locked stack of the sampler thread */
+#define SAMPLER_STACK	(64 * 1024)
+
+/* Capture File Format */
+#define CAPTURE_MAGIC	"MCP23016"
+#define CAPTURE_VERSION	1
+
+/* Assumed cache line size used to separate data shared between threads */
+#define CACHE_LINE	64
+
+/* Register Cache */
+#define CACHE_INDEX(reg) ((reg) >> 1)
+#define CACHE_SIZE	(CACHE_INDEX(REG_IOCON1) + 1)
+
+/* Cache validity is tracked per register to support 8-bit access. */
+#define CACHE_VALID(reg) (BIT(reg) | BIT((reg) ^ 1))
+
+/* GP and INTCAP reflect input state and are never cached. */
+#define CACHE_REGS	(CACHE_VALID(REG_OLAT0) | \
+			 CACHE_VALID(REG_IPOL0) | \
+			 CACHE_VALID(REG_IODIR0) | \
+			 CACHE_VALID(REG_IOCON0))
+
+struct mcp23016_bus {
+	struct i2cd *i2c_dev;		/**< Pointer to an I2C character device handle. */
+	atomic_uint refcnt;		/**< Reference count. */
+};
+
 struct mcp23016_device {
 	uint16_t i2c_addr;		/**< I2C slave address. */
 	struct i2cd *i2c_dev;		/**< Pointer to an I2C character device handle. */
+	struct mcp23016_bus *bus;	/**< Pointer to a shared bus handle, or NULL. */
+	int cache_enabled;		/**< Serve register reads from cache. */
+	unsigned int cache_valid;	/**< Bitmask of valid cached registers. */
+	uint16_t cache[CACHE_SIZE];	/**< Shadow copies of cacheable registers. */
 };
 
+#ifdef HAVE_GPIOD_V2
 struct mcp23016_interrupt {
+	int flags;			/**< Interrupt flags. */
+	unsigned int offset;		/**< GPIO line offset. */
+	struct gpiod_line_request *gpio_request; /**< Pointer to a GPIO line request object. */
+	struct gpiod_edge_event_buffer *gpio_events; /**< Pointer to a GPIO edge event buffer, or NULL. */
+};
+#else
+struct mcp23016_interrupt {
+	int flags;			/**< Interrupt flags. */
 	struct gpiod_chip *gpio_chip;	/**< Pointer to a GPIO chip object. */
 	struct gpiod_line *gpio_line;	/**< Pointer to a GPIO line object. */
 };
+#endif
+
+static inline uint64_t monotonic_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static inline int register_addr(enum mcp23016_register reg)
+{
+	static const uint8_t addrs[] = {
+		[MCP23016_REGISTER_PORT] = REG_GP0,
+		[MCP23016_REGISTER_OUTPUT] = REG_OLAT0,
+		[MCP23016_REGISTER_POLARITY] = REG_IPOL0,
+		[MCP23016_REGISTER_DIRECTION] = REG_IODIR0,
+		[MCP23016_REGISTER_INTERRUPT] = REG_INTCAP0,
+		[MCP23016_REGISTER_CONTROL] = REG_IOCON0
+	};
+
+	if ((unsigned int)reg >= ARRAY_SIZE(addrs))
+		return -1;
+
+	return addrs[reg];
+}
+
+static inline struct i2c_msg *i2c_msg_write(struct i2c_msg *msg, uint16_t addr,
+		const void *buf, uint16_t len)
+{
+	msg->addr = addr;
+	msg->flags = 0;
+	msg->len = len;
+	msg->buf = (uint8_t *)buf;
+	return msg + 1;
+}
+
+static inline struct i2c_msg *i2c_msg_read(struct i2c_msg *msg, uint16_t addr,
+		void *buf, uint16_t len)
+{
+	msg->addr = addr;
+	msg->flags = I2C_M_RD;
+	msg->len = len;
+	msg->buf = buf;
+	return msg + 1;
+}
+
+struct mcp23016_dispatcher {
+	struct mcp23016_device *dev;	/**< Pointer to a MCP23016 device handle. */
+	struct mcp23016_interrupt *intr; /**< Pointer to a MCP23016 interrupt handle, or NULL. */
+	struct mcp23016_ring *ring;	/**< Pointer to a MCP23016 event ring, or NULL. */
+	struct mcp23016_snapshot *snap;	/**< Pointer to a MCP23016 input snapshot, or NULL. */
+	struct mcp23016_interrupt_state state; /**< Interrupt state. */
+	uint16_t rising_pins;		/**< Mask of pins with rising edge handlers. */
+	uint16_t falling_pins;		/**< Mask of pins with falling edge handlers. */
+	struct {
+		mcp23016_pin_handler fn;
+		void *arg;
+	} pin_handlers[16];		/**< Pin handlers indexed by pin. */
+	struct {
+		uint16_t rising;
+		uint16_t falling;
+		mcp23016_mask_handler fn;
+		void *arg;
+	} mask_handlers[MCP23016_MASK_HANDLER_MAX]; /**< Mask handlers. */
+	size_t num_mask_handlers;	/**< Number of mask handlers. */
+	uint64_t coalesce_window;	/**< Coalescing window in nanoseconds. */
+	unsigned int coalesce_max;	/**< Maximum number of edge events per window. */
+	struct mcp23016_dispatcher_stats stats; /**< Statistics. */
+};
+
+struct mcp23016_group {
+	struct mcp23016_interrupt *intr; /**< Pointer to a MCP23016 interrupt handle. */
+	struct mcp23016_device *devs[MCP23016_DEVICE_MAX]; /**< Pointers to MCP23016 device handles. */
+	struct mcp23016_ring *ring;	/**< Pointer to a MCP23016 event ring, or NULL. */
+	uint16_t last[MCP23016_DEVICE_MAX]; /**< Last known interrupt capture values. */
+	size_t num_devs;		/**< Number of devices. */
+};
+
+struct mcp23016_ring {
+	/* Producer */
+	alignas(CACHE_LINE) atomic_size_t head; /**< Index of the next event to push. */
+	size_t tail_cache;		/**< Last observed consumer index. */
+	atomic_uint_least64_t overflow;	/**< Number of events dropped. */
+
+	/* Consumer */
+	alignas(CACHE_LINE) atomic_size_t tail; /**< Index of the next event to pop. */
+	size_t head_cache;		/**< Last observed producer index. */
+
+	alignas(CACHE_LINE) size_t mask; /**< Capacity minus one. */
+	alignas(CACHE_LINE) struct mcp23016_event events[]; /**< Event storage. */
+};
+
+struct mcp23016_debounce {
+	uint16_t state;			/**< Debounced pin state. */
+	uint16_t raw;			/**< Last input value. */
+	uint16_t count[DEBOUNCE_PLANES]; /**< Vertical counters of elapsed periods. */
+	uint16_t window[DEBOUNCE_PLANES]; /**< Vertical thresholds in periods. */
+	uint64_t period;		/**< Period in nanoseconds. */
+	uint64_t last;			/**< Time of the last period boundary. */
+};
+
+struct mcp23016_queue {
+	struct mcp23016_bus *bus;	/**< Pointer to a shared bus handle. */
+	pthread_t thread;		/**< Worker thread. */
+	pthread_mutex_t lock;		/**< Protects request lists. */
+	pthread_cond_t cond;		/**< Signaled when requests are submitted. */
+	struct mcp23016_request *pending; /**< Requests waiting to be performed. */
+	struct mcp23016_request **pending_tail; /**< Link to the last pending request. */
+	struct mcp23016_request *done;	/**< Completed requests waiting to be reaped. */
+	struct mcp23016_request **done_tail; /**< Link to the last completed request. */
+	int efd;			/**< Completion eventfd. */
+	int stopping;			/**< Worker thread should exit once idle. */
+};
+
+struct owner_command {
+	atomic_size_t seq;		/**< Sequence number. */
+	struct mcp23016_device *dev;	/**< Pointer to a MCP23016 device handle. */
+	uint8_t reg;			/**< Register address. */
+	uint16_t set;			/**< Mask of bits to set. */
+	uint16_t clear;			/**< Mask of bits to clear. */
+};
+
+struct mcp23016_owner {
+	struct mcp23016_bus *bus;	/**< Pointer to a shared bus handle. */
+	pthread_t thread;		/**< Bus owner thread. */
+	sem_t wakeup;			/**< Posted when commands are enqueued. */
+	atomic_int stopping;		/**< Bus owner thread should exit once idle. */
+	atomic_uint_least64_t commands;	/**< Number of commands performed. */
+	atomic_uint_least64_t writes;	/**< Number of register writes. */
+	atomic_uint_least64_t errors;	/**< Number of failed register accesses. */
+
+	/* Producers */
+	alignas(CACHE_LINE) atomic_size_t enqueue_pos; /**< Index of the next command to enqueue. */
+
+	/* Consumer */
+	alignas(CACHE_LINE) size_t dequeue_pos; /**< Index of the next command to dequeue. */
+
+	alignas(CACHE_LINE) size_t mask; /**< Capacity minus one. */
+	alignas(CACHE_LINE) struct owner_command cmds[]; /**< Command storage. */
+};
+
+struct mcp23016_snapshot {
+	alignas(CACHE_LINE) atomic_uint_least64_t seq; /**< Sequence count; odd while publishing. */
+	atomic_uint_least64_t timestamp; /**< Time of the last publish. */
+	atomic_uint_least16_t port;	/**< Last port value. */
+	atomic_uint_least16_t intcap;	/**< Last interrupt capture value. */
+};
+
+struct mcp23016_poller {
+	struct mcp23016_bus *bus;	/**< Pointer to a shared bus handle. */
+	struct mcp23016_device *devs[MCP23016_DEVICE_MAX]; /**< Pointers to MCP23016 device handles. */
+	struct mcp23016_snapshot *snaps[MCP23016_DEVICE_MAX]; /**< Pointers to MCP23016 input snapshots, or NULL. */
+	uint16_t last[MCP23016_DEVICE_MAX]; /**< Last sampled port values. */
+	size_t num_devs;		/**< Number of devices. */
+	mcp23016_poller_handler fn;	/**< Pointer to a handler function, or NULL. */
+	void *arg;			/**< Pointer to user data passed to fn. */
+	struct mcp23016_poller_config config; /**< Poller configuration. */
+	uint64_t min_period;		/**< Minimum sampling period including bandwidth limit. */
+	int sampled;			/**< Initial port values have been sampled. */
+	int started;			/**< Poller thread is running. */
+	pthread_t thread;		/**< Poller thread. */
+	int tfd;			/**< Sampling timerfd. */
+	uint64_t deadline;		/**< Next sampling deadline in nanoseconds. */
+	int efd;			/**< Stop eventfd. */
+	atomic_uint_least64_t samples;	/**< Number of samples taken. */
+	atomic_uint_least64_t changes;	/**< Number of samples with changes. */
+	atomic_uint_least64_t errors;	/**< Number of failed samples. */
+	atomic_uint_least64_t period;	/**< Current sampling period in nanoseconds. */
+};
+
+struct capture_header {
+	char magic[8];			/**< File magic; see CAPTURE_MAGIC. */
+	uint32_t version;		/**< File format version. */
+	uint32_t header_size;		/**< Offset of the first record. */
+	uint32_t record_size;		/**< Size of each record. */
+	uint32_t num_devs;		/**< Number of devices. */
+	uint8_t devices[MCP23016_DEVICE_MAX]; /**< Device positions. */
+	uint64_t period;		/**< Sampling period in nanoseconds. */
+	int32_t clock;			/**< Clock used for timestamps. */
+	uint32_t flags;			/**< Capture flags. */
+	uint64_t capacity;		/**< Maximum number of records. */
+
+	alignas(CACHE_LINE) atomic_uint_least64_t head; /**< Number of records started. */
+	atomic_uint_least64_t count;	/**< Number of records appended. */
+};
+
+struct mcp23016_capture {
+	struct capture_header *hdr;	/**< Pointer to the mapped header. */
+	uint8_t *records;		/**< Pointer to the mapped records. */
+	size_t size;			/**< Size of the mapping. */
+	size_t record_size;		/**< Size of each record. */
+	uint64_t capacity;		/**< Maximum number of records. */
+	uint64_t count;			/**< Number of records appended; writer only. */
+	size_t slot;			/**< Index of the next record to write; writer only. */
+	int writable;			/**< Capture file was created. */
+};
+
+struct mcp23016_sampler {
+	struct mcp23016_bus *bus;	/**< Pointer to a shared bus handle. */
+	struct mcp23016_device *devs[MCP23016_DEVICE_MAX]; /**< Pointers to MCP23016 device handles. */
+	uint16_t last[MCP23016_DEVICE_MAX]; /**< Last sampled port values. */
+	size_t num_devs;		/**< Number of devices. */
+	struct mcp23016_ring *ring;	/**< Pointer to a MCP23016 event ring, or NULL. */
+	struct mcp23016_capture *cap;	/**< Pointer to a MCP23016 capture file, or NULL. */
+	struct mcp23016_sampler_config config; /**< Sampler configuration. */
+	int started;			/**< Sampler thread is running. */
+	pthread_t thread;		/**< Sampler thread. */
+	void *stack;			/**< Locked sampler thread stack. */
+	atomic_int stopping;		/**< Sampler thread should exit. */
+	atomic_uint_least64_t samples;	/**< Number of samples taken. */
+	atomic_uint_least64_t overruns;	/**< Number of periods missed. */
+	atomic_uint_least64_t errors;	/**< Number of failed samples. */
+};
+
+struct mcp23016_encoder {
+	uint64_t timestamp;		/**< Timestamp of the last stored sample. */
+	uint64_t last;			/**< Timestamp of the last sample. */
+	uint64_t run;			/**< Number of unchanged samples pending. */
+	uint16_t val;			/**< Last port value. */
+	int stored;			/**< First sample has been stored. */
+};
+
+struct mcp23016_decoder {
+	const uint8_t *pos;		/**< Pointer to the next byte to decode. */
+	const uint8_t *end;		/**< Pointer to the end of the stream. */
+	uint64_t timestamp;		/**< Timestamp of the last sample. */
+	uint64_t run;			/**< Number of unchanged samples pending. */
+	uint64_t step;			/**< Interval between samples of a run. */
+	uint64_t run_end;		/**< Timestamp of the last sample of a run. */
+	uint16_t val;			/**< Last port value. */
+	int started;			/**< First record has been decoded. */
+};
+
+size_t mcp23016_ring_size(const struct mcp23016_ring *ring);
+void mcp23016_ring_record(struct mcp23016_ring *ring, struct mcp23016_device *dev,
+		uint16_t val, uint16_t changed);
+
+int mcp23016_poller_sample(struct mcp23016_poller *poller);
 
 int mcp23016_register_read(struct mcp23016_device *dev, uint8_t reg, uint16_t *val);
 int mcp23016_register_write(struct mcp23016_device *dev, uint8_t reg, uint16_t val);
+int mcp23016_register_read_multi(struct mcp23016_device *const *devs, size_t n, uint8_t reg,
+		uint16_t *vals);
+int mcp23016_register_read8(struct mcp23016_device *dev, uint8_t reg, uint8_t *val);
+int mcp23016_register_write8(struct mcp23016_device *dev, uint8_t reg, uint8_t val);
 
 #endif /* MCP23016_PRIVATE_H */
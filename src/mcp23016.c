@@ -23,9 +23,53 @@
 #include <errno.h>
 #include <stdint.h>
 #include <stdlib.h>
-#include <gpiod.h>
+#include <time.h>
+#include <linux/i2c.h>
 #include <i2cd.h>
 
+struct mcp23016_bus *mcp23016_bus_open(const char *path)
+{
+	struct mcp23016_bus *bus;
+
+	assert(path != NULL);
+
+	bus = calloc(1, sizeof(*bus));
+	if (bus == NULL)
+		return NULL;
+
+	bus->i2c_dev = i2cd_open(path);
+	if (bus->i2c_dev == NULL)
+		goto err;
+
+	atomic_init(&bus->refcnt, 1);
+	return bus;
+err:
+	free(bus);
+	return NULL;
+}
+
+void mcp23016_bus_close(struct mcp23016_bus *bus)
+{
+	assert(bus != NULL);
+
+	if (atomic_fetch_sub(&bus->refcnt, 1) > 1)
+		return;
+
+	i2cd_close(bus->i2c_dev);
+
+	free(bus);
+}
+
+static inline int set_i2c_addr(struct mcp23016_device *dev, unsigned int num)
+{
+	dev->i2c_addr = BASE_ADDR + num;
+	if (dev->i2c_addr < BASE_ADDR || dev->i2c_addr > END_ADDR) {
+		errno = EINVAL;
+		return -1;
+	}
+	return 0;
+}
+
 struct mcp23016_device *mcp23016_open(const char *path, unsigned int num)
 {
 	struct mcp23016_device *dev;
@@ -36,11 +80,8 @@ struct mcp23016_device *mcp23016_open(const char *path, unsigned int num)
 	if (dev == NULL)
 		return NULL;
 
-	dev->i2c_addr = BASE_ADDR + num;
-	if (dev->i2c_addr < BASE_ADDR || dev->i2c_addr > END_ADDR) {
-		errno = EINVAL;
+	if (set_i2c_addr(dev, num) < 0)
 		goto err;
-	}
 
 	dev->i2c_dev = i2cd_open(path);
 	if (dev->i2c_dev == NULL)
@@ -52,76 +93,336 @@ err:
 	return NULL;
 }
 
+struct mcp23016_device *mcp23016_open_on_bus(struct mcp23016_bus *bus, unsigned int num)
+{
+	struct mcp23016_device *dev;
+
+	assert(bus != NULL);
+
+	dev = calloc(1, sizeof(*dev));
+	if (dev == NULL)
+		return NULL;
+
+	if (set_i2c_addr(dev, num) < 0)
+		goto err;
+
+	atomic_fetch_add(&bus->refcnt, 1);
+
+	dev->i2c_dev = bus->i2c_dev;
+	dev->bus = bus;
+
+	return dev;
+err:
+	free(dev);
+	return NULL;
+}
+
 void mcp23016_close(struct mcp23016_device *dev)
 {
 	assert(dev != NULL);
 
-	i2cd_close(dev->i2c_dev);
+	if (dev->bus != NULL)
+		mcp23016_bus_close(dev->bus);
+	else
+		i2cd_close(dev->i2c_dev);
 
 	free(dev);
 }
 
-int mcp23016_reset(struct mcp23016_device *dev)
+static inline int cache_hit(struct mcp23016_device *dev, unsigned int mask)
+{
+	return dev->cache_enabled && (dev->cache_valid & mask) == mask;
+}
+
+static inline void cache_update(struct mcp23016_device *dev, uint8_t reg, uint16_t val)
+{
+	if (CACHE_REGS & BIT(reg)) {
+		dev->cache[CACHE_INDEX(reg)] = val;
+		dev->cache_valid |= CACHE_VALID(reg);
+	}
+}
+
+static inline void cache_update8(struct mcp23016_device *dev, uint8_t reg, uint8_t val)
+{
+	unsigned int shift = (reg & 1) * 8;
+
+	if (CACHE_REGS & BIT(reg)) {
+		dev->cache[CACHE_INDEX(reg)] &= ~(0xff << shift);
+		dev->cache[CACHE_INDEX(reg)] |= val << shift;
+		dev->cache_valid |= BIT(reg);
+	}
+}
+
+static inline void encode_register(uint8_t *buf, uint8_t reg, uint16_t val)
+{
+	buf[0] = reg;
+	buf[1] = LOW(val);
+	buf[2] = HIGH(val);
+}
+
+int mcp23016_register_read(struct mcp23016_device *dev, uint8_t reg, uint16_t *val)
 {
 	int res;
 
 	assert(dev != NULL);
+	assert(val != NULL);
 
-	/* The MCP23016 does not provide a hardware reset. The following
-	 * sequence resets registers to POR defaults and clears pending
-	 * interrupts.
+	if (cache_hit(dev, CACHE_VALID(reg))) {
+		*val = dev->cache[CACHE_INDEX(reg)];
+		return 0;
+	}
+
+	/* 16-bit registers are accessed by reading an additional byte.
+	 * Values are encoded in little-endian byte order.
 	 */
-	res = mcp23016_set_direction(dev, 0xffff);
+	res = i2cd_register_read(dev->i2c_dev, dev->i2c_addr, reg, val, sizeof(*val));
 	if (res < 0)
 		return res;
 
-	res = mcp23016_set_output(dev, 0x0000);
-	if (res < 0)
-		return res;
+	*val = le16toh(*val);
+	cache_update(dev, reg, *val);
+	return 0;
+}
+
+int mcp23016_register_write(struct mcp23016_device *dev, uint8_t reg, uint16_t val)
+{
+	const uint8_t buf[] = {reg, LOW(val), HIGH(val)};
+	int res;
 
-	res = mcp23016_set_polarity(dev, 0x0000);
+	assert(dev != NULL);
+
+	/* 16-bit registers are accessed by writing an additional byte.
+	 * Values are encoded in little-endian byte order.
+	 */
+	res = i2cd_write(dev->i2c_dev, dev->i2c_addr, buf, sizeof(buf));
 	if (res < 0)
 		return res;
 
-	res = mcp23016_set_control(dev, 0x0000);
+	/* Writing the GP registers also modifies the output latches. */
+	cache_update(dev, reg == REG_GP0 ? REG_OLAT0 : reg, val);
+	return 0;
+}
+
+int mcp23016_register_read_multi(struct mcp23016_device *const *devs, size_t n, uint8_t reg,
+		uint16_t *vals)
+{
+	struct i2c_msg msgs[MCP23016_DEVICE_MAX * 2], *msg = msgs;
+	size_t i;
+	int res;
+
+	assert(devs != NULL);
+	assert(n > 0 && n <= MCP23016_DEVICE_MAX);
+	assert(vals != NULL);
+
+	/* Each device contributes a register address write followed by a
+	 * 16-bit read; all devices are read using a single combined
+	 * transfer. Devices must share the same I2C bus.
+	 */
+	for (i = 0; i < n; i++) {
+		msg = i2c_msg_write(msg, devs[i]->i2c_addr, &reg, sizeof(reg));
+		msg = i2c_msg_read(msg, devs[i]->i2c_addr, &vals[i], sizeof(vals[i]));
+	}
+
+	res = i2cd_transfer(devs[0]->i2c_dev, msgs, msg - msgs);
 	if (res < 0)
 		return res;
 
-	return mcp23016_clear_interrupt(dev);
+	for (i = 0; i < n; i++)
+		vals[i] = le16toh(vals[i]);
+	return 0;
 }
 
-int mcp23016_register_read(struct mcp23016_device *dev, uint8_t reg, uint16_t *val)
+int mcp23016_register_read8(struct mcp23016_device *dev, uint8_t reg, uint8_t *val)
 {
 	int res;
 
 	assert(dev != NULL);
 	assert(val != NULL);
 
-	/* 16-bit registers are accessed by reading an additional byte.
-	 * Values are encoded in little-endian byte order.
+	if (cache_hit(dev, BIT(reg))) {
+		*val = dev->cache[CACHE_INDEX(reg)] >> ((reg & 1) * 8);
+		return 0;
+	}
+
+	/* 8-bit registers are accessed by reading a single byte, which
+	 * addresses either half of a 16-bit register.
 	 */
 	res = i2cd_register_read(dev->i2c_dev, dev->i2c_addr, reg, val, sizeof(*val));
 	if (res < 0)
 		return res;
 
-	*val = le16toh(*val);
+	cache_update8(dev, reg, *val);
 	return 0;
 }
 
-int mcp23016_register_write(struct mcp23016_device *dev, uint8_t reg, uint16_t val)
+int mcp23016_register_write8(struct mcp23016_device *dev, uint8_t reg, uint8_t val)
 {
-	const uint8_t buf[] = {reg, LOW(val), HIGH(val)};
+	const uint8_t buf[] = {reg, val};
 	int res;
 
 	assert(dev != NULL);
 
-	/* 16-bit registers are accessed by writing an additional byte.
-	 * Values are encoded in little-endian byte order.
+	/* 8-bit registers are accessed by writing a single byte, which
+	 * addresses either half of a 16-bit register.
 	 */
 	res = i2cd_write(dev->i2c_dev, dev->i2c_addr, buf, sizeof(buf));
 	if (res < 0)
 		return res;
 
+	/* Writing the GP registers also modifies the output latches. */
+	cache_update8(dev, reg <= REG_GP1 ? reg + REG_OLAT0 : reg, val);
+	return 0;
+}
+
+void mcp23016_enable_cache(struct mcp23016_device *dev)
+{
+	assert(dev != NULL);
+
+	dev->cache_enabled = 1;
+}
+
+void mcp23016_disable_cache(struct mcp23016_device *dev)
+{
+	assert(dev != NULL);
+
+	dev->cache_enabled = 0;
+}
+
+void mcp23016_invalidate_cache(struct mcp23016_device *dev)
+{
+	assert(dev != NULL);
+
+	dev->cache_valid = 0;
+}
+
+int mcp23016_refresh_cache(struct mcp23016_device *dev)
+{
+	static const uint8_t regs[] = {REG_OLAT0, REG_IPOL0, REG_IODIR0, REG_IOCON0};
+	uint16_t val;
+	size_t i;
+	int res;
+
+	assert(dev != NULL);
+
+	/* Invalidate the cache first so that each read below is issued to
+	 * the device, which in turn repopulates the cache.
+	 */
+	dev->cache_valid = 0;
+
+	for (i = 0; i < ARRAY_SIZE(regs); i++) {
+		res = mcp23016_register_read(dev, regs[i], &val);
+		if (res < 0)
+			return res;
+	}
+	return 0;
+}
+
+static int write_config(struct mcp23016_device *dev, const struct mcp23016_config *config,
+		int direction_first)
+{
+	static const uint8_t reg = REG_INTCAP0;
+	uint8_t bufs[4][3];
+	uint16_t val;
+	struct i2c_msg msgs[6], *msg = msgs;
+	int res;
+
+	/* Registers are written using a single combined transfer followed by
+	 * a read of the interrupt capture registers to clear interrupts
+	 * caused by the new configuration. The output latches are written
+	 * before the I/O direction to avoid driving stale values, unless
+	 * the I/O direction is written first to stop driving outputs.
+	 */
+	encode_register(bufs[0], REG_IOCON0, config->control);
+	encode_register(bufs[1], REG_IPOL0, config->polarity);
+	if (direction_first) {
+		encode_register(bufs[2], REG_IODIR0, config->direction);
+		encode_register(bufs[3], REG_OLAT0, config->output);
+	} else {
+		encode_register(bufs[2], REG_OLAT0, config->output);
+		encode_register(bufs[3], REG_IODIR0, config->direction);
+	}
+
+	msg = i2c_msg_write(msg, dev->i2c_addr, bufs[0], sizeof(bufs[0]));
+	msg = i2c_msg_write(msg, dev->i2c_addr, bufs[1], sizeof(bufs[1]));
+	msg = i2c_msg_write(msg, dev->i2c_addr, bufs[2], sizeof(bufs[2]));
+	msg = i2c_msg_write(msg, dev->i2c_addr, bufs[3], sizeof(bufs[3]));
+	msg = i2c_msg_write(msg, dev->i2c_addr, &reg, sizeof(reg));
+	msg = i2c_msg_read(msg, dev->i2c_addr, &val, sizeof(val));
+
+	res = i2cd_transfer(dev->i2c_dev, msgs, msg - msgs);
+	if (res < 0)
+		return res;
+
+	cache_update(dev, REG_IOCON0, config->control);
+	cache_update(dev, REG_IPOL0, config->polarity);
+	cache_update(dev, REG_OLAT0, config->output);
+	cache_update(dev, REG_IODIR0, config->direction);
+	return 0;
+}
+
+int mcp23016_configure(struct mcp23016_device *dev, const struct mcp23016_config *config)
+{
+	assert(dev != NULL);
+	assert(config != NULL);
+
+	return write_config(dev, config, 0);
+}
+
+int mcp23016_reset(struct mcp23016_device *dev)
+{
+	/* The MCP23016 does not provide a hardware reset. Applying the POR
+	 * defaults resets registers and clears pending interrupts. Pins are
+	 * made inputs before the output latches are cleared so that outputs
+	 * driven high are not momentarily driven low.
+	 */
+	static const struct mcp23016_config config = {
+		.output = 0x0000,
+		.polarity = 0x0000,
+		.direction = 0xffff,
+		.control = 0x0000
+	};
+
+	assert(dev != NULL);
+
+	return write_config(dev, &config, 1);
+}
+
+int mcp23016_bus_set_output(struct mcp23016_bus *bus, const struct mcp23016_output *outputs,
+		size_t n)
+{
+	uint8_t bufs[MCP23016_DEVICE_MAX][3];
+	struct i2c_msg msgs[MCP23016_DEVICE_MAX], *msg = msgs;
+	size_t i;
+	int res;
+
+	assert(bus != NULL);
+	assert(outputs != NULL);
+
+	if (n == 0 || n > MCP23016_DEVICE_MAX) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	for (i = 0; i < n; i++) {
+		struct mcp23016_device *dev = outputs[i].dev;
+
+		assert(dev != NULL);
+
+		if (dev->bus != bus) {
+			errno = EINVAL;
+			return -1;
+		}
+
+		encode_register(bufs[i], REG_OLAT0, outputs[i].val);
+		msg = i2c_msg_write(msg, dev->i2c_addr, bufs[i], sizeof(bufs[i]));
+	}
+
+	res = i2cd_transfer(bus->i2c_dev, msgs, msg - msgs);
+	if (res < 0)
+		return res;
+
+	for (i = 0; i < n; i++)
+		cache_update(outputs[i].dev, REG_OLAT0, outputs[i].val);
 	return 0;
 }
 
@@ -135,6 +436,114 @@ int mcp23016_set_port(struct mcp23016_device *dev, uint16_t val)
 	return mcp23016_register_write(dev, REG_GP0, val);
 }
 
+int mcp23016_get_port_burst(struct mcp23016_device *dev, uint16_t *samples, size_t n)
+{
+	size_t i;
+	int res;
+
+	assert(dev != NULL);
+	assert(samples != NULL);
+
+	if (n == 0 || n > MCP23016_BURST_MAX) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	/* Consecutive reads alternate between the registers of a pair,
+	 * which permits sampling the GP registers repeatedly without
+	 * writing the register address for each sample.
+	 */
+	res = i2cd_register_read(dev->i2c_dev, dev->i2c_addr, REG_GP0, samples, n * sizeof(*samples));
+	if (res < 0)
+		return res;
+
+	for (i = 0; i < n; i++)
+		samples[i] = le16toh(samples[i]);
+	return 0;
+}
+
+static inline int port_register(uint8_t reg, enum mcp23016_port port)
+{
+	if (port != MCP23016_PORT_0 && port != MCP23016_PORT_1) {
+		errno = EINVAL;
+		return -1;
+	}
+	return reg + port;
+}
+
+int mcp23016_set_port_stream(struct mcp23016_device *dev, const uint16_t *vals, size_t n,
+		unsigned int count)
+{
+	uint8_t buf[1 + STREAM_CHUNK * sizeof(*vals)];
+	size_t i, len = 1;
+	int res;
+
+	assert(dev != NULL);
+	assert(vals != NULL);
+
+	if (n == 0 || count == 0) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	/* Consecutive writes alternate between the registers of a pair,
+	 * which permits writing the GP registers repeatedly without
+	 * writing the register address for each value. Values are written
+	 * in chunks to bound the size of each message.
+	 */
+	buf[0] = REG_GP0;
+
+	while (count-- > 0) {
+		for (i = 0; i < n; i++) {
+			buf[len++] = LOW(vals[i]);
+			buf[len++] = HIGH(vals[i]);
+
+			if (len == sizeof(buf)) {
+				res = i2cd_write(dev->i2c_dev, dev->i2c_addr, buf, len);
+				if (res < 0)
+					goto err;
+
+				len = 1;
+			}
+		}
+	}
+
+	if (len > 1) {
+		res = i2cd_write(dev->i2c_dev, dev->i2c_addr, buf, len);
+		if (res < 0)
+			goto err;
+	}
+
+	/* Writing the GP registers also modifies the output latches. */
+	cache_update(dev, REG_OLAT0, vals[n - 1]);
+	return 0;
+err:
+	dev->cache_valid &= ~CACHE_VALID(REG_OLAT0);
+	return res;
+}
+
+int mcp23016_get_port8(struct mcp23016_device *dev, enum mcp23016_port port, uint8_t *val)
+{
+	int reg;
+
+	reg = port_register(REG_GP0, port);
+	if (reg < 0)
+		return reg;
+
+	return mcp23016_register_read8(dev, reg, val);
+}
+
+int mcp23016_set_port8(struct mcp23016_device *dev, enum mcp23016_port port, uint8_t val)
+{
+	int reg;
+
+	reg = port_register(REG_GP0, port);
+	if (reg < 0)
+		return reg;
+
+	return mcp23016_register_write8(dev, reg, val);
+}
+
 int mcp23016_get_output(struct mcp23016_device *dev, uint16_t *val)
 {
 	return mcp23016_register_read(dev, REG_OLAT0, val);
@@ -145,6 +554,86 @@ int mcp23016_set_output(struct mcp23016_device *dev, uint16_t val)
 	return mcp23016_register_write(dev, REG_OLAT0, val);
 }
 
+int mcp23016_get_output8(struct mcp23016_device *dev, enum mcp23016_port port, uint8_t *val)
+{
+	int reg;
+
+	reg = port_register(REG_OLAT0, port);
+	if (reg < 0)
+		return reg;
+
+	return mcp23016_register_read8(dev, reg, val);
+}
+
+int mcp23016_set_output8(struct mcp23016_device *dev, enum mcp23016_port port, uint8_t val)
+{
+	int reg;
+
+	reg = port_register(REG_OLAT0, port);
+	if (reg < 0)
+		return reg;
+
+	return mcp23016_register_write8(dev, reg, val);
+}
+
+/* Pin functions operate on the tracked output latch image, which is only read
+ * from the device when not already known. This permits modifying individual
+ * pins using a single write, regardless of whether the cache is enabled.
+ */
+static int output_image(struct mcp23016_device *dev, uint16_t *val)
+{
+	if ((dev->cache_valid & CACHE_VALID(REG_OLAT0)) == CACHE_VALID(REG_OLAT0)) {
+		*val = dev->cache[CACHE_INDEX(REG_OLAT0)];
+		return 0;
+	}
+	return mcp23016_register_read(dev, REG_OLAT0, val);
+}
+
+int mcp23016_write_pins(struct mcp23016_device *dev, uint16_t mask, uint16_t val)
+{
+	uint16_t output;
+	int res;
+
+	assert(dev != NULL);
+
+	res = output_image(dev, &output);
+	if (res < 0)
+		return res;
+
+	output = (output & ~mask) | (val & mask);
+
+	/* Pins confined to a single 8-bit port are written using 8-bit
+	 * access, which saves a byte on the bus.
+	 */
+	if (HIGH(mask) == 0)
+		return mcp23016_register_write8(dev, REG_OLAT0, LOW(output));
+	if (LOW(mask) == 0)
+		return mcp23016_register_write8(dev, REG_OLAT1, HIGH(output));
+
+	return mcp23016_register_write(dev, REG_OLAT0, output);
+}
+
+int mcp23016_toggle_pins(struct mcp23016_device *dev, uint16_t mask)
+{
+	uint16_t output;
+	int res;
+
+	assert(dev != NULL);
+
+	res = output_image(dev, &output);
+	if (res < 0)
+		return res;
+
+	output ^= mask;
+
+	if (HIGH(mask) == 0)
+		return mcp23016_register_write8(dev, REG_OLAT0, LOW(output));
+	if (LOW(mask) == 0)
+		return mcp23016_register_write8(dev, REG_OLAT1, HIGH(output));
+
+	return mcp23016_register_write(dev, REG_OLAT0, output);
+}
+
 int mcp23016_get_polarity(struct mcp23016_device *dev, uint16_t *val)
 {
 	return mcp23016_register_read(dev, REG_IPOL0, val);
@@ -155,81 +644,116 @@ int mcp23016_set_polarity(struct mcp23016_device *dev, uint16_t val)
 	return mcp23016_register_write(dev, REG_IPOL0, val);
 }
 
-int mcp23016_get_direction(struct mcp23016_device *dev, uint16_t *val)
+int mcp23016_get_polarity8(struct mcp23016_device *dev, enum mcp23016_port port, uint8_t *val)
 {
-	return mcp23016_register_read(dev, REG_IODIR0, val);
-}
+	int reg;
 
-int mcp23016_set_direction(struct mcp23016_device *dev, uint16_t val)
-{
-	return mcp23016_register_write(dev, REG_IODIR0, val);
+	reg = port_register(REG_IPOL0, port);
+	if (reg < 0)
+		return reg;
+
+	return mcp23016_register_read8(dev, reg, val);
 }
 
-int mcp23016_get_interrupt(struct mcp23016_device *dev, uint16_t *val)
+int mcp23016_set_polarity8(struct mcp23016_device *dev, enum mcp23016_port port, uint8_t val)
 {
-	return mcp23016_register_read(dev, REG_INTCAP0, val);
+	int reg;
+
+	reg = port_register(REG_IPOL0, port);
+	if (reg < 0)
+		return reg;
+
+	return mcp23016_register_write8(dev, reg, val);
 }
 
-int mcp23016_get_control(struct mcp23016_device *dev, uint16_t *val)
+int mcp23016_get_direction(struct mcp23016_device *dev, uint16_t *val)
 {
-	return mcp23016_register_read(dev, REG_IOCON0, val);
+	return mcp23016_register_read(dev, REG_IODIR0, val);
 }
 
-int mcp23016_set_control(struct mcp23016_device *dev, uint16_t val)
+int mcp23016_set_direction(struct mcp23016_device *dev, uint16_t val)
 {
-	return mcp23016_register_write(dev, REG_IOCON0, val);
+	return mcp23016_register_write(dev, REG_IODIR0, val);
 }
 
-struct mcp23016_interrupt *mcp23016_interrupt_open(const char *path, unsigned int offset)
+int mcp23016_get_direction8(struct mcp23016_device *dev, enum mcp23016_port port, uint8_t *val)
 {
-	struct mcp23016_interrupt *intr;
-	int flags, errsv;
+	int reg;
 
-	assert(path != NULL);
+	reg = port_register(REG_IODIR0, port);
+	if (reg < 0)
+		return reg;
 
-	intr = calloc(1, sizeof(*intr));
-	if (intr == NULL)
-		return NULL;
+	return mcp23016_register_read8(dev, reg, val);
+}
 
-	intr->gpio_chip = gpiod_chip_open(path);
-	if (intr->gpio_chip == NULL)
-		goto err;
+int mcp23016_set_direction8(struct mcp23016_device *dev, enum mcp23016_port port, uint8_t val)
+{
+	int reg;
 
-	intr->gpio_line = gpiod_chip_get_line(intr->gpio_chip, offset);
-	if (intr->gpio_line == NULL)
-		goto err;
+	reg = port_register(REG_IODIR0, port);
+	if (reg < 0)
+		return reg;
 
-	flags = GPIOD_LINE_REQUEST_FLAG_ACTIVE_LOW;
-	if (gpiod_line_request_input_flags(intr->gpio_line, CONSUMER, flags) < 0)
-		goto err;
+	return mcp23016_register_write8(dev, reg, val);
+}
 
-	return intr;
-err:
-	errsv = errno;
+int mcp23016_get_interrupt(struct mcp23016_device *dev, uint16_t *val)
+{
+	return mcp23016_register_read(dev, REG_INTCAP0, val);
+}
 
-	if (intr->gpio_line != NULL)
-		gpiod_line_release(intr->gpio_line);
+int mcp23016_service_interrupt(struct mcp23016_device *dev, struct mcp23016_interrupt_state *state)
+{
+	static const uint8_t regs[] = {REG_INTCAP0, REG_GP0};
+	uint16_t vals[ARRAY_SIZE(regs)];
+	struct i2c_msg msgs[ARRAY_SIZE(regs) * 2], *msg = msgs;
+	size_t i;
+	int res;
 
-	if (intr->gpio_chip != NULL)
-		gpiod_chip_close(intr->gpio_chip);
+	assert(dev != NULL);
+	assert(state != NULL);
+
+	/* The interrupt capture registers only hold the port value at the
+	 * first change; the port registers are read in the same transfer to
+	 * detect changes that occurred after the capture.
+	 */
+	for (i = 0; i < ARRAY_SIZE(regs); i++) {
+		msg = i2c_msg_write(msg, dev->i2c_addr, &regs[i], sizeof(regs[i]));
+		msg = i2c_msg_read(msg, dev->i2c_addr, &vals[i], sizeof(vals[i]));
+	}
 
-	free(intr);
+	res = i2cd_transfer(dev->i2c_dev, msgs, msg - msgs);
+	if (res < 0)
+		return res;
 
-	errno = errsv;
-	return NULL;
+	state->previous = state->current;
+	state->captured = le16toh(vals[0]);
+	state->current = le16toh(vals[1]);
+	state->changed = (state->previous ^ state->captured) | (state->captured ^ state->current);
+	state->missed = (state->previous ^ state->captured) & (state->captured ^ state->current);
+	return 0;
 }
 
-void mcp23016_interrupt_close(struct mcp23016_interrupt *intr)
+int mcp23016_get_control(struct mcp23016_device *dev, uint16_t *val)
 {
-	assert(intr != NULL);
+	return mcp23016_register_read(dev, REG_IOCON0, val);
+}
 
-	gpiod_line_release(intr->gpio_line);
-	gpiod_chip_close(intr->gpio_chip);
+int mcp23016_set_control(struct mcp23016_device *dev, uint16_t val)
+{
+	return mcp23016_register_write(dev, REG_IOCON0, val);
+}
 
-	free(intr);
+struct mcp23016_interrupt *mcp23016_interrupt_open(const char *path, unsigned int offset)
+{
+	return mcp23016_interrupt_open_flags(path, offset, 0);
 }
 
-int mcp23016_has_interrupt(struct mcp23016_interrupt *intr)
+struct mcp23016_interrupt *mcp23016_interrupt_open_flags(const char *path, unsigned int offset,
+		int flags)
 {
-	return gpiod_line_get_value(intr->gpio_line);
+	const struct mcp23016_interrupt_config config = {.flags = flags};
+
+	return mcp23016_interrupt_open_config(path, offset, &config);
 }
@@ -0,0 +1,263 @@
+/* SPDX-License-Identifier: LGPL-2.1-or-later */
+/*
+ * Copyright (C) 2021 Steven Stallion <sstallion@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mcp23016-private.h"
+
+#include <assert.h>
+#include <errno.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+struct owner_batch {
+	struct mcp23016_device *dev;
+	uint8_t reg;
+	uint16_t set;
+	uint16_t clear;
+};
+
+static int owner_dequeue(struct mcp23016_owner *owner, struct owner_batch *cmd)
+{
+	struct owner_command *cell;
+	size_t pos = owner->dequeue_pos;
+
+	cell = &owner->cmds[pos & owner->mask];
+	if (atomic_load_explicit(&cell->seq, memory_order_acquire) != pos + 1)
+		return 0;
+
+	cmd->dev = cell->dev;
+	cmd->reg = cell->reg;
+	cmd->set = cell->set;
+	cmd->clear = cell->clear;
+
+	/* Release the cell to producers one lap ahead. */
+	atomic_store_explicit(&cell->seq, pos + owner->mask + 1, memory_order_release);
+	owner->dequeue_pos = pos + 1;
+	return 1;
+}
+
+static size_t owner_merge(struct owner_batch *batch, size_t n, const struct owner_batch *cmd)
+{
+	struct owner_batch *last;
+
+	/* Only consecutive commands to the same register are merged so that
+	 * writes to different registers are performed in the order they were
+	 * enqueued. A later command takes precedence over bits written by
+	 * earlier commands.
+	 */
+	if (n > 0) {
+		last = &batch[n - 1];
+		if (last->dev == cmd->dev && last->reg == cmd->reg) {
+			last->set = (last->set & ~cmd->clear) | cmd->set;
+			last->clear = (last->clear & ~cmd->set) | cmd->clear;
+			return n;
+		}
+	}
+
+	batch[n] = *cmd;
+	return n + 1;
+}
+
+static void owner_perform(struct mcp23016_owner *owner, const struct owner_batch *cmd)
+{
+	uint16_t val = 0;
+
+	atomic_fetch_add_explicit(&owner->writes, 1, memory_order_relaxed);
+
+	/* Registers are only read if some bits are left unchanged. */
+	if ((uint16_t)(cmd->set | cmd->clear) != 0xffff) {
+		if (mcp23016_register_read(cmd->dev, cmd->reg, &val) < 0)
+			goto err;
+	}
+
+	val = (val & ~cmd->clear) | cmd->set;
+
+	if (mcp23016_register_write(cmd->dev, cmd->reg, val) < 0)
+		goto err;
+
+	return;
+err:
+	atomic_fetch_add_explicit(&owner->errors, 1, memory_order_relaxed);
+}
+
+static void *owner_worker(void *arg)
+{
+	struct mcp23016_owner *owner = arg;
+	struct owner_batch batch[OWNER_BATCH], cmd;
+	size_t i, n, count;
+
+	for (;;) {
+		/* Commands are dequeued until the queue is empty or the
+		 * batch holds the maximum number of registers.
+		 */
+		n = count = 0;
+		while (n < ARRAY_SIZE(batch) && owner_dequeue(owner, &cmd)) {
+			n = owner_merge(batch, n, &cmd);
+			count++;
+		}
+
+		if (count == 0) {
+			if (atomic_load(&owner->stopping))
+				break;
+
+			/* The semaphore may be posted more than once per
+			 * dequeue; extra wakeups find the queue empty.
+			 */
+			while (sem_wait(&owner->wakeup) < 0 && errno == EINTR)
+				;
+			continue;
+		}
+
+		atomic_fetch_add_explicit(&owner->commands, count, memory_order_relaxed);
+		for (i = 0; i < n; i++)
+			owner_perform(owner, &batch[i]);
+	}
+	return NULL;
+}
+
+struct mcp23016_owner *mcp23016_owner_create(struct mcp23016_bus *bus, size_t capacity)
+{
+	struct mcp23016_owner *owner;
+	size_t i, size;
+	int res;
+
+	assert(bus != NULL);
+
+	if (capacity == 0 || (capacity & (capacity - 1)) != 0) {
+		errno = EINVAL;
+		return NULL;
+	}
+
+	/* aligned_alloc() requires the size to be a multiple of the
+	 * alignment.
+	 */
+	size = sizeof(*owner) + capacity * sizeof(owner->cmds[0]);
+	size = (size + CACHE_LINE - 1) & ~(size_t)(CACHE_LINE - 1);
+
+	owner = aligned_alloc(CACHE_LINE, size);
+	if (owner == NULL)
+		return NULL;
+
+	memset(owner, 0, size);
+	owner->bus = bus;
+	atomic_init(&owner->stopping, 0);
+	atomic_init(&owner->commands, 0);
+	atomic_init(&owner->writes, 0);
+	atomic_init(&owner->errors, 0);
+	atomic_init(&owner->enqueue_pos, 0);
+	owner->mask = capacity - 1;
+
+	/* Each cell holds the index at which it may next be enqueued. */
+	for (i = 0; i < capacity; i++)
+		atomic_init(&owner->cmds[i].seq, i);
+
+	if (sem_init(&owner->wakeup, 0, 0) < 0)
+		goto err;
+
+	res = pthread_create(&owner->thread, NULL, owner_worker, owner);
+	if (res != 0) {
+		errno = res;
+		goto err_thread;
+	}
+
+	atomic_fetch_add(&bus->refcnt, 1);
+	return owner;
+err_thread:
+	sem_destroy(&owner->wakeup);
+err:
+	free(owner);
+	return NULL;
+}
+
+void mcp23016_owner_destroy(struct mcp23016_owner *owner)
+{
+	assert(owner != NULL);
+
+	atomic_store(&owner->stopping, 1);
+	sem_post(&owner->wakeup);
+
+	pthread_join(owner->thread, NULL);
+
+	sem_destroy(&owner->wakeup);
+
+	mcp23016_bus_close(owner->bus);
+
+	free(owner);
+}
+
+int mcp23016_owner_write(struct mcp23016_owner *owner, struct mcp23016_device *dev,
+		enum mcp23016_register reg, uint16_t mask, uint16_t val)
+{
+	struct owner_command *cell;
+	size_t pos, seq;
+
+	assert(owner != NULL);
+	assert(dev != NULL);
+
+	if (dev->bus != owner->bus ||
+	    reg == MCP23016_REGISTER_PORT ||
+	    reg == MCP23016_REGISTER_INTERRUPT ||
+	    register_addr(reg) < 0) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	/* Producers claim a cell by advancing the enqueue index once the
+	 * cell sequence number shows it has been released by the consumer.
+	 */
+	pos = atomic_load_explicit(&owner->enqueue_pos, memory_order_relaxed);
+	for (;;) {
+		cell = &owner->cmds[pos & owner->mask];
+		seq = atomic_load_explicit(&cell->seq, memory_order_acquire);
+		if (seq == pos) {
+			if (atomic_compare_exchange_weak_explicit(&owner->enqueue_pos, &pos, pos + 1,
+					memory_order_relaxed, memory_order_relaxed))
+				break;
+		} else if ((ptrdiff_t)(seq - pos) < 0) {
+			errno = EAGAIN;
+			return -1;
+		} else {
+			pos = atomic_load_explicit(&owner->enqueue_pos, memory_order_relaxed);
+		}
+	}
+
+	cell->dev = dev;
+	cell->reg = register_addr(reg);
+	cell->set = mask & val;
+	cell->clear = mask & ~val;
+
+	/* Publish the command to the consumer. */
+	atomic_store_explicit(&cell->seq, pos + 1, memory_order_release);
+
+	sem_post(&owner->wakeup);
+	return 0;
+}
+
+void mcp23016_owner_get_stats(struct mcp23016_owner *owner, struct mcp23016_owner_stats *stats)
+{
+	assert(owner != NULL);
+	assert(stats != NULL);
+
+	stats->commands = atomic_load_explicit(&owner->commands, memory_order_relaxed);
+	stats->writes = atomic_load_explicit(&owner->writes, memory_order_relaxed);
+	stats->errors = atomic_load_explicit(&owner->errors, memory_order_relaxed);
+}
@@ -0,0 +1,294 @@
+/* SPDX-License-Identifier: LGPL-2.1-or-later */
+/*
+ * Copyright (C) 2021 Steven Stallion <sstallion@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mcp23016-private.h"
+
+#include <assert.h>
+#include <errno.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+
+static uint64_t poller_min_period(struct mcp23016_poller *poller)
+{
+	uint64_t floor;
+
+	if (poller->config.bandwidth == 0)
+		return poller->config.min_period;
+
+	/* Sampling all devices once per period must not exceed the
+	 * configured bandwidth.
+	 */
+	floor = (uint64_t)poller->num_devs * POLLER_SAMPLE_BYTES * 1000000000 /
+		poller->config.bandwidth;
+
+	return floor > poller->config.min_period ? floor : poller->config.min_period;
+}
+
+int mcp23016_poller_sample(struct mcp23016_poller *poller)
+{
+	uint16_t vals[MCP23016_DEVICE_MAX], val, changed, any = 0;
+	uint64_t period;
+	size_t i;
+	int res;
+
+	res = mcp23016_register_read_multi(poller->devs, poller->num_devs, REG_GP0, vals);
+	if (res < 0) {
+		atomic_fetch_add_explicit(&poller->errors, 1, memory_order_relaxed);
+		return res;
+	}
+
+	atomic_fetch_add_explicit(&poller->samples, 1, memory_order_relaxed);
+
+	for (i = 0; i < poller->num_devs; i++) {
+		val = vals[i];
+		changed = poller->sampled ? val ^ poller->last[i] : 0;
+		poller->last[i] = val;
+
+		if (poller->snaps[i] != NULL)
+			mcp23016_snapshot_publish(poller->snaps[i], val, 0);
+
+		if (changed != 0 && poller->fn != NULL)
+			poller->fn(poller->devs[i], val, changed, poller->arg);
+
+		any |= changed;
+	}
+	poller->sampled = 1;
+
+	/* The period is reset to the minimum when pins change state and
+	 * backs off exponentially while idle.
+	 */
+	period = atomic_load_explicit(&poller->period, memory_order_relaxed);
+	if (any != 0) {
+		atomic_fetch_add_explicit(&poller->changes, 1, memory_order_relaxed);
+		period = poller->min_period;
+	} else if (period < poller->config.max_period) {
+		period = period * 2 < poller->config.max_period ? period * 2 : poller->config.max_period;
+	}
+	atomic_store_explicit(&poller->period, period, memory_order_relaxed);
+	return 0;
+}
+
+static int poller_arm(struct mcp23016_poller *poller)
+{
+	uint64_t period = atomic_load_explicit(&poller->period, memory_order_relaxed);
+	struct itimerspec its = {0};
+	uint64_t now;
+
+	/* Deadlines are absolute, so time spent sampling does not
+	 * accumulate as drift. Deadlines that have already passed are
+	 * skipped.
+	 */
+	poller->deadline += period;
+	now = monotonic_ns();
+	if (now >= poller->deadline)
+		poller->deadline += ((now - poller->deadline) / period + 1) * period;
+
+	its.it_value.tv_sec = poller->deadline / 1000000000;
+	its.it_value.tv_nsec = poller->deadline % 1000000000;
+
+	return timerfd_settime(poller->tfd, TFD_TIMER_ABSTIME, &its, NULL);
+}
+
+static void *poller_worker(void *arg)
+{
+	struct mcp23016_poller *poller = arg;
+	struct pollfd pfds[] = {
+		{.fd = poller->tfd, .events = POLLIN},
+		{.fd = poller->efd, .events = POLLIN}
+	};
+	uint64_t expirations;
+
+	for (;;) {
+		if (poll(pfds, ARRAY_SIZE(pfds), -1) < 0) {
+			if (errno == EINTR)
+				continue;
+			break;
+		}
+
+		if (pfds[1].revents & POLLIN)
+			break;
+
+		if (read(poller->tfd, &expirations, sizeof(expirations)) < 0)
+			continue;
+
+		/* Failed samples are counted; sampling continues at the
+		 * current period.
+		 */
+		(void)mcp23016_poller_sample(poller);
+
+		/* Failures to re-arm the timer are counted so that they
+		 * are visible in the statistics once sampling stops.
+		 */
+		if (poller_arm(poller) < 0) {
+			atomic_fetch_add_explicit(&poller->errors, 1, memory_order_relaxed);
+			break;
+		}
+	}
+	return NULL;
+}
+
+struct mcp23016_poller *mcp23016_poller_create(struct mcp23016_bus *bus,
+		const struct mcp23016_poller_config *config)
+{
+	struct mcp23016_poller *poller;
+
+	assert(bus != NULL);
+	assert(config != NULL);
+
+	if (config->min_period == 0 || config->max_period < config->min_period) {
+		errno = EINVAL;
+		return NULL;
+	}
+
+	poller = calloc(1, sizeof(*poller));
+	if (poller == NULL)
+		return NULL;
+
+	poller->bus = bus;
+	poller->config = *config;
+	poller->tfd = -1;
+	poller->efd = -1;
+	atomic_init(&poller->samples, 0);
+	atomic_init(&poller->changes, 0);
+	atomic_init(&poller->errors, 0);
+	atomic_init(&poller->period, config->min_period);
+
+	atomic_fetch_add(&bus->refcnt, 1);
+	return poller;
+}
+
+void mcp23016_poller_destroy(struct mcp23016_poller *poller)
+{
+	uint64_t stop = 1;
+
+	assert(poller != NULL);
+
+	if (poller->started) {
+		while (write(poller->efd, &stop, sizeof(stop)) < 0 && errno == EINTR)
+			;
+
+		pthread_join(poller->thread, NULL);
+
+		close(poller->efd);
+		close(poller->tfd);
+	}
+
+	mcp23016_bus_close(poller->bus);
+
+	free(poller);
+}
+
+int mcp23016_poller_add_device(struct mcp23016_poller *poller, struct mcp23016_device *dev,
+		struct mcp23016_snapshot *snap)
+{
+	size_t i;
+
+	assert(poller != NULL);
+	assert(dev != NULL);
+
+	if (poller->started) {
+		errno = EBUSY;
+		return -1;
+	}
+
+	if (dev->bus != poller->bus) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	i = poller->num_devs;
+	if (i >= ARRAY_SIZE(poller->devs)) {
+		errno = ENOSPC;
+		return -1;
+	}
+
+	poller->devs[i] = dev;
+	poller->snaps[i] = snap;
+	poller->num_devs++;
+	poller->min_period = poller_min_period(poller);
+	atomic_store(&poller->period, poller->min_period);
+	return 0;
+}
+
+void mcp23016_poller_set_handler(struct mcp23016_poller *poller, mcp23016_poller_handler fn,
+		void *arg)
+{
+	assert(poller != NULL);
+	assert(!poller->started);
+
+	poller->fn = fn;
+	poller->arg = arg;
+}
+
+int mcp23016_poller_start(struct mcp23016_poller *poller)
+{
+	int res;
+
+	assert(poller != NULL);
+
+	if (poller->started || poller->num_devs == 0) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	poller->tfd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
+	if (poller->tfd < 0)
+		return -1;
+
+	poller->efd = eventfd(0, EFD_CLOEXEC);
+	if (poller->efd < 0)
+		goto err;
+
+	/* The timer is armed before the thread is created so that failures
+	 * are reported to the caller.
+	 */
+	poller->deadline = monotonic_ns();
+	if (poller_arm(poller) < 0)
+		goto err_efd;
+
+	res = pthread_create(&poller->thread, NULL, poller_worker, poller);
+	if (res != 0) {
+		errno = res;
+		goto err_efd;
+	}
+
+	poller->started = 1;
+	return 0;
+err_efd:
+	close(poller->efd);
+err:
+	close(poller->tfd);
+	return -1;
+}
+
+void mcp23016_poller_get_stats(struct mcp23016_poller *poller, struct mcp23016_poller_stats *stats)
+{
+	assert(poller != NULL);
+	assert(stats != NULL);
+
+	stats->samples = atomic_load_explicit(&poller->samples, memory_order_relaxed);
+	stats->changes = atomic_load_explicit(&poller->changes, memory_order_relaxed);
+	stats->errors = atomic_load_explicit(&poller->errors, memory_order_relaxed);
+	stats->period = atomic_load_explicit(&poller->period, memory_order_relaxed);
+}
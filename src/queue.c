@@ -0,0 +1,229 @@
+/* SPDX-License-Identifier: LGPL-2.1-or-later */
+/*
+ * Copyright (C) 2021 Steven Stallion <sstallion@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mcp23016-private.h"
+
+#include <assert.h>
+#include <errno.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+
+static inline void queue_signal(struct mcp23016_queue *queue, uint64_t count)
+{
+	/* Incrementing the counter only fails on overflow, in which case
+	 * the descriptor is already readable.
+	 */
+	if (write(queue->efd, &count, sizeof(count)) < 0)
+		return;
+}
+
+static inline void queue_clear(struct mcp23016_queue *queue)
+{
+	uint64_t count;
+
+	/* Reading the counter fails with EAGAIN if it is already clear. */
+	if (read(queue->efd, &count, sizeof(count)) < 0)
+		return;
+}
+
+static void queue_perform(struct mcp23016_request *req)
+{
+	uint8_t reg = register_addr(req->reg);
+	int res;
+
+	if (req->op == MCP23016_REQUEST_GET)
+		res = mcp23016_register_read(req->dev, reg, &req->val);
+	else
+		res = mcp23016_register_write(req->dev, reg, req->val);
+
+	req->error = res < 0 ? errno : 0;
+}
+
+static void *queue_worker(void *arg)
+{
+	struct mcp23016_queue *queue = arg;
+	struct mcp23016_request *reqs, *req, *done, **done_tail;
+	uint64_t count;
+
+	pthread_mutex_lock(&queue->lock);
+	for (;;) {
+		while (queue->pending == NULL && !queue->stopping)
+			pthread_cond_wait(&queue->cond, &queue->lock);
+
+		if (queue->pending == NULL)
+			break;
+
+		/* Pending requests are taken as a batch so that the lock is
+		 * not held while accessing the bus.
+		 */
+		reqs = queue->pending;
+		queue->pending = NULL;
+		queue->pending_tail = &queue->pending;
+		pthread_mutex_unlock(&queue->lock);
+
+		done = NULL;
+		done_tail = &done;
+		count = 0;
+
+		while (reqs != NULL) {
+			req = reqs;
+			reqs = req->next;
+			req->next = NULL;
+
+			queue_perform(req);
+
+			if (req->fn != NULL) {
+				req->fn(req, req->arg);
+			} else {
+				*done_tail = req;
+				done_tail = &req->next;
+				count++;
+			}
+		}
+
+		pthread_mutex_lock(&queue->lock);
+		if (done != NULL) {
+			*queue->done_tail = done;
+			queue->done_tail = done_tail;
+			queue_signal(queue, count);
+		}
+	}
+	pthread_mutex_unlock(&queue->lock);
+	return NULL;
+}
+
+struct mcp23016_queue *mcp23016_queue_create(struct mcp23016_bus *bus)
+{
+	struct mcp23016_queue *queue;
+	int res;
+
+	assert(bus != NULL);
+
+	queue = calloc(1, sizeof(*queue));
+	if (queue == NULL)
+		return NULL;
+
+	queue->bus = bus;
+	queue->pending_tail = &queue->pending;
+	queue->done_tail = &queue->done;
+
+	queue->efd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+	if (queue->efd < 0)
+		goto err;
+
+	pthread_mutex_init(&queue->lock, NULL);
+	pthread_cond_init(&queue->cond, NULL);
+
+	res = pthread_create(&queue->thread, NULL, queue_worker, queue);
+	if (res != 0) {
+		errno = res;
+		goto err_thread;
+	}
+
+	atomic_fetch_add(&bus->refcnt, 1);
+	return queue;
+err_thread:
+	pthread_cond_destroy(&queue->cond);
+	pthread_mutex_destroy(&queue->lock);
+	close(queue->efd);
+err:
+	free(queue);
+	return NULL;
+}
+
+void mcp23016_queue_destroy(struct mcp23016_queue *queue)
+{
+	assert(queue != NULL);
+
+	pthread_mutex_lock(&queue->lock);
+	queue->stopping = 1;
+	pthread_cond_signal(&queue->cond);
+	pthread_mutex_unlock(&queue->lock);
+
+	pthread_join(queue->thread, NULL);
+
+	pthread_cond_destroy(&queue->cond);
+	pthread_mutex_destroy(&queue->lock);
+	close(queue->efd);
+
+	mcp23016_bus_close(queue->bus);
+
+	free(queue);
+}
+
+int mcp23016_queue_submit(struct mcp23016_queue *queue, struct mcp23016_request *req)
+{
+	assert(queue != NULL);
+	assert(req != NULL);
+	assert(req->dev != NULL);
+
+	if (req->dev->bus != queue->bus ||
+	    register_addr(req->reg) < 0 ||
+	    (req->op != MCP23016_REQUEST_GET && req->op != MCP23016_REQUEST_SET) ||
+	    (req->op == MCP23016_REQUEST_SET && req->reg == MCP23016_REGISTER_INTERRUPT)) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	req->error = 0;
+	req->next = NULL;
+
+	pthread_mutex_lock(&queue->lock);
+	*queue->pending_tail = req;
+	queue->pending_tail = &req->next;
+	pthread_cond_signal(&queue->cond);
+	pthread_mutex_unlock(&queue->lock);
+	return 0;
+}
+
+int mcp23016_queue_get_fd(struct mcp23016_queue *queue)
+{
+	assert(queue != NULL);
+
+	return queue->efd;
+}
+
+size_t mcp23016_queue_reap(struct mcp23016_queue *queue, struct mcp23016_request **reqs,
+		size_t n)
+{
+	size_t i = 0;
+
+	assert(queue != NULL);
+	assert(reqs != NULL || n == 0);
+
+	/* The counter is cleared before consuming requests; completions
+	 * added afterwards signal the descriptor again.
+	 */
+	queue_clear(queue);
+
+	pthread_mutex_lock(&queue->lock);
+	while (i < n && queue->done != NULL) {
+		reqs[i] = queue->done;
+		queue->done = reqs[i]->next;
+		reqs[i++]->next = NULL;
+	}
+	if (queue->done == NULL)
+		queue->done_tail = &queue->done;
+	else
+		queue_signal(queue, 1);
+	pthread_mutex_unlock(&queue->lock);
+	return i;
+}
@@ -0,0 +1,157 @@
+/* SPDX-License-Identifier: LGPL-2.1-or-later */
+/*
+ * Copyright (C) 2021 Steven Stallion <sstallion@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mcp23016-private.h"
+
+#include <assert.h>
+#include <errno.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+static size_t ring_size(size_t capacity)
+{
+	size_t size;
+
+	/* aligned_alloc() requires the size to be a multiple of the
+	 * alignment.
+	 */
+	size = sizeof(struct mcp23016_ring) + capacity * sizeof(struct mcp23016_event);
+	return (size + CACHE_LINE - 1) & ~(size_t)(CACHE_LINE - 1);
+}
+
+size_t mcp23016_ring_size(const struct mcp23016_ring *ring)
+{
+	return ring_size(ring->mask + 1);
+}
+
+struct mcp23016_ring *mcp23016_ring_create(size_t capacity)
+{
+	struct mcp23016_ring *ring;
+	size_t size;
+
+	if (capacity == 0 || (capacity & (capacity - 1)) != 0) {
+		errno = EINVAL;
+		return NULL;
+	}
+
+	size = ring_size(capacity);
+
+	ring = aligned_alloc(CACHE_LINE, size);
+	if (ring == NULL)
+		return NULL;
+
+	memset(ring, 0, size);
+	atomic_init(&ring->head, 0);
+	atomic_init(&ring->overflow, 0);
+	atomic_init(&ring->tail, 0);
+	ring->mask = capacity - 1;
+	return ring;
+}
+
+void mcp23016_ring_destroy(struct mcp23016_ring *ring)
+{
+	assert(ring != NULL);
+
+	free(ring);
+}
+
+size_t mcp23016_ring_capacity(const struct mcp23016_ring *ring)
+{
+	assert(ring != NULL);
+
+	return ring->mask + 1;
+}
+
+int mcp23016_ring_push(struct mcp23016_ring *ring, const struct mcp23016_event *event)
+{
+	size_t head;
+
+	assert(ring != NULL);
+	assert(event != NULL);
+
+	/* The consumer index is only reloaded when the ring appears full,
+	 * which avoids touching the consumer cache line on every push.
+	 */
+	head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+	if (head - ring->tail_cache > ring->mask) {
+		ring->tail_cache = atomic_load_explicit(&ring->tail, memory_order_acquire);
+		if (head - ring->tail_cache > ring->mask) {
+			atomic_fetch_add_explicit(&ring->overflow, 1, memory_order_relaxed);
+			errno = ENOBUFS;
+			return -1;
+		}
+	}
+
+	ring->events[head & ring->mask] = *event;
+	atomic_store_explicit(&ring->head, head + 1, memory_order_release);
+	return 0;
+}
+
+size_t mcp23016_ring_pop(struct mcp23016_ring *ring, struct mcp23016_event *events, size_t n)
+{
+	size_t tail, avail, index, count;
+
+	assert(ring != NULL);
+	assert(events != NULL || n == 0);
+
+	tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+	avail = ring->head_cache - tail;
+	if (avail < n) {
+		ring->head_cache = atomic_load_explicit(&ring->head, memory_order_acquire);
+		avail = ring->head_cache - tail;
+	}
+	if (n > avail)
+		n = avail;
+	if (n == 0)
+		return 0;
+
+	/* Events are copied in at most two runs to account for wrapping. */
+	index = tail & ring->mask;
+	count = ring->mask + 1 - index;
+	if (count > n)
+		count = n;
+
+	memcpy(events, &ring->events[index], count * sizeof(*events));
+	memcpy(events + count, &ring->events[0], (n - count) * sizeof(*events));
+
+	atomic_store_explicit(&ring->tail, tail + n, memory_order_release);
+	return n;
+}
+
+uint64_t mcp23016_ring_get_overflow(const struct mcp23016_ring *ring)
+{
+	assert(ring != NULL);
+
+	return atomic_load_explicit(&ring->overflow, memory_order_relaxed);
+}
+
+void mcp23016_ring_record(struct mcp23016_ring *ring, struct mcp23016_device *dev,
+		uint16_t val, uint16_t changed)
+{
+	struct mcp23016_event event;
+
+	event.timestamp = monotonic_ns();
+	event.device = dev->i2c_addr - BASE_ADDR;
+	event.intcap = val;
+	event.changed = changed;
+
+	/* Events that do not fit are accounted for by the overflow counter. */
+	(void)mcp23016_ring_push(ring, &event);
+}
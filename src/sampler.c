@@ -0,0 +1,333 @@
+/* SPDX-License-Identifier: LGPL-2.1-or-later */
+/*
+ * Copyright (C) 2021 Steven Stallion <sstallion@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mcp23016-private.h"
+
+#include <assert.h>
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sys/mman.h>
+
+static inline void timespec_from_ns(struct timespec *ts, uint64_t ns)
+{
+	ts->tv_sec = ns / 1000000000;
+	ts->tv_nsec = ns % 1000000000;
+}
+
+static void sampler_sample(struct mcp23016_sampler *sampler, uint64_t timestamp)
+{
+	uint16_t vals[MCP23016_DEVICE_MAX];
+	struct mcp23016_event event;
+	size_t i;
+
+	if (mcp23016_register_read_multi(sampler->devs, sampler->num_devs, REG_GP0, vals) < 0) {
+		atomic_fetch_add_explicit(&sampler->errors, 1, memory_order_relaxed);
+		return;
+	}
+
+	/* Records that do not fit in the capture file are counted as failed
+	 * samples; events are still pushed to the ring.
+	 */
+	if (sampler->cap != NULL && mcp23016_capture_append(sampler->cap, timestamp, vals) < 0)
+		atomic_fetch_add_explicit(&sampler->errors, 1, memory_order_relaxed);
+
+	event.timestamp = timestamp;
+	for (i = 0; i < sampler->num_devs; i++) {
+		event.device = sampler->devs[i]->i2c_addr - BASE_ADDR;
+		event.intcap = vals[i];
+		event.changed = vals[i] ^ sampler->last[i];
+		sampler->last[i] = vals[i];
+
+		/* Events that do not fit are accounted for by the overflow
+		 * counter of the ring.
+		 */
+		if (sampler->ring != NULL)
+			(void)mcp23016_ring_push(sampler->ring, &event);
+	}
+
+	atomic_fetch_add_explicit(&sampler->samples, 1, memory_order_relaxed);
+}
+
+static void *sampler_worker(void *arg)
+{
+	struct mcp23016_sampler *sampler = arg;
+	uint64_t period = sampler->config.period;
+	uint64_t deadline, now, missed;
+	struct timespec ts;
+
+	deadline = monotonic_ns();
+	while (!atomic_load_explicit(&sampler->stopping, memory_order_relaxed)) {
+		sampler_sample(sampler, monotonic_ns());
+
+		/* Deadlines are absolute, so time spent sampling does not
+		 * accumulate as drift. Deadlines that have already passed
+		 * are skipped and counted as overruns.
+		 */
+		deadline += period;
+		now = monotonic_ns();
+		if (now >= deadline) {
+			missed = (now - deadline) / period + 1;
+			atomic_fetch_add_explicit(&sampler->overruns, missed, memory_order_relaxed);
+			deadline += missed * period;
+		}
+
+		timespec_from_ns(&ts, deadline);
+		while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR)
+			;
+	}
+	return NULL;
+}
+
+struct mcp23016_sampler *mcp23016_sampler_create(struct mcp23016_bus *bus,
+		const struct mcp23016_sampler_config *config)
+{
+	struct mcp23016_sampler *sampler;
+
+	assert(bus != NULL);
+	assert(config != NULL);
+
+	if (config->period == 0 || config->priority < 0 ||
+	    config->cpu < -1 || config->cpu >= CPU_SETSIZE) {
+		errno = EINVAL;
+		return NULL;
+	}
+
+	sampler = calloc(1, sizeof(*sampler));
+	if (sampler == NULL)
+		return NULL;
+
+	sampler->bus = bus;
+	sampler->config = *config;
+	atomic_init(&sampler->stopping, 0);
+	atomic_init(&sampler->samples, 0);
+	atomic_init(&sampler->overruns, 0);
+	atomic_init(&sampler->errors, 0);
+
+	atomic_fetch_add(&bus->refcnt, 1);
+	return sampler;
+}
+
+void mcp23016_sampler_destroy(struct mcp23016_sampler *sampler)
+{
+	assert(sampler != NULL);
+
+	if (sampler->started) {
+		atomic_store(&sampler->stopping, 1);
+		pthread_join(sampler->thread, NULL);
+
+		munmap(sampler->stack, SAMPLER_STACK);
+		if (sampler->cap != NULL)
+			munlock(sampler->cap->hdr, sampler->cap->size);
+		if (sampler->ring != NULL)
+			munlock(sampler->ring, mcp23016_ring_size(sampler->ring));
+		munlock(sampler, sizeof(*sampler));
+	}
+
+	mcp23016_bus_close(sampler->bus);
+
+	free(sampler);
+}
+
+int mcp23016_sampler_add_device(struct mcp23016_sampler *sampler, struct mcp23016_device *dev)
+{
+	size_t i;
+
+	assert(sampler != NULL);
+	assert(dev != NULL);
+
+	if (sampler->started) {
+		errno = EBUSY;
+		return -1;
+	}
+
+	if (dev->bus != sampler->bus) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	i = sampler->num_devs;
+	if (i >= ARRAY_SIZE(sampler->devs)) {
+		errno = ENOSPC;
+		return -1;
+	}
+
+	sampler->devs[i] = dev;
+	sampler->num_devs++;
+	return 0;
+}
+
+int mcp23016_sampler_set_capture(struct mcp23016_sampler *sampler, struct mcp23016_capture *cap)
+{
+	assert(sampler != NULL);
+
+	if (sampler->started) {
+		errno = EBUSY;
+		return -1;
+	}
+
+	sampler->cap = cap;
+	return 0;
+}
+
+static int sampler_capture_valid(struct mcp23016_sampler *sampler)
+{
+	struct mcp23016_capture_info info;
+	size_t i;
+
+	mcp23016_capture_get_info(sampler->cap, &info);
+	if (info.num_devices != sampler->num_devs || info.clock != CLOCK_MONOTONIC)
+		return 0;
+
+	for (i = 0; i < sampler->num_devs; i++)
+		if (info.devices[i] != (unsigned int)(sampler->devs[i]->i2c_addr - BASE_ADDR))
+			return 0;
+	return 1;
+}
+
+static int sampler_attr_init(struct mcp23016_sampler *sampler, pthread_attr_t *attr)
+{
+	struct sched_param param = {
+		.sched_priority = sampler->config.priority
+	};
+	cpu_set_t cpus;
+	int res;
+
+	res = pthread_attr_init(attr);
+	if (res != 0)
+		return res;
+
+	res = pthread_attr_setstack(attr, sampler->stack, SAMPLER_STACK);
+	if (res != 0)
+		goto err;
+
+	if (sampler->config.priority > 0) {
+		res = pthread_attr_setinheritsched(attr, PTHREAD_EXPLICIT_SCHED);
+		if (res == 0)
+			res = pthread_attr_setschedpolicy(attr, SCHED_FIFO);
+		if (res == 0)
+			res = pthread_attr_setschedparam(attr, &param);
+		if (res != 0)
+			goto err;
+	}
+
+	if (sampler->config.cpu >= 0) {
+		CPU_ZERO(&cpus);
+		CPU_SET(sampler->config.cpu, &cpus);
+
+		res = pthread_attr_setaffinity_np(attr, sizeof(cpus), &cpus);
+		if (res != 0)
+			goto err;
+	}
+	return 0;
+err:
+	pthread_attr_destroy(attr);
+	return res;
+}
+
+int mcp23016_sampler_start(struct mcp23016_sampler *sampler, struct mcp23016_ring *ring)
+{
+	pthread_attr_t attr;
+	int res;
+
+	assert(sampler != NULL);
+
+	if (sampler->started || sampler->num_devs == 0 ||
+	    (ring == NULL && sampler->cap == NULL) ||
+	    (sampler->cap != NULL && !sampler_capture_valid(sampler))) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	/* Initial port values are read so that the first sample reports
+	 * changes relative to them.
+	 */
+	if (mcp23016_register_read_multi(sampler->devs, sampler->num_devs, REG_GP0,
+			sampler->last) < 0)
+		return -1;
+
+	sampler->ring = ring;
+
+	if (mlock(sampler, sizeof(*sampler)) < 0)
+		return -1;
+
+	if (ring != NULL && mlock(ring, mcp23016_ring_size(ring)) < 0)
+		goto err;
+
+	/* Locking the capture mapping also faults it in, so appending
+	 * records never waits on page faults.
+	 */
+	if (sampler->cap != NULL && mlock(sampler->cap->hdr, sampler->cap->size) < 0)
+		goto err_ring;
+
+	/* The sampler thread runs on a locked stack, which is resident
+	 * before sampling begins and is never paged out.
+	 */
+	sampler->stack = mmap(NULL, SAMPLER_STACK, PROT_READ | PROT_WRITE,
+			MAP_PRIVATE | MAP_ANONYMOUS | MAP_STACK, -1, 0);
+	if (sampler->stack == MAP_FAILED)
+		goto err_cap;
+
+	if (mlock(sampler->stack, SAMPLER_STACK) < 0)
+		goto err_stack;
+
+	res = sampler_attr_init(sampler, &attr);
+	if (res != 0)
+		goto err_thread;
+
+	res = pthread_create(&sampler->thread, &attr, sampler_worker, sampler);
+	pthread_attr_destroy(&attr);
+	if (res != 0)
+		goto err_thread;
+
+	sampler->started = 1;
+	return 0;
+err_thread:
+	errno = res;
+err_stack:
+	res = errno;
+	munmap(sampler->stack, SAMPLER_STACK);
+	errno = res;
+err_cap:
+	if (sampler->cap != NULL)
+		munlock(sampler->cap->hdr, sampler->cap->size);
+err_ring:
+	if (ring != NULL)
+		munlock(ring, mcp23016_ring_size(ring));
+err:
+	res = errno;
+	munlock(sampler, sizeof(*sampler));
+	errno = res;
+	return -1;
+}
+
+void mcp23016_sampler_get_stats(struct mcp23016_sampler *sampler,
+		struct mcp23016_sampler_stats *stats)
+{
+	assert(sampler != NULL);
+	assert(stats != NULL);
+
+	stats->samples = atomic_load_explicit(&sampler->samples, memory_order_relaxed);
+	stats->overruns = atomic_load_explicit(&sampler->overruns, memory_order_relaxed);
+	stats->errors = atomic_load_explicit(&sampler->errors, memory_order_relaxed);
+}
@@ -0,0 +1,94 @@
+/* SPDX-License-Identifier: LGPL-2.1-or-later */
+/*
+ * Copyright (C) 2021 Steven Stallion <sstallion@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mcp23016-private.h"
+
+#include <assert.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+struct mcp23016_snapshot *mcp23016_snapshot_create(void)
+{
+	struct mcp23016_snapshot *snap;
+
+	snap = aligned_alloc(CACHE_LINE, sizeof(*snap));
+	if (snap == NULL)
+		return NULL;
+
+	memset(snap, 0, sizeof(*snap));
+	atomic_init(&snap->seq, 0);
+	atomic_init(&snap->timestamp, 0);
+	atomic_init(&snap->port, 0);
+	atomic_init(&snap->intcap, 0);
+	return snap;
+}
+
+void mcp23016_snapshot_destroy(struct mcp23016_snapshot *snap)
+{
+	assert(snap != NULL);
+
+	free(snap);
+}
+
+void mcp23016_snapshot_publish(struct mcp23016_snapshot *snap, uint16_t port, uint16_t intcap)
+{
+	uint64_t seq;
+
+	assert(snap != NULL);
+
+	/* The sequence count is odd while fields are updated; the release
+	 * fence orders the odd count before the field stores.
+	 */
+	seq = atomic_load_explicit(&snap->seq, memory_order_relaxed);
+	atomic_store_explicit(&snap->seq, seq + 1, memory_order_relaxed);
+	atomic_thread_fence(memory_order_release);
+
+	atomic_store_explicit(&snap->timestamp, monotonic_ns(), memory_order_relaxed);
+	atomic_store_explicit(&snap->port, port, memory_order_relaxed);
+	atomic_store_explicit(&snap->intcap, intcap, memory_order_relaxed);
+
+	atomic_store_explicit(&snap->seq, seq + 2, memory_order_release);
+}
+
+void mcp23016_snapshot_read(const struct mcp23016_snapshot *snap, struct mcp23016_input *input)
+{
+	uint64_t seq;
+
+	assert(snap != NULL);
+	assert(input != NULL);
+
+	/* Reads are retried while a publish is in progress or if the
+	 * sequence count changed; the acquire fence orders the field loads
+	 * before the second load of the count.
+	 */
+	do {
+		do {
+			seq = atomic_load_explicit(&snap->seq, memory_order_acquire);
+		} while (seq & 1);
+
+		input->timestamp = atomic_load_explicit(&snap->timestamp, memory_order_relaxed);
+		input->port = atomic_load_explicit(&snap->port, memory_order_relaxed);
+		input->intcap = atomic_load_explicit(&snap->intcap, memory_order_relaxed);
+
+		atomic_thread_fence(memory_order_acquire);
+	} while (atomic_load_explicit(&snap->seq, memory_order_relaxed) != seq);
+
+	input->sequence = seq / 2;
+}
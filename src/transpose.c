@@ -0,0 +1,410 @@
+/* SPDX-License-Identifier: LGPL-2.1-or-later */
+/*
+ * Copyright (C) 2021 Steven Stallion <sstallion@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mcp23016-private.h"
+
+#include <assert.h>
+#include <stdint.h>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#include <immintrin.h>
+#define TRANSPOSE_X86
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#define TRANSPOSE_NEON
+#endif
+
+/* Number of pins per port value */
+#define PINS		16
+
+/* Number of samples per bitstream word */
+#define BLOCK		64
+
+/* Blocks of samples are transposed into one word of each bitstream; words
+ * of consecutive pins are stride words apart.
+ */
+typedef void (*transpose_fn)(const uint16_t *samples, uint64_t *bits, size_t stride);
+typedef void (*untranspose_fn)(const uint64_t *bits, size_t stride, uint16_t *samples);
+
+/* Transposes an 8x8 bit matrix held one row per byte, so that bit j of
+ * byte i moves to bit i of byte j.
+ */
+static inline uint64_t transpose8(uint64_t x)
+{
+	uint64_t t;
+
+	t = (x ^ (x >> 7)) & 0x00aa00aa00aa00aaULL;
+	x ^= t ^ (t << 7);
+	t = (x ^ (x >> 14)) & 0x0000cccc0000ccccULL;
+	x ^= t ^ (t << 14);
+	t = (x ^ (x >> 28)) & 0x00000000f0f0f0f0ULL;
+	x ^= t ^ (t << 28);
+	return x;
+}
+
+static void transpose_block_scalar(const uint16_t *samples, uint64_t *bits, size_t stride)
+{
+	uint64_t acc[PINS] = {0};
+	uint64_t lo, hi;
+	size_t g, i, k;
+
+	for (g = 0; g < BLOCK / 8; g++) {
+		lo = 0;
+		hi = 0;
+		for (i = 0; i < 8; i++) {
+			lo |= (uint64_t)LOW(samples[8 * g + i]) << (8 * i);
+			hi |= (uint64_t)HIGH(samples[8 * g + i]) << (8 * i);
+		}
+
+		lo = transpose8(lo);
+		hi = transpose8(hi);
+		for (k = 0; k < 8; k++) {
+			acc[k] |= ((lo >> (8 * k)) & 0xff) << (8 * g);
+			acc[k + 8] |= ((hi >> (8 * k)) & 0xff) << (8 * g);
+		}
+	}
+
+	for (k = 0; k < PINS; k++)
+		bits[k * stride] = acc[k];
+}
+
+static void untranspose_block_scalar(const uint64_t *bits, size_t stride, uint16_t *samples)
+{
+	uint64_t lo, hi;
+	size_t g, i, k;
+
+	for (g = 0; g < BLOCK / 8; g++) {
+		lo = 0;
+		hi = 0;
+		for (k = 0; k < 8; k++) {
+			lo |= ((bits[k * stride] >> (8 * g)) & 0xff) << (8 * k);
+			hi |= ((bits[(k + 8) * stride] >> (8 * g)) & 0xff) << (8 * k);
+		}
+
+		lo = transpose8(lo);
+		hi = transpose8(hi);
+		for (i = 0; i < 8; i++)
+			samples[8 * g + i] = LOW(lo >> (8 * i)) | LOW(hi >> (8 * i)) << 8;
+	}
+}
+
+#ifdef TRANSPOSE_X86
+/* Low and high bytes of 16 samples are packed into separate vectors; the
+ * most significant bit of each byte is then gathered with movemask and
+ * shifted out, yielding 16 bits of one bitstream per step.
+ */
+__attribute__((target("sse2")))
+static void transpose_block_sse2(const uint16_t *samples, uint64_t *bits, size_t stride)
+{
+	const __m128i mask = _mm_set1_epi16(0xff);
+	uint64_t acc[PINS] = {0};
+	__m128i a, b, lo, hi;
+	size_t c;
+	int k;
+
+	for (c = 0; c < BLOCK / 16; c++) {
+		a = _mm_loadu_si128((const __m128i *)(samples + 16 * c));
+		b = _mm_loadu_si128((const __m128i *)(samples + 16 * c + 8));
+		lo = _mm_packus_epi16(_mm_and_si128(a, mask), _mm_and_si128(b, mask));
+		hi = _mm_packus_epi16(_mm_srli_epi16(a, 8), _mm_srli_epi16(b, 8));
+
+		for (k = 7; k >= 0; k--) {
+			acc[k] |= (uint64_t)(uint16_t)_mm_movemask_epi8(lo) << (16 * c);
+			acc[k + 8] |= (uint64_t)(uint16_t)_mm_movemask_epi8(hi) << (16 * c);
+			lo = _mm_add_epi8(lo, lo);
+			hi = _mm_add_epi8(hi, hi);
+		}
+	}
+
+	for (k = 0; k < PINS; k++)
+		bits[k * stride] = acc[k];
+}
+
+__attribute__((target("avx2")))
+static void transpose_block_avx2(const uint16_t *samples, uint64_t *bits, size_t stride)
+{
+	const __m256i mask = _mm256_set1_epi16(0xff);
+	uint64_t acc[PINS] = {0};
+	__m256i a, b, lo, hi;
+	size_t c;
+	int k;
+
+	for (c = 0; c < BLOCK / 32; c++) {
+		a = _mm256_loadu_si256((const __m256i *)(samples + 32 * c));
+		b = _mm256_loadu_si256((const __m256i *)(samples + 32 * c + 16));
+
+		/* Packing operates on 128-bit lanes; the permute restores
+		 * sample order.
+		 */
+		lo = _mm256_packus_epi16(_mm256_and_si256(a, mask), _mm256_and_si256(b, mask));
+		hi = _mm256_packus_epi16(_mm256_srli_epi16(a, 8), _mm256_srli_epi16(b, 8));
+		lo = _mm256_permute4x64_epi64(lo, 0xd8);
+		hi = _mm256_permute4x64_epi64(hi, 0xd8);
+
+		for (k = 7; k >= 0; k--) {
+			acc[k] |= (uint64_t)(uint32_t)_mm256_movemask_epi8(lo) << (32 * c);
+			acc[k + 8] |= (uint64_t)(uint32_t)_mm256_movemask_epi8(hi) << (32 * c);
+			lo = _mm256_add_epi8(lo, lo);
+			hi = _mm256_add_epi8(hi, hi);
+		}
+	}
+
+	for (k = 0; k < PINS; k++)
+		bits[k * stride] = acc[k];
+}
+
+/* Each 16 bits of a bitstream are broadcast to the bytes of a vector and
+ * compared against a per-byte bit selector, yielding a byte mask that
+ * places the bit of the pin into the low or high byte of each sample.
+ */
+__attribute__((target("sse2")))
+static void untranspose_block_sse2(const uint64_t *bits, size_t stride, uint16_t *samples)
+{
+	const __m128i sel = _mm_set1_epi64x(0x8040201008040201LL);
+	__m128i x, lo, hi;
+	uint64_t m;
+	size_t c;
+	int k;
+
+	for (c = 0; c < BLOCK / 16; c++) {
+		lo = _mm_setzero_si128();
+		hi = _mm_setzero_si128();
+
+		for (k = 0; k < 8; k++) {
+			m = bits[k * stride] >> (16 * c);
+			x = _mm_set_epi64x(HIGH(m) * 0x0101010101010101ULL,
+					   LOW(m) * 0x0101010101010101ULL);
+			x = _mm_cmpeq_epi8(_mm_and_si128(x, sel), sel);
+			lo = _mm_or_si128(lo, _mm_and_si128(x, _mm_set1_epi8(1 << k)));
+
+			m = bits[(k + 8) * stride] >> (16 * c);
+			x = _mm_set_epi64x(HIGH(m) * 0x0101010101010101ULL,
+					   LOW(m) * 0x0101010101010101ULL);
+			x = _mm_cmpeq_epi8(_mm_and_si128(x, sel), sel);
+			hi = _mm_or_si128(hi, _mm_and_si128(x, _mm_set1_epi8(1 << k)));
+		}
+
+		_mm_storeu_si128((__m128i *)(samples + 16 * c), _mm_unpacklo_epi8(lo, hi));
+		_mm_storeu_si128((__m128i *)(samples + 16 * c + 8), _mm_unpackhi_epi8(lo, hi));
+	}
+}
+#endif /* TRANSPOSE_X86 */
+
+#ifdef TRANSPOSE_NEON
+/* NEON lacks movemask; the most significant bit of each byte is instead
+ * widened to a byte mask, weighted by its position, and summed across each
+ * half of the vector.
+ */
+static const uint8_t neon_weights[16] = {
+	1, 2, 4, 8, 16, 32, 64, 128,
+	1, 2, 4, 8, 16, 32, 64, 128
+};
+
+static inline uint16_t neon_movemask(uint8x16_t x, uint8x16_t weights)
+{
+	uint8x16_t t;
+
+	t = vandq_u8(vreinterpretq_u8_s8(vshrq_n_s8(vreinterpretq_s8_u8(x), 7)), weights);
+	return vaddv_u8(vget_low_u8(t)) | (uint16_t)vaddv_u8(vget_high_u8(t)) << 8;
+}
+
+static void transpose_block_neon(const uint16_t *samples, uint64_t *bits, size_t stride)
+{
+	const uint8x16_t weights = vld1q_u8(neon_weights);
+	uint64_t acc[PINS] = {0};
+	uint16x8_t a, b;
+	uint8x16_t lo, hi;
+	size_t c;
+	int k;
+
+	for (c = 0; c < BLOCK / 16; c++) {
+		a = vld1q_u16(samples + 16 * c);
+		b = vld1q_u16(samples + 16 * c + 8);
+		lo = vcombine_u8(vmovn_u16(a), vmovn_u16(b));
+		hi = vcombine_u8(vshrn_n_u16(a, 8), vshrn_n_u16(b, 8));
+
+		for (k = 7; k >= 0; k--) {
+			acc[k] |= (uint64_t)neon_movemask(lo, weights) << (16 * c);
+			acc[k + 8] |= (uint64_t)neon_movemask(hi, weights) << (16 * c);
+			lo = vshlq_n_u8(lo, 1);
+			hi = vshlq_n_u8(hi, 1);
+		}
+	}
+
+	for (k = 0; k < PINS; k++)
+		bits[k * stride] = acc[k];
+}
+
+static void untranspose_block_neon(const uint64_t *bits, size_t stride, uint16_t *samples)
+{
+	const uint8x16_t sel = vld1q_u8(neon_weights);
+	uint8x16_t x, lo, hi;
+	uint64_t m;
+	size_t c;
+	int k;
+
+	for (c = 0; c < BLOCK / 16; c++) {
+		lo = vdupq_n_u8(0);
+		hi = vdupq_n_u8(0);
+
+		for (k = 0; k < 8; k++) {
+			m = bits[k * stride] >> (16 * c);
+			x = vcombine_u8(vdup_n_u8(LOW(m)), vdup_n_u8(HIGH(m)));
+			lo = vorrq_u8(lo, vandq_u8(vtstq_u8(x, sel), vdupq_n_u8(1 << k)));
+
+			m = bits[(k + 8) * stride] >> (16 * c);
+			x = vcombine_u8(vdup_n_u8(LOW(m)), vdup_n_u8(HIGH(m)));
+			hi = vorrq_u8(hi, vandq_u8(vtstq_u8(x, sel), vdupq_n_u8(1 << k)));
+		}
+
+		vst1q_u16(samples + 16 * c,
+			  vorrq_u16(vmovl_u8(vget_low_u8(lo)), vshlq_n_u16(vmovl_u8(vget_low_u8(hi)), 8)));
+		vst1q_u16(samples + 16 * c + 8,
+			  vorrq_u16(vmovl_u8(vget_high_u8(lo)), vshlq_n_u16(vmovl_u8(vget_high_u8(hi)), 8)));
+	}
+}
+#endif /* TRANSPOSE_NEON */
+
+static transpose_fn transpose_select(void)
+{
+#if defined(TRANSPOSE_X86)
+	if (__builtin_cpu_supports("avx2"))
+		return transpose_block_avx2;
+	if (__builtin_cpu_supports("sse2"))
+		return transpose_block_sse2;
+#elif defined(TRANSPOSE_NEON)
+	return transpose_block_neon;
+#endif
+	return transpose_block_scalar;
+}
+
+static untranspose_fn untranspose_select(void)
+{
+#if defined(TRANSPOSE_X86)
+	if (__builtin_cpu_supports("sse2"))
+		return untranspose_block_sse2;
+#elif defined(TRANSPOSE_NEON)
+	return untranspose_block_neon;
+#endif
+	return untranspose_block_scalar;
+}
+
+size_t mcp23016_bitstream_words(size_t n)
+{
+	return n / BLOCK + (n % BLOCK != 0);
+}
+
+void mcp23016_transpose(const uint16_t *samples, size_t n, uint64_t *bits)
+{
+	size_t words, w, i, k;
+	transpose_fn fn;
+
+	assert(samples != NULL || n == 0);
+	assert(bits != NULL || n == 0);
+
+	words = mcp23016_bitstream_words(n);
+
+	fn = transpose_select();
+	for (w = 0; w < n / BLOCK; w++)
+		fn(samples + BLOCK * w, bits + w, words);
+
+	/* Samples that do not fill a block are transposed a bit at a time. */
+	if (n % BLOCK != 0) {
+		for (k = 0; k < PINS; k++)
+			bits[k * words + w] = 0;
+
+		for (i = BLOCK * w; i < n; i++)
+			for (k = 0; k < PINS; k++)
+				bits[k * words + w] |= (uint64_t)((samples[i] >> k) & 1) << (i % BLOCK);
+	}
+}
+
+void mcp23016_untranspose(const uint64_t *bits, size_t n, uint16_t *samples)
+{
+	size_t words, w, i, k;
+	untranspose_fn fn;
+
+	assert(bits != NULL || n == 0);
+	assert(samples != NULL || n == 0);
+
+	words = mcp23016_bitstream_words(n);
+
+	fn = untranspose_select();
+	for (w = 0; w < n / BLOCK; w++)
+		fn(bits + w, words, samples + BLOCK * w);
+
+	for (i = BLOCK * w; i < n; i++) {
+		samples[i] = 0;
+		for (k = 0; k < PINS; k++)
+			samples[i] |= ((bits[k * words + w] >> (i % BLOCK)) & 1) << k;
+	}
+}
+
+/* Mask of the bits of word w that hold one of n samples */
+static inline uint64_t bitstream_mask(size_t n, size_t w)
+{
+	if (w < n / BLOCK)
+		return UINT64_MAX;
+
+	return (UINT64_C(1) << (n % BLOCK)) - 1;
+}
+
+uint64_t mcp23016_bitstream_high(const uint64_t *bits, size_t n)
+{
+	size_t words, w;
+	uint64_t count = 0;
+
+	assert(bits != NULL || n == 0);
+
+	words = mcp23016_bitstream_words(n);
+	for (w = 0; w < words; w++)
+		count += __builtin_popcountll(bits[w] & bitstream_mask(n, w));
+	return count;
+}
+
+void mcp23016_bitstream_edges(const uint64_t *bits, size_t n, uint64_t *rising,
+		uint64_t *falling)
+{
+	uint64_t prev, cur, carry, mask;
+	size_t words, w;
+
+	assert(bits != NULL || n == 0);
+	assert(rising != NULL);
+	assert(falling != NULL);
+
+	*rising = 0;
+	*falling = 0;
+	if (n == 0)
+		return;
+
+	/* Each word is compared against itself shifted by one sample, with
+	 * the last sample of the previous word shifted in. The first sample
+	 * is compared against itself.
+	 */
+	words = mcp23016_bitstream_words(n);
+	carry = bits[0] & 1;
+	for (w = 0; w < words; w++) {
+		mask = bitstream_mask(n, w);
+		cur = bits[w];
+		prev = cur << 1 | carry;
+		carry = cur >> 63;
+
+		*rising += __builtin_popcountll(cur & ~prev & mask);
+		*falling += __builtin_popcountll(~cur & prev & mask);
+	}
+}
@@ -20,6 +20,7 @@
 
 #include <stddef.h>
 #include <stdint.h>
+#include <linux/i2c.h>
 #include <gpiod.h>
 #include <i2cd.h>
 
@@ -40,12 +41,194 @@ void __wrap_free(void *ptr)
 }
 
 /* libgpiod */
+#ifdef HAVE_GPIOD_V2
+void *__hook_gpiod_chip_open = __real_gpiod_chip_open;
+void *__hook_gpiod_chip_close = __real_gpiod_chip_close;
+void *__hook_gpiod_chip_request_lines = __real_gpiod_chip_request_lines;
+void *__hook_gpiod_line_settings_new = __real_gpiod_line_settings_new;
+void *__hook_gpiod_line_settings_free = __real_gpiod_line_settings_free;
+void *__hook_gpiod_line_settings_set_direction = __real_gpiod_line_settings_set_direction;
+void *__hook_gpiod_line_settings_set_edge_detection = __real_gpiod_line_settings_set_edge_detection;
+void *__hook_gpiod_line_settings_set_active_low = __real_gpiod_line_settings_set_active_low;
+void *__hook_gpiod_line_settings_set_debounce_period_us = __real_gpiod_line_settings_set_debounce_period_us;
+void *__hook_gpiod_line_settings_set_event_clock = __real_gpiod_line_settings_set_event_clock;
+void *__hook_gpiod_line_config_new = __real_gpiod_line_config_new;
+void *__hook_gpiod_line_config_free = __real_gpiod_line_config_free;
+void *__hook_gpiod_line_config_add_line_settings = __real_gpiod_line_config_add_line_settings;
+void *__hook_gpiod_request_config_new = __real_gpiod_request_config_new;
+void *__hook_gpiod_request_config_free = __real_gpiod_request_config_free;
+void *__hook_gpiod_request_config_set_consumer = __real_gpiod_request_config_set_consumer;
+void *__hook_gpiod_request_config_set_event_buffer_size = __real_gpiod_request_config_set_event_buffer_size;
+void *__hook_gpiod_line_request_release = __real_gpiod_line_request_release;
+void *__hook_gpiod_line_request_get_value = __real_gpiod_line_request_get_value;
+void *__hook_gpiod_line_request_get_fd = __real_gpiod_line_request_get_fd;
+void *__hook_gpiod_line_request_wait_edge_events = __real_gpiod_line_request_wait_edge_events;
+void *__hook_gpiod_line_request_read_edge_events = __real_gpiod_line_request_read_edge_events;
+void *__hook_gpiod_edge_event_buffer_new = __real_gpiod_edge_event_buffer_new;
+void *__hook_gpiod_edge_event_buffer_get_capacity = __real_gpiod_edge_event_buffer_get_capacity;
+void *__hook_gpiod_edge_event_buffer_free = __real_gpiod_edge_event_buffer_free;
+
+struct gpiod_chip *__wrap_gpiod_chip_open(const char *path)
+{
+	struct gpiod_chip *(*fn)(const char *path) = __hook_gpiod_chip_open;
+	return fn(path);
+}
+
+void __wrap_gpiod_chip_close(struct gpiod_chip *chip)
+{
+	void (*fn)(struct gpiod_chip *chip) = __hook_gpiod_chip_close;
+	fn(chip);
+}
+
+struct gpiod_line_request *__wrap_gpiod_chip_request_lines(struct gpiod_chip *chip, struct gpiod_request_config *req_cfg, struct gpiod_line_config *line_cfg)
+{
+	struct gpiod_line_request *(*fn)(struct gpiod_chip *chip, struct gpiod_request_config *req_cfg, struct gpiod_line_config *line_cfg) = __hook_gpiod_chip_request_lines;
+	return fn(chip, req_cfg, line_cfg);
+}
+
+struct gpiod_line_settings *__wrap_gpiod_line_settings_new(void)
+{
+	struct gpiod_line_settings *(*fn)(void) = __hook_gpiod_line_settings_new;
+	return fn();
+}
+
+void __wrap_gpiod_line_settings_free(struct gpiod_line_settings *settings)
+{
+	void (*fn)(struct gpiod_line_settings *settings) = __hook_gpiod_line_settings_free;
+	fn(settings);
+}
+
+int __wrap_gpiod_line_settings_set_direction(struct gpiod_line_settings *settings, enum gpiod_line_direction direction)
+{
+	int (*fn)(struct gpiod_line_settings *settings, enum gpiod_line_direction direction) = __hook_gpiod_line_settings_set_direction;
+	return fn(settings, direction);
+}
+
+int __wrap_gpiod_line_settings_set_edge_detection(struct gpiod_line_settings *settings, enum gpiod_line_edge edge)
+{
+	int (*fn)(struct gpiod_line_settings *settings, enum gpiod_line_edge edge) = __hook_gpiod_line_settings_set_edge_detection;
+	return fn(settings, edge);
+}
+
+void __wrap_gpiod_line_settings_set_active_low(struct gpiod_line_settings *settings, bool active_low)
+{
+	void (*fn)(struct gpiod_line_settings *settings, bool active_low) = __hook_gpiod_line_settings_set_active_low;
+	fn(settings, active_low);
+}
+
+void __wrap_gpiod_line_settings_set_debounce_period_us(struct gpiod_line_settings *settings, unsigned long period)
+{
+	void (*fn)(struct gpiod_line_settings *settings, unsigned long period) = __hook_gpiod_line_settings_set_debounce_period_us;
+	fn(settings, period);
+}
+
+int __wrap_gpiod_line_settings_set_event_clock(struct gpiod_line_settings *settings, enum gpiod_line_clock event_clock)
+{
+	int (*fn)(struct gpiod_line_settings *settings, enum gpiod_line_clock event_clock) = __hook_gpiod_line_settings_set_event_clock;
+	return fn(settings, event_clock);
+}
+
+struct gpiod_line_config *__wrap_gpiod_line_config_new(void)
+{
+	struct gpiod_line_config *(*fn)(void) = __hook_gpiod_line_config_new;
+	return fn();
+}
+
+void __wrap_gpiod_line_config_free(struct gpiod_line_config *config)
+{
+	void (*fn)(struct gpiod_line_config *config) = __hook_gpiod_line_config_free;
+	fn(config);
+}
+
+int __wrap_gpiod_line_config_add_line_settings(struct gpiod_line_config *config, const unsigned int *offsets, size_t num_offsets, struct gpiod_line_settings *settings)
+{
+	int (*fn)(struct gpiod_line_config *config, const unsigned int *offsets, size_t num_offsets, struct gpiod_line_settings *settings) = __hook_gpiod_line_config_add_line_settings;
+	return fn(config, offsets, num_offsets, settings);
+}
+
+struct gpiod_request_config *__wrap_gpiod_request_config_new(void)
+{
+	struct gpiod_request_config *(*fn)(void) = __hook_gpiod_request_config_new;
+	return fn();
+}
+
+void __wrap_gpiod_request_config_free(struct gpiod_request_config *config)
+{
+	void (*fn)(struct gpiod_request_config *config) = __hook_gpiod_request_config_free;
+	fn(config);
+}
+
+void __wrap_gpiod_request_config_set_consumer(struct gpiod_request_config *config, const char *consumer)
+{
+	void (*fn)(struct gpiod_request_config *config, const char *consumer) = __hook_gpiod_request_config_set_consumer;
+	fn(config, consumer);
+}
+
+void __wrap_gpiod_request_config_set_event_buffer_size(struct gpiod_request_config *config, size_t event_buffer_size)
+{
+	void (*fn)(struct gpiod_request_config *config, size_t event_buffer_size) = __hook_gpiod_request_config_set_event_buffer_size;
+	fn(config, event_buffer_size);
+}
+
+void __wrap_gpiod_line_request_release(struct gpiod_line_request *request)
+{
+	void (*fn)(struct gpiod_line_request *request) = __hook_gpiod_line_request_release;
+	fn(request);
+}
+
+enum gpiod_line_value __wrap_gpiod_line_request_get_value(struct gpiod_line_request *request, unsigned int offset)
+{
+	enum gpiod_line_value (*fn)(struct gpiod_line_request *request, unsigned int offset) = __hook_gpiod_line_request_get_value;
+	return fn(request, offset);
+}
+
+int __wrap_gpiod_line_request_get_fd(struct gpiod_line_request *request)
+{
+	int (*fn)(struct gpiod_line_request *request) = __hook_gpiod_line_request_get_fd;
+	return fn(request);
+}
+
+int __wrap_gpiod_line_request_wait_edge_events(struct gpiod_line_request *request, int64_t timeout_ns)
+{
+	int (*fn)(struct gpiod_line_request *request, int64_t timeout_ns) = __hook_gpiod_line_request_wait_edge_events;
+	return fn(request, timeout_ns);
+}
+
+int __wrap_gpiod_line_request_read_edge_events(struct gpiod_line_request *request, struct gpiod_edge_event_buffer *buffer, size_t max_events)
+{
+	int (*fn)(struct gpiod_line_request *request, struct gpiod_edge_event_buffer *buffer, size_t max_events) = __hook_gpiod_line_request_read_edge_events;
+	return fn(request, buffer, max_events);
+}
+
+struct gpiod_edge_event_buffer *__wrap_gpiod_edge_event_buffer_new(size_t capacity)
+{
+	struct gpiod_edge_event_buffer *(*fn)(size_t capacity) = __hook_gpiod_edge_event_buffer_new;
+	return fn(capacity);
+}
+
+size_t __wrap_gpiod_edge_event_buffer_get_capacity(struct gpiod_edge_event_buffer *buffer)
+{
+	size_t (*fn)(struct gpiod_edge_event_buffer *buffer) = __hook_gpiod_edge_event_buffer_get_capacity;
+	return fn(buffer);
+}
+
+void __wrap_gpiod_edge_event_buffer_free(struct gpiod_edge_event_buffer *buffer)
+{
+	void (*fn)(struct gpiod_edge_event_buffer *buffer) = __hook_gpiod_edge_event_buffer_free;
+	fn(buffer);
+}
+#else
 void *__hook_gpiod_chip_open = __real_gpiod_chip_open;
 void *__hook_gpiod_chip_close = __real_gpiod_chip_close;
 void *__hook_gpiod_chip_get_line = __real_gpiod_chip_get_line;
 void *__hook_gpiod_line_release = __real_gpiod_line_release;
 void *__hook_gpiod_line_request_input_flags = __real_gpiod_line_request_input_flags;
 void *__hook_gpiod_line_get_value = __real_gpiod_line_get_value;
+void *__hook_gpiod_line_request_rising_edge_events_flags = __real_gpiod_line_request_rising_edge_events_flags;
+void *__hook_gpiod_line_event_wait = __real_gpiod_line_event_wait;
+void *__hook_gpiod_line_event_read = __real_gpiod_line_event_read;
+void *__hook_gpiod_line_event_read_multiple = __real_gpiod_line_event_read_multiple;
+void *__hook_gpiod_line_event_get_fd = __real_gpiod_line_event_get_fd;
 
 struct gpiod_chip *__wrap_gpiod_chip_open(const char *path)
 {
@@ -83,11 +266,43 @@ int __wrap_gpiod_line_get_value(struct gpiod_line *line)
 	return fn(line);
 }
 
+int __wrap_gpiod_line_request_rising_edge_events_flags(struct gpiod_line *line, const char *consumer, int flags)
+{
+	int (*fn)(struct gpiod_line *line, const char *consumer, int flags) = __hook_gpiod_line_request_rising_edge_events_flags;
+	return fn(line, consumer, flags);
+}
+
+int __wrap_gpiod_line_event_wait(struct gpiod_line *line, const struct timespec *timeout)
+{
+	int (*fn)(struct gpiod_line *line, const struct timespec *timeout) = __hook_gpiod_line_event_wait;
+	return fn(line, timeout);
+}
+
+int __wrap_gpiod_line_event_read(struct gpiod_line *line, struct gpiod_line_event *event)
+{
+	int (*fn)(struct gpiod_line *line, struct gpiod_line_event *event) = __hook_gpiod_line_event_read;
+	return fn(line, event);
+}
+
+int __wrap_gpiod_line_event_read_multiple(struct gpiod_line *line, struct gpiod_line_event *events, unsigned int num_events)
+{
+	int (*fn)(struct gpiod_line *line, struct gpiod_line_event *events, unsigned int num_events) = __hook_gpiod_line_event_read_multiple;
+	return fn(line, events, num_events);
+}
+
+int __wrap_gpiod_line_event_get_fd(struct gpiod_line *line)
+{
+	int (*fn)(struct gpiod_line *line) = __hook_gpiod_line_event_get_fd;
+	return fn(line);
+}
+#endif
+
 /* libi2cd */
 void *__hook_i2cd_open = __real_i2cd_open;
 void *__hook_i2cd_close = __real_i2cd_close;
 void *__hook_i2cd_write = __real_i2cd_write;
 void *__hook_i2cd_write_read = __real_i2cd_write_read;
+void *__hook_i2cd_transfer = __real_i2cd_transfer;
 
 struct i2cd *__wrap_i2cd_open(const char *path)
 {
@@ -115,3 +330,9 @@ int __wrap_i2cd_write_read(struct i2cd *dev, uint16_t addr,
 			void *read_buf, size_t read_len) = __hook_i2cd_write_read;
 	return fn(dev, addr, write_buf, write_len, read_buf, read_len);
 }
+
+int __wrap_i2cd_transfer(struct i2cd *dev, struct i2c_msg *msgs, size_t nmsgs)
+{
+	int (*fn)(struct i2cd *dev, struct i2c_msg *msgs, size_t nmsgs) = __hook_i2cd_transfer;
+	return fn(dev, msgs, nmsgs);
+}
@@ -19,8 +19,13 @@
 #ifndef HOOKS_H
 #define HOOKS_H
 
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
 #include <stddef.h>
 #include <stdint.h>
+#include <linux/i2c.h>
 #include <gpiod.h>
 #include <i2cd.h>
 
@@ -42,12 +47,70 @@ void *__real_calloc(size_t nmemb, size_t size);
 void __real_free(void *ptr);
 
 /* libgpiod */
+#ifdef HAVE_GPIOD_V2
+extern void *__hook_gpiod_chip_open;
+extern void *__hook_gpiod_chip_close;
+extern void *__hook_gpiod_chip_request_lines;
+extern void *__hook_gpiod_line_settings_new;
+extern void *__hook_gpiod_line_settings_free;
+extern void *__hook_gpiod_line_settings_set_direction;
+extern void *__hook_gpiod_line_settings_set_edge_detection;
+extern void *__hook_gpiod_line_settings_set_active_low;
+extern void *__hook_gpiod_line_settings_set_debounce_period_us;
+extern void *__hook_gpiod_line_settings_set_event_clock;
+extern void *__hook_gpiod_line_config_new;
+extern void *__hook_gpiod_line_config_free;
+extern void *__hook_gpiod_line_config_add_line_settings;
+extern void *__hook_gpiod_request_config_new;
+extern void *__hook_gpiod_request_config_free;
+extern void *__hook_gpiod_request_config_set_consumer;
+extern void *__hook_gpiod_request_config_set_event_buffer_size;
+extern void *__hook_gpiod_line_request_release;
+extern void *__hook_gpiod_line_request_get_value;
+extern void *__hook_gpiod_line_request_get_fd;
+extern void *__hook_gpiod_line_request_wait_edge_events;
+extern void *__hook_gpiod_line_request_read_edge_events;
+extern void *__hook_gpiod_edge_event_buffer_new;
+extern void *__hook_gpiod_edge_event_buffer_get_capacity;
+extern void *__hook_gpiod_edge_event_buffer_free;
+
+struct gpiod_chip *__real_gpiod_chip_open(const char *path);
+void __real_gpiod_chip_close(struct gpiod_chip *chip);
+struct gpiod_line_request *__real_gpiod_chip_request_lines(struct gpiod_chip *chip, struct gpiod_request_config *req_cfg, struct gpiod_line_config *line_cfg);
+struct gpiod_line_settings *__real_gpiod_line_settings_new(void);
+void __real_gpiod_line_settings_free(struct gpiod_line_settings *settings);
+int __real_gpiod_line_settings_set_direction(struct gpiod_line_settings *settings, enum gpiod_line_direction direction);
+int __real_gpiod_line_settings_set_edge_detection(struct gpiod_line_settings *settings, enum gpiod_line_edge edge);
+void __real_gpiod_line_settings_set_active_low(struct gpiod_line_settings *settings, bool active_low);
+void __real_gpiod_line_settings_set_debounce_period_us(struct gpiod_line_settings *settings, unsigned long period);
+int __real_gpiod_line_settings_set_event_clock(struct gpiod_line_settings *settings, enum gpiod_line_clock event_clock);
+struct gpiod_line_config *__real_gpiod_line_config_new(void);
+void __real_gpiod_line_config_free(struct gpiod_line_config *config);
+int __real_gpiod_line_config_add_line_settings(struct gpiod_line_config *config, const unsigned int *offsets, size_t num_offsets, struct gpiod_line_settings *settings);
+struct gpiod_request_config *__real_gpiod_request_config_new(void);
+void __real_gpiod_request_config_free(struct gpiod_request_config *config);
+void __real_gpiod_request_config_set_consumer(struct gpiod_request_config *config, const char *consumer);
+void __real_gpiod_request_config_set_event_buffer_size(struct gpiod_request_config *config, size_t event_buffer_size);
+void __real_gpiod_line_request_release(struct gpiod_line_request *request);
+enum gpiod_line_value __real_gpiod_line_request_get_value(struct gpiod_line_request *request, unsigned int offset);
+int __real_gpiod_line_request_get_fd(struct gpiod_line_request *request);
+int __real_gpiod_line_request_wait_edge_events(struct gpiod_line_request *request, int64_t timeout_ns);
+int __real_gpiod_line_request_read_edge_events(struct gpiod_line_request *request, struct gpiod_edge_event_buffer *buffer, size_t max_events);
+struct gpiod_edge_event_buffer *__real_gpiod_edge_event_buffer_new(size_t capacity);
+size_t __real_gpiod_edge_event_buffer_get_capacity(struct gpiod_edge_event_buffer *buffer);
+void __real_gpiod_edge_event_buffer_free(struct gpiod_edge_event_buffer *buffer);
+#else
 extern void *__hook_gpiod_chip_open;
 extern void *__hook_gpiod_chip_close;
 extern void *__hook_gpiod_chip_get_line;
 extern void *__hook_gpiod_line_release;
 extern void *__hook_gpiod_line_request_input_flags;
 extern void *__hook_gpiod_line_get_value;
+extern void *__hook_gpiod_line_request_rising_edge_events_flags;
+extern void *__hook_gpiod_line_event_wait;
+extern void *__hook_gpiod_line_event_read;
+extern void *__hook_gpiod_line_event_read_multiple;
+extern void *__hook_gpiod_line_event_get_fd;
 
 struct gpiod_chip *__real_gpiod_chip_open(const char *path);
 void __real_gpiod_chip_close(struct gpiod_chip *chip);
@@ -55,17 +118,25 @@ struct gpiod_line *__real_gpiod_chip_get_line(struct gpiod_chip *chip, unsigned
 void __real_gpiod_line_release(struct gpiod_line *line);
 int __real_gpiod_line_request_input_flags(struct gpiod_line *line, const char *consumer, int flags);
 int __real_gpiod_line_get_value(struct gpiod_line *line);
+int __real_gpiod_line_request_rising_edge_events_flags(struct gpiod_line *line, const char *consumer, int flags);
+int __real_gpiod_line_event_wait(struct gpiod_line *line, const struct timespec *timeout);
+int __real_gpiod_line_event_read(struct gpiod_line *line, struct gpiod_line_event *event);
+int __real_gpiod_line_event_read_multiple(struct gpiod_line *line, struct gpiod_line_event *events, unsigned int num_events);
+int __real_gpiod_line_event_get_fd(struct gpiod_line *line);
+#endif
 
 /* libi2cd */
 extern void *__hook_i2cd_open;
 extern void *__hook_i2cd_close;
 extern void *__hook_i2cd_write;
 extern void *__hook_i2cd_write_read;
+extern void *__hook_i2cd_transfer;
 
 struct i2cd *__real_i2cd_open(const char *path);
 void __real_i2cd_close(struct i2cd *dev);
 int __real_i2cd_write(struct i2cd *dev, uint16_t addr, const void *buf, size_t len);
 int __real_i2cd_write_read(struct i2cd *dev, uint16_t addr,
 		const void *write_buf, size_t write_len, void *read_buf, size_t read_len);
+int __real_i2cd_transfer(struct i2cd *dev, struct i2c_msg *msgs, size_t nmsgs);
 
 #endif /* HOOKS_H */
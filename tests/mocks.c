@@ -17,11 +17,14 @@
  */
 
 #include "mocks.h"
+#include "hooks.h"
+#include "mcp23016-private.h"
 
 #include <setjmp.h>
 #include <stdarg.h>
 #include <stddef.h>
 #include <stdint.h>
+#include <linux/i2c.h>
 #include <string.h>
 #include <cmocka.h>
 #include <gpiod.h>
@@ -40,6 +43,173 @@ void mock_free(void *ptr)
 	check_expected_ptr(ptr);
 }
 
+#ifdef HAVE_GPIOD_V2
+struct gpiod_chip *mock_gpiod_chip_open(const char *path)
+{
+	check_expected(path);
+
+	return mock_type(struct gpiod_chip *);
+}
+
+void mock_gpiod_chip_close(struct gpiod_chip *chip)
+{
+	check_expected_ptr(chip);
+}
+
+struct gpiod_line_request *mock_gpiod_chip_request_lines(struct gpiod_chip *chip,
+		struct gpiod_request_config *req_cfg, struct gpiod_line_config *line_cfg)
+{
+	check_expected_ptr(chip);
+	check_expected_ptr(req_cfg);
+	check_expected_ptr(line_cfg);
+
+	return mock_type(struct gpiod_line_request *);
+}
+
+/* Settings and configuration objects are returned by the test; values set on
+ * them are recorded rather than checked so tests can inspect them afterwards.
+ */
+struct gpiod_line_settings *mock_gpiod_line_settings_new(void)
+{
+	return mock_type(struct gpiod_line_settings *);
+}
+
+void mock_gpiod_line_settings_free(struct gpiod_line_settings *settings)
+{
+	check_expected_ptr(settings);
+}
+
+int mock_gpiod_line_settings_set_direction(struct gpiod_line_settings *settings,
+		enum gpiod_line_direction direction)
+{
+	settings->direction = direction;
+	return 0;
+}
+
+int mock_gpiod_line_settings_set_edge_detection(struct gpiod_line_settings *settings,
+		enum gpiod_line_edge edge)
+{
+	settings->edge = edge;
+	return 0;
+}
+
+void mock_gpiod_line_settings_set_active_low(struct gpiod_line_settings *settings, bool active_low)
+{
+	settings->active_low = active_low;
+}
+
+void mock_gpiod_line_settings_set_debounce_period_us(struct gpiod_line_settings *settings,
+		unsigned long period)
+{
+	settings->debounce_period = period;
+}
+
+int mock_gpiod_line_settings_set_event_clock(struct gpiod_line_settings *settings,
+		enum gpiod_line_clock event_clock)
+{
+	settings->event_clock = event_clock;
+	return 0;
+}
+
+struct gpiod_line_config *mock_gpiod_line_config_new(void)
+{
+	return mock_type(struct gpiod_line_config *);
+}
+
+void mock_gpiod_line_config_free(struct gpiod_line_config *config)
+{
+	check_expected_ptr(config);
+}
+
+int mock_gpiod_line_config_add_line_settings(struct gpiod_line_config *config,
+		const unsigned int *offsets, size_t num_offsets, struct gpiod_line_settings *settings)
+{
+	check_expected(num_offsets);
+
+	config->offset = offsets[0];
+	config->settings = *settings;
+	return 0;
+}
+
+struct gpiod_request_config *mock_gpiod_request_config_new(void)
+{
+	return mock_type(struct gpiod_request_config *);
+}
+
+void mock_gpiod_request_config_free(struct gpiod_request_config *config)
+{
+	check_expected_ptr(config);
+}
+
+void mock_gpiod_request_config_set_consumer(struct gpiod_request_config *config,
+		const char *consumer)
+{
+	config->consumer = consumer;
+}
+
+void mock_gpiod_request_config_set_event_buffer_size(struct gpiod_request_config *config,
+		size_t event_buffer_size)
+{
+	config->event_buffer_size = event_buffer_size;
+}
+
+void mock_gpiod_line_request_release(struct gpiod_line_request *request)
+{
+	check_expected_ptr(request);
+}
+
+enum gpiod_line_value mock_gpiod_line_request_get_value(struct gpiod_line_request *request,
+		unsigned int offset)
+{
+	check_expected_ptr(request);
+	check_expected(offset);
+
+	return mock_type(enum gpiod_line_value);
+}
+
+int mock_gpiod_line_request_get_fd(struct gpiod_line_request *request)
+{
+	check_expected_ptr(request);
+
+	return mock_type(int);
+}
+
+int mock_gpiod_line_request_wait_edge_events(struct gpiod_line_request *request,
+		int64_t timeout_ns)
+{
+	check_expected_ptr(request);
+	check_expected(timeout_ns);
+
+	return mock_type(int);
+}
+
+int mock_gpiod_line_request_read_edge_events(struct gpiod_line_request *request,
+		struct gpiod_edge_event_buffer *buffer, size_t max_events)
+{
+	check_expected_ptr(request);
+	check_expected_ptr(buffer);
+	check_expected(max_events);
+
+	return mock_type(int);
+}
+
+struct gpiod_edge_event_buffer *mock_gpiod_edge_event_buffer_new(size_t capacity)
+{
+	check_expected(capacity);
+
+	return mock_type(struct gpiod_edge_event_buffer *);
+}
+
+size_t mock_gpiod_edge_event_buffer_get_capacity(struct gpiod_edge_event_buffer *buffer)
+{
+	return buffer->capacity;
+}
+
+void mock_gpiod_edge_event_buffer_free(struct gpiod_edge_event_buffer *buffer)
+{
+	check_expected_ptr(buffer);
+}
+#else
 struct gpiod_chip *mock_gpiod_chip_open(const char *path)
 {
 	check_expected(path);
@@ -81,6 +251,220 @@ int mock_gpiod_line_get_value(struct gpiod_line *line)
 	return mock_type(int);
 }
 
+int mock_gpiod_line_request_rising_edge_events_flags(struct gpiod_line *line, const char *consumer,
+		int flags)
+{
+	check_expected_ptr(line);
+	check_expected_ptr(consumer);
+	check_expected(flags);
+
+	return mock_type(int);
+}
+
+int mock_gpiod_line_event_wait(struct gpiod_line *line, const struct timespec *timeout)
+{
+	check_expected_ptr(line);
+	check_expected_ptr(timeout);
+
+	return mock_type(int);
+}
+
+int mock_gpiod_line_event_read(struct gpiod_line *line, struct gpiod_line_event *event)
+{
+	check_expected_ptr(line);
+	check_expected_ptr(event);
+
+	return mock_type(int);
+}
+
+int mock_gpiod_line_event_read_multiple(struct gpiod_line *line, struct gpiod_line_event *events,
+		unsigned int num_events)
+{
+	check_expected_ptr(line);
+	check_expected_ptr(events);
+	check_expected(num_events);
+
+	return mock_type(int);
+}
+
+int mock_gpiod_line_event_get_fd(struct gpiod_line *line)
+{
+	check_expected_ptr(line);
+
+	return mock_type(int);
+}
+#endif
+
+void hook_gpiod(void)
+{
+#ifdef HAVE_GPIOD_V2
+	hook(gpiod_chip_open, mock_gpiod_chip_open);
+	hook(gpiod_chip_close, mock_gpiod_chip_close);
+	hook(gpiod_chip_request_lines, mock_gpiod_chip_request_lines);
+	hook(gpiod_line_settings_new, mock_gpiod_line_settings_new);
+	hook(gpiod_line_settings_free, mock_gpiod_line_settings_free);
+	hook(gpiod_line_settings_set_direction, mock_gpiod_line_settings_set_direction);
+	hook(gpiod_line_settings_set_edge_detection, mock_gpiod_line_settings_set_edge_detection);
+	hook(gpiod_line_settings_set_active_low, mock_gpiod_line_settings_set_active_low);
+	hook(gpiod_line_settings_set_debounce_period_us, mock_gpiod_line_settings_set_debounce_period_us);
+	hook(gpiod_line_settings_set_event_clock, mock_gpiod_line_settings_set_event_clock);
+	hook(gpiod_line_config_new, mock_gpiod_line_config_new);
+	hook(gpiod_line_config_free, mock_gpiod_line_config_free);
+	hook(gpiod_line_config_add_line_settings, mock_gpiod_line_config_add_line_settings);
+	hook(gpiod_request_config_new, mock_gpiod_request_config_new);
+	hook(gpiod_request_config_free, mock_gpiod_request_config_free);
+	hook(gpiod_request_config_set_consumer, mock_gpiod_request_config_set_consumer);
+	hook(gpiod_request_config_set_event_buffer_size, mock_gpiod_request_config_set_event_buffer_size);
+	hook(gpiod_line_request_release, mock_gpiod_line_request_release);
+	hook(gpiod_line_request_get_value, mock_gpiod_line_request_get_value);
+	hook(gpiod_line_request_get_fd, mock_gpiod_line_request_get_fd);
+	hook(gpiod_line_request_wait_edge_events, mock_gpiod_line_request_wait_edge_events);
+	hook(gpiod_line_request_read_edge_events, mock_gpiod_line_request_read_edge_events);
+	hook(gpiod_edge_event_buffer_new, mock_gpiod_edge_event_buffer_new);
+	hook(gpiod_edge_event_buffer_get_capacity, mock_gpiod_edge_event_buffer_get_capacity);
+	hook(gpiod_edge_event_buffer_free, mock_gpiod_edge_event_buffer_free);
+#else
+	hook(gpiod_chip_open, mock_gpiod_chip_open);
+	hook(gpiod_chip_close, mock_gpiod_chip_close);
+	hook(gpiod_chip_get_line, mock_gpiod_chip_get_line);
+	hook(gpiod_line_release, mock_gpiod_line_release);
+	hook(gpiod_line_request_input_flags, mock_gpiod_line_request_input_flags);
+	hook(gpiod_line_get_value, mock_gpiod_line_get_value);
+	hook(gpiod_line_request_rising_edge_events_flags, mock_gpiod_line_request_rising_edge_events_flags);
+	hook(gpiod_line_event_wait, mock_gpiod_line_event_wait);
+	hook(gpiod_line_event_read, mock_gpiod_line_event_read);
+	hook(gpiod_line_event_read_multiple, mock_gpiod_line_event_read_multiple);
+	hook(gpiod_line_event_get_fd, mock_gpiod_line_event_get_fd);
+#endif
+}
+
+void unhook_gpiod(void)
+{
+#ifdef HAVE_GPIOD_V2
+	unhook(gpiod_chip_open);
+	unhook(gpiod_chip_close);
+	unhook(gpiod_chip_request_lines);
+	unhook(gpiod_line_settings_new);
+	unhook(gpiod_line_settings_free);
+	unhook(gpiod_line_settings_set_direction);
+	unhook(gpiod_line_settings_set_edge_detection);
+	unhook(gpiod_line_settings_set_active_low);
+	unhook(gpiod_line_settings_set_debounce_period_us);
+	unhook(gpiod_line_settings_set_event_clock);
+	unhook(gpiod_line_config_new);
+	unhook(gpiod_line_config_free);
+	unhook(gpiod_line_config_add_line_settings);
+	unhook(gpiod_request_config_new);
+	unhook(gpiod_request_config_free);
+	unhook(gpiod_request_config_set_consumer);
+	unhook(gpiod_request_config_set_event_buffer_size);
+	unhook(gpiod_line_request_release);
+	unhook(gpiod_line_request_get_value);
+	unhook(gpiod_line_request_get_fd);
+	unhook(gpiod_line_request_wait_edge_events);
+	unhook(gpiod_line_request_read_edge_events);
+	unhook(gpiod_edge_event_buffer_new);
+	unhook(gpiod_edge_event_buffer_get_capacity);
+	unhook(gpiod_edge_event_buffer_free);
+#else
+	unhook(gpiod_chip_open);
+	unhook(gpiod_chip_close);
+	unhook(gpiod_chip_get_line);
+	unhook(gpiod_line_release);
+	unhook(gpiod_line_request_input_flags);
+	unhook(gpiod_line_get_value);
+	unhook(gpiod_line_request_rising_edge_events_flags);
+	unhook(gpiod_line_event_wait);
+	unhook(gpiod_line_event_read);
+	unhook(gpiod_line_event_read_multiple);
+	unhook(gpiod_line_event_get_fd);
+#endif
+}
+
+void mock_interrupt_init(struct mcp23016_interrupt *intr, int flags)
+{
+#ifdef HAVE_GPIOD_V2
+	static struct gpiod_line_request mock_gpiod_line_request;
+	static struct gpiod_edge_event_buffer mock_gpiod_edge_event_buffer = {
+		.capacity = EVENT_CHUNK
+	};
+
+	intr->flags = flags;
+	intr->offset = 0;
+	intr->gpio_request = &mock_gpiod_line_request;
+	intr->gpio_events = (flags & MCP23016_INTERRUPT_EVENTS) ? &mock_gpiod_edge_event_buffer : NULL;
+#else
+	static struct gpiod_chip mock_gpiod_chip;
+	static struct gpiod_line mock_gpiod_line;
+
+	intr->flags = flags;
+	intr->gpio_chip = &mock_gpiod_chip;
+	intr->gpio_line = &mock_gpiod_line;
+#endif
+}
+
+void expect_interrupt_value(struct mcp23016_interrupt *intr, int value)
+{
+#ifdef HAVE_GPIOD_V2
+	expect_value(mock_gpiod_line_request_get_value, request, intr->gpio_request);
+	expect_value(mock_gpiod_line_request_get_value, offset, intr->offset);
+	will_return(mock_gpiod_line_request_get_value, value);
+#else
+	expect_value(mock_gpiod_line_get_value, line, intr->gpio_line);
+	will_return(mock_gpiod_line_get_value, value);
+#endif
+}
+
+static void expect_interrupt_read(struct mcp23016_interrupt *intr)
+{
+#ifdef HAVE_GPIOD_V2
+	expect_value(mock_gpiod_line_request_read_edge_events, request, intr->gpio_request);
+	expect_value(mock_gpiod_line_request_read_edge_events, buffer, intr->gpio_events);
+	expect_value(mock_gpiod_line_request_read_edge_events, max_events, 1);
+	will_return(mock_gpiod_line_request_read_edge_events, 1);
+#else
+	expect_value(mock_gpiod_line_event_read, line, intr->gpio_line);
+	expect_any(mock_gpiod_line_event_read, event);
+	will_return(mock_gpiod_line_event_read, 0);
+#endif
+}
+
+void expect_interrupt_wait(struct mcp23016_interrupt *intr, const struct timespec *timeout, int res)
+{
+#ifdef HAVE_GPIOD_V2
+	expect_value(mock_gpiod_line_request_wait_edge_events, request, intr->gpio_request);
+	if (timeout != NULL)
+		expect_value(mock_gpiod_line_request_wait_edge_events, timeout_ns,
+				timeout->tv_sec * 1000000000 + timeout->tv_nsec);
+	else
+		expect_value(mock_gpiod_line_request_wait_edge_events, timeout_ns, -1);
+	will_return(mock_gpiod_line_request_wait_edge_events, res);
+#else
+	expect_value(mock_gpiod_line_event_wait, line, intr->gpio_line);
+	expect_value(mock_gpiod_line_event_wait, timeout, timeout);
+	will_return(mock_gpiod_line_event_wait, res);
+#endif
+
+	if (res > 0)
+		expect_interrupt_read(intr);
+}
+
+void expect_interrupt_wait_any(struct mcp23016_interrupt *intr, int res)
+{
+#ifdef HAVE_GPIOD_V2
+	expect_value(mock_gpiod_line_request_wait_edge_events, request, intr->gpio_request);
+	expect_any(mock_gpiod_line_request_wait_edge_events, timeout_ns);
+	will_return(mock_gpiod_line_request_wait_edge_events, res);
+#else
+	expect_value(mock_gpiod_line_event_wait, line, intr->gpio_line);
+	expect_any(mock_gpiod_line_event_wait, timeout);
+	will_return(mock_gpiod_line_event_wait, res);
+#endif
+
+	if (res > 0)
+		expect_interrupt_read(intr);
+}
+
 struct i2cd *mock_i2cd_open(const char *path)
 {
 	check_expected(path);
@@ -120,3 +504,47 @@ int mock_i2cd_write_read(struct i2cd *dev, uint16_t addr,
 
 	return mock_type(int);
 }
+
+int mock_i2cd_transfer(struct i2cd *dev, struct i2c_msg *msgs, size_t nmsgs)
+{
+	size_t i;
+
+	check_expected_ptr(dev);
+	check_expected(nmsgs);
+
+	for (i = 0; i < nmsgs; i++) {
+		uint16_t addr = msgs[i].addr;
+		uint16_t flags = msgs[i].flags;
+		uint16_t len = msgs[i].len;
+		void *buf = msgs[i].buf;
+
+		check_expected(addr);
+		check_expected(flags);
+		check_expected(len);
+
+		if (flags & I2C_M_RD) {
+			void *mock_buf = mock_type(void *);
+			if (mock_buf != NULL)
+				memcpy(buf, mock_buf, len);
+		} else {
+			check_expected(buf);
+		}
+	}
+	return mock_type(int);
+}
+
+void expect_i2cd_transfer_write(uint16_t addr, const void *buf, size_t len)
+{
+	expect_value(mock_i2cd_transfer, addr, addr);
+	expect_value(mock_i2cd_transfer, flags, 0);
+	expect_value(mock_i2cd_transfer, len, len);
+	expect_memory(mock_i2cd_transfer, buf, buf, len);
+}
+
+void expect_i2cd_transfer_read(uint16_t addr, const void *buf, size_t len)
+{
+	expect_value(mock_i2cd_transfer, addr, addr);
+	expect_value(mock_i2cd_transfer, flags, I2C_M_RD);
+	expect_value(mock_i2cd_transfer, len, len);
+	will_return(mock_i2cd_transfer, buf); /* buf */
+}
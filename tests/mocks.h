@@ -19,8 +19,14 @@
 #ifndef MOCKS_H
 #define MOCKS_H
 
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
 #include <stddef.h>
 #include <stdint.h>
+#include <time.h>
+#include <linux/i2c.h>
 #include <gpiod.h>
 #include <i2cd.h>
 
@@ -29,6 +35,63 @@ void *mock_calloc(size_t nmemb, size_t size);
 void mock_free(void *ptr);
 
 /* libgpiod */
+#ifdef HAVE_GPIOD_V2
+struct gpiod_chip {
+	int dummy;
+};
+
+struct gpiod_line_settings {
+	enum gpiod_line_direction direction;
+	enum gpiod_line_edge edge;
+	bool active_low;
+	unsigned long debounce_period;
+	enum gpiod_line_clock event_clock;
+};
+
+struct gpiod_line_config {
+	unsigned int offset;
+	struct gpiod_line_settings settings;
+};
+
+struct gpiod_request_config {
+	const char *consumer;
+	size_t event_buffer_size;
+};
+
+struct gpiod_line_request {
+	int dummy;
+};
+
+struct gpiod_edge_event_buffer {
+	size_t capacity;
+};
+
+struct gpiod_chip *mock_gpiod_chip_open(const char *path);
+void mock_gpiod_chip_close(struct gpiod_chip *chip);
+struct gpiod_line_request *mock_gpiod_chip_request_lines(struct gpiod_chip *chip, struct gpiod_request_config *req_cfg, struct gpiod_line_config *line_cfg);
+struct gpiod_line_settings *mock_gpiod_line_settings_new(void);
+void mock_gpiod_line_settings_free(struct gpiod_line_settings *settings);
+int mock_gpiod_line_settings_set_direction(struct gpiod_line_settings *settings, enum gpiod_line_direction direction);
+int mock_gpiod_line_settings_set_edge_detection(struct gpiod_line_settings *settings, enum gpiod_line_edge edge);
+void mock_gpiod_line_settings_set_active_low(struct gpiod_line_settings *settings, bool active_low);
+void mock_gpiod_line_settings_set_debounce_period_us(struct gpiod_line_settings *settings, unsigned long period);
+int mock_gpiod_line_settings_set_event_clock(struct gpiod_line_settings *settings, enum gpiod_line_clock event_clock);
+struct gpiod_line_config *mock_gpiod_line_config_new(void);
+void mock_gpiod_line_config_free(struct gpiod_line_config *config);
+int mock_gpiod_line_config_add_line_settings(struct gpiod_line_config *config, const unsigned int *offsets, size_t num_offsets, struct gpiod_line_settings *settings);
+struct gpiod_request_config *mock_gpiod_request_config_new(void);
+void mock_gpiod_request_config_free(struct gpiod_request_config *config);
+void mock_gpiod_request_config_set_consumer(struct gpiod_request_config *config, const char *consumer);
+void mock_gpiod_request_config_set_event_buffer_size(struct gpiod_request_config *config, size_t event_buffer_size);
+void mock_gpiod_line_request_release(struct gpiod_line_request *request);
+enum gpiod_line_value mock_gpiod_line_request_get_value(struct gpiod_line_request *request, unsigned int offset);
+int mock_gpiod_line_request_get_fd(struct gpiod_line_request *request);
+int mock_gpiod_line_request_wait_edge_events(struct gpiod_line_request *request, int64_t timeout_ns);
+int mock_gpiod_line_request_read_edge_events(struct gpiod_line_request *request, struct gpiod_edge_event_buffer *buffer, size_t max_events);
+struct gpiod_edge_event_buffer *mock_gpiod_edge_event_buffer_new(size_t capacity);
+size_t mock_gpiod_edge_event_buffer_get_capacity(struct gpiod_edge_event_buffer *buffer);
+void mock_gpiod_edge_event_buffer_free(struct gpiod_edge_event_buffer *buffer);
+#else
 struct gpiod_chip {
 	int dummy;
 };
@@ -43,6 +106,22 @@ struct gpiod_line *mock_gpiod_chip_get_line(struct gpiod_chip *chip, unsigned in
 void mock_gpiod_line_release(struct gpiod_line *line);
 int mock_gpiod_line_request_input_flags(struct gpiod_line *line, const char *consumer, int flags);
 int mock_gpiod_line_get_value(struct gpiod_line *line);
+int mock_gpiod_line_request_rising_edge_events_flags(struct gpiod_line *line, const char *consumer, int flags);
+int mock_gpiod_line_event_wait(struct gpiod_line *line, const struct timespec *timeout);
+int mock_gpiod_line_event_read(struct gpiod_line *line, struct gpiod_line_event *event);
+int mock_gpiod_line_event_read_multiple(struct gpiod_line *line, struct gpiod_line_event *events, unsigned int num_events);
+int mock_gpiod_line_event_get_fd(struct gpiod_line *line);
+#endif
+
+/* Interrupt helpers independent of the libgpiod version */
+struct mcp23016_interrupt;
+
+void hook_gpiod(void);
+void unhook_gpiod(void);
+void mock_interrupt_init(struct mcp23016_interrupt *intr, int flags);
+void expect_interrupt_value(struct mcp23016_interrupt *intr, int value);
+void expect_interrupt_wait(struct mcp23016_interrupt *intr, const struct timespec *timeout, int res);
+void expect_interrupt_wait_any(struct mcp23016_interrupt *intr, int res);
 
 /* libi2cd */
 struct i2cd {
@@ -54,5 +133,9 @@ void mock_i2cd_close(struct i2cd *dev);
 int mock_i2cd_write(struct i2cd *dev, uint16_t addr, const void *buf, size_t len);
 int mock_i2cd_write_read(struct i2cd *dev, uint16_t addr,
 		const void *write_buf, size_t write_len, void *read_buf, size_t read_len);
+int mock_i2cd_transfer(struct i2cd *dev, struct i2c_msg *msgs, size_t nmsgs);
+
+void expect_i2cd_transfer_write(uint16_t addr, const void *buf, size_t len);
+void expect_i2cd_transfer_read(uint16_t addr, const void *buf, size_t len);
 
 #endif /* MOCKS_H */
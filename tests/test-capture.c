@@ -0,0 +1,341 @@
+/* SPDX-License-Identifier: LGPL-2.1-or-later */
+/*
+ * Copyright (C) 2021 Steven Stallion <sstallion@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mcp23016-private.h"
+
+#include <errno.h>
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <cmocka.h>
+
+static char path[] = "/tmp/test-capture-XXXXXX";
+
+int setup(void **state)
+{
+	int fd;
+
+	fd = mkstemp(path);
+	if (fd < 0)
+		return -1;
+
+	close(fd);
+	return 0;
+}
+
+int teardown(void **state)
+{
+	unlink(path);
+	return 0;
+}
+
+static const struct mcp23016_capture_info capture_info = {
+	.devices = {0, 3, 7},
+	.num_devices = 3,
+	.period = 1000000,
+	.clock = CLOCK_MONOTONIC,
+	.capacity = 4
+};
+
+static void make_vals(uint16_t *vals, unsigned int n)
+{
+	vals[0] = n;
+	vals[1] = ~n;
+	vals[2] = n << 8;
+}
+
+static void assert_record_equal(struct mcp23016_capture *cap, uint64_t index, unsigned int n)
+{
+	uint16_t vals[MCP23016_DEVICE_MAX];
+	uint64_t timestamp;
+	int rc;
+
+	rc = mcp23016_capture_read(cap, index, &timestamp, vals);
+
+	assert_return_code(rc, 0);
+	assert_int_equal(timestamp, 1000000 * n);
+	assert_int_equal(vals[0], (uint16_t)n);
+	assert_int_equal(vals[1], (uint16_t)~n);
+	assert_int_equal(vals[2], (uint16_t)(n << 8));
+}
+
+void test_mcp23016_capture_create(void **state)
+{
+	struct mcp23016_capture_info info;
+	struct mcp23016_capture *cap;
+
+	/* Check behavior when function succeeds */
+	cap = mcp23016_capture_create(path, &capture_info);
+
+	assert_non_null(cap);
+	assert_int_equal(cap->record_size, 16);
+	assert_int_equal(cap->size, sizeof(struct capture_header) + 4 * 16);
+	assert_int_equal(mcp23016_capture_count(cap), 0);
+
+	mcp23016_capture_get_info(cap, &info);
+
+	assert_memory_equal(&info, &capture_info, sizeof(info));
+
+	mcp23016_capture_close(cap);
+}
+
+void test_mcp23016_capture_create_invalid(void **state)
+{
+	struct mcp23016_capture_info info = capture_info;
+	struct mcp23016_capture *cap;
+
+	info.num_devices = 0;
+
+	/* Check behavior when no devices are given */
+	cap = mcp23016_capture_create(path, &info);
+
+	assert_null(cap);
+	assert_int_equal(errno, EINVAL);
+
+	info.num_devices = 3;
+	info.devices[2] = MCP23016_DEVICE_MAX;
+
+	/* Check behavior when device position is invalid */
+	cap = mcp23016_capture_create(path, &info);
+
+	assert_null(cap);
+	assert_int_equal(errno, EINVAL);
+
+	info.devices[2] = 7;
+	info.capacity = 0;
+
+	/* Check behavior when capacity is zero */
+	cap = mcp23016_capture_create(path, &info);
+
+	assert_null(cap);
+	assert_int_equal(errno, EINVAL);
+}
+
+void test_mcp23016_capture_append(void **state)
+{
+	struct mcp23016_capture *cap;
+	uint16_t vals[MCP23016_DEVICE_MAX];
+	uint64_t timestamp;
+	unsigned int n;
+	int rc;
+
+	cap = mcp23016_capture_create(path, &capture_info);
+	assert_non_null(cap);
+
+	/* Check behavior when function succeeds */
+	for (n = 0; n < 4; n++) {
+		make_vals(vals, n);
+		rc = mcp23016_capture_append(cap, 1000000 * n, vals);
+
+		assert_return_code(rc, 0);
+		assert_int_equal(mcp23016_capture_count(cap), n + 1);
+	}
+
+	for (n = 0; n < 4; n++)
+		assert_record_equal(cap, n, n);
+
+	/* Check behavior when capture file is full */
+	rc = mcp23016_capture_append(cap, 0, vals);
+
+	assert_int_equal(rc, -1);
+	assert_int_equal(errno, ENOSPC);
+	assert_int_equal(mcp23016_capture_count(cap), 4);
+
+	/* Check behavior when index is out of range */
+	rc = mcp23016_capture_read(cap, 4, &timestamp, vals);
+
+	assert_int_equal(rc, -1);
+	assert_int_equal(errno, ERANGE);
+
+	mcp23016_capture_close(cap);
+}
+
+void test_mcp23016_capture_append_wrap(void **state)
+{
+	struct mcp23016_capture_info info = capture_info;
+	struct mcp23016_capture *cap;
+	uint16_t vals[MCP23016_DEVICE_MAX];
+	unsigned int n;
+	int rc;
+
+	info.flags = MCP23016_CAPTURE_WRAP;
+
+	cap = mcp23016_capture_create(path, &info);
+	assert_non_null(cap);
+
+	/* Check behavior when oldest records are overwritten */
+	for (n = 0; n < 10; n++) {
+		make_vals(vals, n);
+		rc = mcp23016_capture_append(cap, 1000000 * n, vals);
+
+		assert_return_code(rc, 0);
+	}
+
+	assert_int_equal(mcp23016_capture_count(cap), 4);
+	assert_int_equal(atomic_load(&cap->hdr->count), 10);
+
+	for (n = 0; n < 4; n++)
+		assert_record_equal(cap, n, n + 6);
+
+	mcp23016_capture_close(cap);
+}
+
+void test_mcp23016_capture_read_record(void **state)
+{
+	struct mcp23016_capture_info info = capture_info;
+	struct mcp23016_capture *cap;
+	uint16_t vals[MCP23016_DEVICE_MAX];
+	uint64_t timestamp;
+	unsigned int n;
+	int rc;
+
+	info.flags = MCP23016_CAPTURE_WRAP;
+
+	cap = mcp23016_capture_create(path, &info);
+	assert_non_null(cap);
+
+	for (n = 0; n < 6; n++) {
+		make_vals(vals, n);
+		mcp23016_capture_append(cap, 1000000 * n, vals);
+	}
+
+	assert_int_equal(mcp23016_capture_first(cap), 2);
+
+	/* Check behavior when function succeeds */
+	rc = mcp23016_capture_read_record(cap, 3, &timestamp, vals);
+
+	assert_return_code(rc, 0);
+	assert_int_equal(timestamp, 3000000);
+	assert_int_equal(vals[0], 3);
+
+	/* Check behavior when records are appended between reads */
+	make_vals(vals, 6);
+	mcp23016_capture_append(cap, 6000000, vals);
+
+	rc = mcp23016_capture_read_record(cap, 4, &timestamp, vals);
+
+	assert_return_code(rc, 0);
+	assert_int_equal(timestamp, 4000000);
+	assert_int_equal(vals[0], 4);
+
+	/* Check behavior when record was overwritten */
+	rc = mcp23016_capture_read_record(cap, 2, &timestamp, vals);
+
+	assert_int_equal(rc, -1);
+	assert_int_equal(errno, EAGAIN);
+
+	/* Check behavior when record has not been appended */
+	rc = mcp23016_capture_read_record(cap, 7, &timestamp, vals);
+
+	assert_int_equal(rc, -1);
+	assert_int_equal(errno, ERANGE);
+
+	mcp23016_capture_close(cap);
+}
+
+void test_mcp23016_capture_open(void **state)
+{
+	struct mcp23016_capture_info info;
+	struct mcp23016_capture *cap;
+	uint16_t vals[MCP23016_DEVICE_MAX];
+	unsigned int n;
+	int rc;
+
+	cap = mcp23016_capture_create(path, &capture_info);
+	assert_non_null(cap);
+
+	for (n = 0; n < 3; n++) {
+		make_vals(vals, n);
+		mcp23016_capture_append(cap, 1000000 * n, vals);
+	}
+
+	mcp23016_capture_close(cap);
+
+	/* Check behavior when function succeeds */
+	cap = mcp23016_capture_open(path);
+
+	assert_non_null(cap);
+	assert_int_equal(mcp23016_capture_count(cap), 3);
+
+	mcp23016_capture_get_info(cap, &info);
+
+	assert_memory_equal(&info, &capture_info, sizeof(info));
+
+	for (n = 0; n < 3; n++)
+		assert_record_equal(cap, n, n);
+
+	/* Check behavior when capture file is read-only */
+	rc = mcp23016_capture_append(cap, 0, vals);
+
+	assert_int_equal(rc, -1);
+	assert_int_equal(errno, EBADF);
+
+	mcp23016_capture_close(cap);
+}
+
+void test_mcp23016_capture_open_invalid(void **state)
+{
+	struct capture_header hdr;
+	struct mcp23016_capture *cap;
+	FILE *fp;
+
+	memset(&hdr, 0, sizeof(hdr));
+	memcpy(hdr.magic, "MCP23017", sizeof(hdr.magic));
+
+	fp = fopen(path, "w");
+	assert_non_null(fp);
+	fwrite(&hdr, sizeof(hdr), 1, fp);
+	fclose(fp);
+
+	/* Check behavior when magic is invalid */
+	cap = mcp23016_capture_open(path);
+
+	assert_null(cap);
+	assert_int_equal(errno, EINVAL);
+
+	cap = mcp23016_capture_create(path, &capture_info);
+	assert_non_null(cap);
+	mcp23016_capture_close(cap);
+
+	assert_return_code(truncate(path, sizeof(hdr) + 16), 0);
+
+	/* Check behavior when capture file is truncated */
+	cap = mcp23016_capture_open(path);
+
+	assert_null(cap);
+	assert_int_equal(errno, EINVAL);
+}
+
+int main(void)
+{
+	const struct CMUnitTest tests[] = {
+		cmocka_unit_test(test_mcp23016_capture_create),
+		cmocka_unit_test(test_mcp23016_capture_create_invalid),
+		cmocka_unit_test(test_mcp23016_capture_append),
+		cmocka_unit_test(test_mcp23016_capture_append_wrap),
+		cmocka_unit_test(test_mcp23016_capture_read_record),
+		cmocka_unit_test(test_mcp23016_capture_open),
+		cmocka_unit_test(test_mcp23016_capture_open_invalid)
+	};
+
+	return cmocka_run_group_tests(tests, setup, teardown);
+}
@@ -0,0 +1,234 @@
+/* SPDX-License-Identifier: LGPL-2.1-or-later */
+/*
+ * Copyright (C) 2021 Steven Stallion <sstallion@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mcp23016-private.h"
+
+#include <errno.h>
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <cmocka.h>
+
+#include "hooks.h"
+#include "mocks.h"
+
+#define PERIOD	1000	/* 1us */
+
+int setup(void **state)
+{
+	hook(calloc, mock_calloc);
+	hook(free, mock_free);
+	return 0;
+}
+
+int teardown(void **state)
+{
+	unhook(calloc);
+	unhook(free);
+	return 0;
+}
+
+void test_mcp23016_debounce_create(void **state)
+{
+	struct mcp23016_debounce mock_db = {0};
+	struct mcp23016_debounce *db;
+
+	expect_value(mock_calloc, nmemb, 1);
+	expect_value(mock_calloc, size, sizeof(mock_db));
+	will_return(mock_calloc, &mock_db);
+
+	/* Check behavior when function succeeds */
+	db = mcp23016_debounce_create(0x1234, PERIOD);
+
+	assert_non_null(db);
+	assert_int_equal(mcp23016_debounce_get_state(db), 0x1234);
+	assert_int_equal(mcp23016_debounce_get_pending(db), 0);
+	assert_int_equal(db->period, PERIOD);
+}
+
+void test_mcp23016_debounce_create_invalid(void **state)
+{
+	struct mcp23016_debounce *db;
+
+	/* Check behavior when period is zero */
+	db = mcp23016_debounce_create(0, 0);
+
+	assert_null(db);
+	assert_int_equal(errno, EINVAL);
+}
+
+void test_mcp23016_debounce_create_fail_calloc(void **state)
+{
+	struct mcp23016_debounce *db;
+
+	expect_any(mock_calloc, nmemb);
+	expect_any(mock_calloc, size);
+	will_return(mock_calloc, NULL);
+
+	/* Check behavior when calloc() fails */
+	db = mcp23016_debounce_create(0, PERIOD);
+
+	assert_null(db);
+}
+
+void test_mcp23016_debounce_destroy(void **state)
+{
+	struct mcp23016_debounce mock_db = {0};
+
+	expect_value(mock_free, ptr, &mock_db);
+
+	/* Check behavior when function succeeds */
+	mcp23016_debounce_destroy(&mock_db);
+}
+
+void test_mcp23016_debounce_set_window(void **state)
+{
+	struct mcp23016_debounce mock_db = {.period = PERIOD};
+	int rc;
+
+	/* Check behavior when window is a multiple of period */
+	rc = mcp23016_debounce_set_window(&mock_db, 0x00ff, 5 * PERIOD);
+
+	assert_return_code(rc, 0);
+	assert_int_equal(mock_db.window[0], 0x00ff);
+	assert_int_equal(mock_db.window[1], 0x0000);
+	assert_int_equal(mock_db.window[2], 0x00ff);
+
+	/* Check behavior when window is rounded up */
+	rc = mcp23016_debounce_set_window(&mock_db, 0x0f00, 2 * PERIOD + 1);
+
+	assert_return_code(rc, 0);
+	assert_int_equal(mock_db.window[0], 0x0fff);
+	assert_int_equal(mock_db.window[1], 0x0f00);
+	assert_int_equal(mock_db.window[2], 0x00ff);
+
+	/* Check behavior when window exceeds maximum */
+	rc = mcp23016_debounce_set_window(&mock_db, 0x00ff, (MCP23016_DEBOUNCE_MAX + 1) * PERIOD);
+
+	assert_int_equal(rc, -1);
+	assert_int_equal(errno, EINVAL);
+	assert_int_equal(mock_db.window[0], 0x0fff);
+}
+
+void test_mcp23016_debounce_update(void **state)
+{
+	struct mcp23016_debounce mock_db = {.period = PERIOD};
+	uint16_t changed;
+	int i;
+
+	mcp23016_debounce_set_window(&mock_db, 0x0001, 3 * PERIOD);
+	mcp23016_debounce_set_window(&mock_db, 0x0002, MCP23016_DEBOUNCE_MAX * PERIOD);
+
+	/* Check behavior when pin with no window changes */
+	changed = mcp23016_debounce_update(&mock_db, 0x8000);
+
+	assert_int_equal(changed, 0x8000);
+	assert_int_equal(mcp23016_debounce_get_state(&mock_db), 0x8000);
+
+	/* Check behavior when pin bounces */
+	changed = mcp23016_debounce_update(&mock_db, 0x8001);
+	assert_int_equal(changed, 0);
+	changed = mcp23016_debounce_update(&mock_db, 0x8001);
+	assert_int_equal(changed, 0);
+	changed = mcp23016_debounce_update(&mock_db, 0x8000);
+	assert_int_equal(changed, 0);
+	assert_int_equal(mcp23016_debounce_get_pending(&mock_db), 0);
+
+	/* Check behavior when pin is stable for window */
+	changed = mcp23016_debounce_update(&mock_db, 0x8001);
+	assert_int_equal(changed, 0);
+	changed = mcp23016_debounce_update(&mock_db, 0x8001);
+	assert_int_equal(changed, 0);
+	assert_int_equal(mcp23016_debounce_get_pending(&mock_db), 0x0001);
+	changed = mcp23016_debounce_update(&mock_db, 0x8001);
+	assert_int_equal(changed, 0x0001);
+	assert_int_equal(mcp23016_debounce_get_state(&mock_db), 0x8001);
+	assert_int_equal(mcp23016_debounce_get_pending(&mock_db), 0);
+
+	/* Check behavior when pin has maximum window */
+	for (i = 1; i < MCP23016_DEBOUNCE_MAX; i++) {
+		changed = mcp23016_debounce_update(&mock_db, 0x8003);
+		assert_int_equal(changed, 0);
+	}
+	changed = mcp23016_debounce_update(&mock_db, 0x8003);
+	assert_int_equal(changed, 0x0002);
+	assert_int_equal(mcp23016_debounce_get_state(&mock_db), 0x8003);
+}
+
+void test_mcp23016_debounce_update_at(void **state)
+{
+	struct mcp23016_debounce mock_db = {.period = PERIOD};
+	uint16_t changed;
+
+	mcp23016_debounce_set_window(&mock_db, 0x00ff, 10 * PERIOD);
+	mcp23016_debounce_set_window(&mock_db, 0xff00, MCP23016_DEBOUNCE_MAX * PERIOD);
+
+	/* Check behavior when pins change */
+	changed = mcp23016_debounce_update_at(&mock_db, 0x0101, 100 * PERIOD);
+
+	assert_int_equal(changed, 0);
+	assert_int_equal(mcp23016_debounce_get_pending(&mock_db), 0x0101);
+
+	/* Check behavior when window has not elapsed */
+	changed = mcp23016_debounce_update_at(&mock_db, 0x0101, 109 * PERIOD);
+
+	assert_int_equal(changed, 0);
+
+	/* Check behavior when window has elapsed */
+	changed = mcp23016_debounce_update_at(&mock_db, 0x0101, 110 * PERIOD);
+
+	assert_int_equal(changed, 0x0001);
+	assert_int_equal(mcp23016_debounce_get_pending(&mock_db), 0x0100);
+
+	/* Check behavior when pin bounces before window elapses */
+	changed = mcp23016_debounce_update_at(&mock_db, 0x0001, 200 * PERIOD);
+
+	assert_int_equal(changed, 0);
+	assert_int_equal(mcp23016_debounce_get_pending(&mock_db), 0);
+
+	/* Check behavior when elapsed time exceeds maximum window */
+	changed = mcp23016_debounce_update_at(&mock_db, 0x8001, 201 * PERIOD);
+
+	assert_int_equal(changed, 0);
+
+	changed = mcp23016_debounce_update_at(&mock_db, 0x8001, 100000 * PERIOD);
+
+	assert_int_equal(changed, 0x8000);
+	assert_int_equal(mcp23016_debounce_get_state(&mock_db), 0x8001);
+
+	/* Check behavior when time does not advance */
+	changed = mcp23016_debounce_update_at(&mock_db, 0x8000, 50 * PERIOD);
+
+	assert_int_equal(changed, 0);
+	assert_int_equal(mcp23016_debounce_get_pending(&mock_db), 0x0001);
+}
+
+int main(void)
+{
+	const struct CMUnitTest tests[] = {
+		cmocka_unit_test(test_mcp23016_debounce_create),
+		cmocka_unit_test(test_mcp23016_debounce_create_invalid),
+		cmocka_unit_test(test_mcp23016_debounce_create_fail_calloc),
+		cmocka_unit_test(test_mcp23016_debounce_destroy),
+		cmocka_unit_test(test_mcp23016_debounce_set_window),
+		cmocka_unit_test(test_mcp23016_debounce_update),
+		cmocka_unit_test(test_mcp23016_debounce_update_at)
+	};
+
+	return cmocka_run_group_tests(tests, setup, teardown);
+}
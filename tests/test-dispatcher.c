@@ -0,0 +1,638 @@
+/* SPDX-License-Identifier: LGPL-2.1-or-later */
+/*
+ * Copyright (C) 2021 Steven Stallion <sstallion@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mcp23016-private.h"
+
+#include <errno.h>
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <cmocka.h>
+#include <gpiod.h>
+#include <i2cd.h>
+
+#include "hooks.h"
+#include "mocks.h"
+
+int setup(void **state)
+{
+	hook(calloc, mock_calloc);
+	hook(free, mock_free);
+	hook_gpiod();
+	hook(i2cd_open, mock_i2cd_open);
+	hook(i2cd_close, mock_i2cd_close);
+	hook(i2cd_write, mock_i2cd_write);
+	hook(i2cd_write_read, mock_i2cd_write_read);
+	hook(i2cd_transfer, mock_i2cd_transfer);
+	return 0;
+}
+
+int teardown(void **state)
+{
+	unhook(calloc);
+	unhook(free);
+	unhook_gpiod();
+	unhook(i2cd_open);
+	unhook(i2cd_close);
+	unhook(i2cd_write);
+	unhook(i2cd_write_read);
+	unhook(i2cd_transfer);
+	return 0;
+}
+
+struct handler_call {
+	unsigned int pin;
+	enum mcp23016_edge edge;
+	uint16_t rising;
+	uint16_t falling;
+};
+
+struct handler_calls {
+	struct handler_call calls[16];
+	size_t n;
+};
+
+static void pin_handler(struct mcp23016_device *dev, unsigned int pin,
+		enum mcp23016_edge edge, void *arg)
+{
+	struct handler_calls *calls = arg;
+
+	calls->calls[calls->n].pin = pin;
+	calls->calls[calls->n].edge = edge;
+	calls->n++;
+}
+
+static void mask_handler(struct mcp23016_device *dev, uint16_t rising,
+		uint16_t falling, void *arg)
+{
+	struct handler_calls *calls = arg;
+
+	calls->calls[calls->n].rising = rising;
+	calls->calls[calls->n].falling = falling;
+	calls->n++;
+}
+
+static void expect_register_read(struct mcp23016_device *dev, uint8_t reg, uint8_t *mock_read_buf)
+{
+	static uint8_t mock_write_bufs[REG_IOCON1 + 1][1] = {
+		{REG_GP0}, {REG_GP1}, {REG_OLAT0}, {REG_OLAT1}, {REG_IPOL0}, {REG_IPOL1},
+		{REG_IODIR0}, {REG_IODIR1}, {REG_INTCAP0}, {REG_INTCAP1}, {REG_IOCON0}, {REG_IOCON1}
+	};
+
+	expect_value(mock_i2cd_write_read, dev, dev->i2c_dev);
+	expect_value(mock_i2cd_write_read, addr, dev->i2c_addr);
+	expect_memory(mock_i2cd_write_read, write_buf, mock_write_bufs[reg], 1);
+	expect_value(mock_i2cd_write_read, write_len, 1);
+	will_return(mock_i2cd_write_read, mock_read_buf); /* read_buf */
+	expect_value(mock_i2cd_write_read, read_len, 2);
+	will_return(mock_i2cd_write_read, mock_read_buf != NULL ? 0 : -1);
+}
+
+static void expect_service_interrupt(struct mcp23016_device *dev, uint8_t *mock_intcap_buf,
+		uint8_t *mock_gp_buf, int rc)
+{
+	static uint8_t mock_intcap_reg = REG_INTCAP0;
+	static uint8_t mock_gp_reg = REG_GP0;
+
+	expect_value(mock_i2cd_transfer, dev, dev->i2c_dev);
+	expect_value(mock_i2cd_transfer, nmsgs, 4);
+	expect_i2cd_transfer_write(dev->i2c_addr, &mock_intcap_reg, 1);
+	expect_i2cd_transfer_read(dev->i2c_addr, mock_intcap_buf, 2);
+	expect_i2cd_transfer_write(dev->i2c_addr, &mock_gp_reg, 1);
+	expect_i2cd_transfer_read(dev->i2c_addr, mock_gp_buf, 2);
+	will_return(mock_i2cd_transfer, rc);
+}
+
+void test_mcp23016_dispatcher_create(void **state)
+{
+	struct mcp23016_device mock_dev = {
+		.i2c_addr = BASE_ADDR,
+		.i2c_dev = &(struct i2cd){0}
+	};
+	struct mcp23016_interrupt mock_intr = {0};
+	struct mcp23016_dispatcher mock_disp = {0};
+	uint8_t mock_read_buf[] = {0x55, 0xaa};
+	struct mcp23016_dispatcher *disp;
+
+	expect_value(mock_calloc, nmemb, 1);
+	expect_value(mock_calloc, size, sizeof(mock_disp));
+	will_return(mock_calloc, &mock_disp);
+
+	expect_register_read(&mock_dev, REG_GP0, mock_read_buf);
+
+	/* Check behavior when function succeeds */
+	disp = mcp23016_dispatcher_create(&mock_dev, &mock_intr);
+
+	assert_non_null(disp);
+	assert_ptr_equal(disp->dev, &mock_dev);
+	assert_ptr_equal(disp->intr, &mock_intr);
+	assert_int_equal(disp->state.current, 0xaa55);
+}
+
+void test_mcp23016_dispatcher_create_fail_calloc(void **state)
+{
+	struct mcp23016_device mock_dev = {
+		.i2c_addr = BASE_ADDR,
+		.i2c_dev = &(struct i2cd){0}
+	};
+	struct mcp23016_dispatcher *disp;
+
+	expect_any(mock_calloc, nmemb);
+	expect_any(mock_calloc, size);
+	will_return(mock_calloc, NULL);
+
+	/* Check behavior when calloc() fails */
+	disp = mcp23016_dispatcher_create(&mock_dev, NULL);
+
+	assert_null(disp);
+}
+
+void test_mcp23016_dispatcher_create_fail_port(void **state)
+{
+	struct mcp23016_device mock_dev = {
+		.i2c_addr = BASE_ADDR,
+		.i2c_dev = &(struct i2cd){0}
+	};
+	struct mcp23016_dispatcher mock_disp = {0};
+	struct mcp23016_dispatcher *disp;
+
+	expect_any(mock_calloc, nmemb);
+	expect_any(mock_calloc, size);
+	will_return(mock_calloc, &mock_disp);
+
+	expect_register_read(&mock_dev, REG_GP0, NULL);
+
+	expect_value(mock_free, ptr, &mock_disp);
+
+	/* Check behavior when mcp23016_get_port() fails */
+	disp = mcp23016_dispatcher_create(&mock_dev, NULL);
+
+	assert_null(disp);
+}
+
+void test_mcp23016_dispatcher_destroy(void **state)
+{
+	struct mcp23016_dispatcher mock_disp = {0};
+
+	expect_value(mock_free, ptr, &mock_disp);
+
+	/* Check behavior when function succeeds */
+	mcp23016_dispatcher_destroy(&mock_disp);
+}
+
+void test_mcp23016_dispatcher_set_pin_handler(void **state)
+{
+	struct mcp23016_dispatcher mock_disp = {0};
+	int arg, rc;
+
+	/* Check behavior when handler is set */
+	rc = mcp23016_dispatcher_set_pin_handler(&mock_disp, 15, MCP23016_EDGE_BOTH,
+			pin_handler, &arg);
+
+	assert_return_code(rc, 0);
+	assert_ptr_equal(mock_disp.pin_handlers[15].fn, pin_handler);
+	assert_ptr_equal(mock_disp.pin_handlers[15].arg, &arg);
+	assert_int_equal(mock_disp.rising_pins, 0x8000);
+	assert_int_equal(mock_disp.falling_pins, 0x8000);
+
+	/* Check behavior when edges are changed */
+	rc = mcp23016_dispatcher_set_pin_handler(&mock_disp, 15, MCP23016_EDGE_FALLING,
+			pin_handler, &arg);
+
+	assert_return_code(rc, 0);
+	assert_int_equal(mock_disp.rising_pins, 0x0000);
+	assert_int_equal(mock_disp.falling_pins, 0x8000);
+
+	/* Check behavior when handler is removed */
+	rc = mcp23016_dispatcher_set_pin_handler(&mock_disp, 15, MCP23016_EDGE_BOTH, NULL, NULL);
+
+	assert_return_code(rc, 0);
+	assert_null(mock_disp.pin_handlers[15].fn);
+	assert_int_equal(mock_disp.rising_pins, 0x0000);
+	assert_int_equal(mock_disp.falling_pins, 0x0000);
+
+	/* Check behavior when pin invalid */
+	rc = mcp23016_dispatcher_set_pin_handler(&mock_disp, 16, MCP23016_EDGE_BOTH,
+			pin_handler, &arg);
+
+	assert_int_equal(rc, -1);
+	assert_int_equal(errno, EINVAL);
+}
+
+void test_mcp23016_dispatcher_add_mask_handler(void **state)
+{
+	struct mcp23016_dispatcher mock_disp = {0};
+	size_t i;
+	int rc;
+
+	for (i = 0; i < MCP23016_MASK_HANDLER_MAX; i++) {
+		rc = mcp23016_dispatcher_add_mask_handler(&mock_disp, 0x00ff, MCP23016_EDGE_RISING,
+				mask_handler, NULL);
+
+		assert_return_code(rc, 0);
+	}
+
+	assert_int_equal(mock_disp.num_mask_handlers, MCP23016_MASK_HANDLER_MAX);
+	assert_int_equal(mock_disp.mask_handlers[0].rising, 0x00ff);
+	assert_int_equal(mock_disp.mask_handlers[0].falling, 0x0000);
+
+	/* Check behavior when no space remains */
+	rc = mcp23016_dispatcher_add_mask_handler(&mock_disp, 0x00ff, MCP23016_EDGE_RISING,
+			mask_handler, NULL);
+
+	assert_int_equal(rc, -1);
+	assert_int_equal(errno, ENOSPC);
+}
+
+void test_mcp23016_dispatcher_dispatch(void **state)
+{
+	struct mcp23016_device mock_dev = {
+		.i2c_addr = BASE_ADDR,
+		.i2c_dev = &(struct i2cd){0}
+	};
+	struct mcp23016_dispatcher mock_disp = {
+		.dev = &mock_dev,
+		.state.current = 0x00ff
+	};
+	struct handler_calls pin_calls = {0}, mask_calls = {0};
+	uint8_t mock_read_buf[] = {0x0f, 0x0f};
+	int rc;
+
+	mcp23016_dispatcher_set_pin_handler(&mock_disp, 4, MCP23016_EDGE_BOTH,
+			pin_handler, &pin_calls);
+	mcp23016_dispatcher_set_pin_handler(&mock_disp, 8, MCP23016_EDGE_RISING,
+			pin_handler, &pin_calls);
+	mcp23016_dispatcher_set_pin_handler(&mock_disp, 9, MCP23016_EDGE_FALLING,
+			pin_handler, &pin_calls);
+	mcp23016_dispatcher_set_pin_handler(&mock_disp, 11, MCP23016_EDGE_BOTH,
+			pin_handler, &pin_calls);
+	mcp23016_dispatcher_add_mask_handler(&mock_disp, 0x0180, MCP23016_EDGE_BOTH,
+			mask_handler, &mask_calls);
+	mcp23016_dispatcher_add_mask_handler(&mock_disp, 0xf000, MCP23016_EDGE_BOTH,
+			mask_handler, &mask_calls);
+
+	expect_service_interrupt(&mock_dev, mock_read_buf, mock_read_buf, 0);
+
+	/* Check behavior when function succeeds */
+	rc = mcp23016_dispatcher_dispatch(&mock_disp);
+
+	assert_return_code(rc, 0);
+	assert_int_equal(mock_disp.state.current, 0x0f0f);
+
+	assert_int_equal(mask_calls.n, 1);
+	assert_int_equal(mask_calls.calls[0].rising, 0x0100);
+	assert_int_equal(mask_calls.calls[0].falling, 0x0080);
+
+	assert_int_equal(pin_calls.n, 3);
+	assert_int_equal(pin_calls.calls[0].pin, 4);
+	assert_int_equal(pin_calls.calls[0].edge, MCP23016_EDGE_FALLING);
+	assert_int_equal(pin_calls.calls[1].pin, 8);
+	assert_int_equal(pin_calls.calls[1].edge, MCP23016_EDGE_RISING);
+	assert_int_equal(pin_calls.calls[2].pin, 11);
+	assert_int_equal(pin_calls.calls[2].edge, MCP23016_EDGE_RISING);
+}
+
+void test_mcp23016_dispatcher_dispatch_missed(void **state)
+{
+	struct mcp23016_device mock_dev = {
+		.i2c_addr = BASE_ADDR,
+		.i2c_dev = &(struct i2cd){0}
+	};
+	struct mcp23016_dispatcher mock_disp = {
+		.dev = &mock_dev,
+		.state.current = 0x0000
+	};
+	struct handler_calls pin_calls = {0}, mask_calls = {0};
+	uint8_t mock_intcap_buf[] = {0x03, 0x00};
+	uint8_t mock_gp_buf[] = {0x02, 0x00};
+	int rc;
+
+	mcp23016_dispatcher_set_pin_handler(&mock_disp, 0, MCP23016_EDGE_BOTH,
+			pin_handler, &pin_calls);
+	mcp23016_dispatcher_add_mask_handler(&mock_disp, 0x0003, MCP23016_EDGE_BOTH,
+			mask_handler, &mask_calls);
+
+	expect_service_interrupt(&mock_dev, mock_intcap_buf, mock_gp_buf, 0);
+
+	/* Check behavior when a pin changes state again after the capture */
+	rc = mcp23016_dispatcher_dispatch(&mock_disp);
+
+	assert_return_code(rc, 0);
+	assert_int_equal(mock_disp.state.current, 0x0002);
+	assert_int_equal(mock_disp.state.missed, 0x0001);
+
+	assert_int_equal(mask_calls.n, 1);
+	assert_int_equal(mask_calls.calls[0].rising, 0x0003);
+	assert_int_equal(mask_calls.calls[0].falling, 0x0001);
+
+	assert_int_equal(pin_calls.n, 2);
+	assert_int_equal(pin_calls.calls[0].pin, 0);
+	assert_int_equal(pin_calls.calls[0].edge, MCP23016_EDGE_RISING);
+	assert_int_equal(pin_calls.calls[1].pin, 0);
+	assert_int_equal(pin_calls.calls[1].edge, MCP23016_EDGE_FALLING);
+}
+
+void test_mcp23016_dispatcher_dispatch_fail(void **state)
+{
+	struct mcp23016_device mock_dev = {
+		.i2c_addr = BASE_ADDR,
+		.i2c_dev = &(struct i2cd){0}
+	};
+	struct mcp23016_dispatcher mock_disp = {
+		.dev = &mock_dev,
+		.state.current = 0x00ff
+	};
+	uint8_t mock_read_buf[] = {0x0f, 0x0f};
+	int rc;
+
+	expect_service_interrupt(&mock_dev, mock_read_buf, mock_read_buf, -1);
+
+	/* Check behavior when mcp23016_service_interrupt() fails */
+	rc = mcp23016_dispatcher_dispatch(&mock_disp);
+
+	assert_int_equal(rc, -1);
+	assert_int_equal(mock_disp.state.current, 0x00ff);
+}
+
+void test_mcp23016_dispatcher_dispatch_ring(void **state)
+{
+	struct mcp23016_device mock_dev = {
+		.i2c_addr = BASE_ADDR + 2,
+		.i2c_dev = &(struct i2cd){0}
+	};
+	struct mcp23016_dispatcher mock_disp = {
+		.dev = &mock_dev,
+		.state.current = 0x00ff
+	};
+	uint8_t mock_read_buf1[] = {0x0f, 0x0f};
+	uint8_t mock_read_buf2[] = {0x0f, 0x0f};
+	uint8_t mock_intcap_buf[] = {0x0f, 0x1f};
+	struct mcp23016_ring *ring;
+	struct mcp23016_event events[4];
+	size_t n;
+	int rc;
+
+	ring = mcp23016_ring_create(4);
+	assert_non_null(ring);
+
+	mcp23016_dispatcher_set_ring(&mock_disp, ring);
+
+	expect_service_interrupt(&mock_dev, mock_read_buf1, mock_read_buf1, 0);
+	expect_service_interrupt(&mock_dev, mock_read_buf2, mock_read_buf2, 0);
+	expect_service_interrupt(&mock_dev, mock_intcap_buf, mock_read_buf2, 0);
+
+	/* Check behavior when pins change state */
+	rc = mcp23016_dispatcher_dispatch(&mock_disp);
+
+	assert_return_code(rc, 0);
+
+	/* Check behavior when no pins change state */
+	rc = mcp23016_dispatcher_dispatch(&mock_disp);
+
+	assert_return_code(rc, 0);
+
+	/* Check behavior when a pin changes state again after the capture */
+	rc = mcp23016_dispatcher_dispatch(&mock_disp);
+
+	assert_return_code(rc, 0);
+
+	n = mcp23016_ring_pop(ring, events, ARRAY_SIZE(events));
+
+	assert_int_equal(n, 2);
+	assert_int_equal(events[0].device, 2);
+	assert_int_equal(events[0].intcap, 0x0f0f);
+	assert_int_equal(events[0].changed, 0x0ff0);
+	assert_int_equal(events[1].device, 2);
+	assert_int_equal(events[1].intcap, 0x1f0f);
+	assert_int_equal(events[1].changed, 0x1000);
+
+	unhook(free);
+	mcp23016_ring_destroy(ring);
+	hook(free, mock_free);
+}
+
+void test_mcp23016_dispatcher_dispatch_snapshot(void **state)
+{
+	struct mcp23016_device mock_dev = {
+		.i2c_addr = BASE_ADDR,
+		.i2c_dev = &(struct i2cd){0}
+	};
+	struct mcp23016_dispatcher mock_disp = {
+		.dev = &mock_dev,
+		.state.current = 0x00ff
+	};
+	uint8_t mock_intcap_buf[] = {0x0f, 0x0f};
+	uint8_t mock_gp_buf[] = {0x0f, 0x00};
+	struct mcp23016_snapshot *snap;
+	struct mcp23016_input input;
+	int rc;
+
+	snap = mcp23016_snapshot_create();
+	assert_non_null(snap);
+
+	/* Check behavior when snapshot is attached */
+	mcp23016_dispatcher_set_snapshot(&mock_disp, snap);
+	mcp23016_snapshot_read(snap, &input);
+
+	assert_int_equal(input.sequence, 1);
+	assert_int_equal(input.port, 0x00ff);
+
+	expect_service_interrupt(&mock_dev, mock_intcap_buf, mock_gp_buf, 0);
+
+	/* Check behavior when interrupt is dispatched */
+	rc = mcp23016_dispatcher_dispatch(&mock_disp);
+
+	assert_return_code(rc, 0);
+
+	mcp23016_snapshot_read(snap, &input);
+
+	assert_int_equal(input.sequence, 2);
+	assert_int_equal(input.port, 0x000f);
+	assert_int_equal(input.intcap, 0x0f0f);
+
+	unhook(free);
+	mcp23016_snapshot_destroy(snap);
+	hook(free, mock_free);
+}
+
+void test_mcp23016_dispatcher_run(void **state)
+{
+	struct mcp23016_device mock_dev = {
+		.i2c_addr = BASE_ADDR,
+		.i2c_dev = &(struct i2cd){0}
+	};
+	struct mcp23016_interrupt mock_intr;
+	struct mcp23016_dispatcher mock_disp = {
+		.dev = &mock_dev,
+		.intr = &mock_intr
+	};
+	uint8_t mock_read_buf[] = {0x01, 0x00};
+	int rc;
+
+	mock_interrupt_init(&mock_intr, MCP23016_INTERRUPT_EVENTS);
+
+	expect_interrupt_wait(&mock_intr, NULL, 1);
+
+	expect_service_interrupt(&mock_dev, mock_read_buf, mock_read_buf, 0);
+
+	/* Check behavior when edge event occurs */
+	rc = mcp23016_dispatcher_run(&mock_disp, NULL);
+
+	assert_int_equal(rc, 1);
+	assert_int_equal(mock_disp.state.current, 0x0001);
+}
+
+void test_mcp23016_dispatcher_run_coalesce(void **state)
+{
+	struct mcp23016_device mock_dev = {
+		.i2c_addr = BASE_ADDR,
+		.i2c_dev = &(struct i2cd){0}
+	};
+	struct mcp23016_interrupt mock_intr;
+	struct mcp23016_dispatcher mock_disp = {
+		.dev = &mock_dev,
+		.intr = &mock_intr
+	};
+	struct mcp23016_dispatcher_stats stats;
+	uint8_t mock_read_buf[] = {0x03, 0x00};
+	int rc;
+
+	mock_interrupt_init(&mock_intr, MCP23016_INTERRUPT_EVENTS);
+
+	rc = mcp23016_dispatcher_set_coalesce(&mock_disp, 1000000000, 3);
+
+	assert_return_code(rc, 0);
+
+	expect_interrupt_wait(&mock_intr, NULL, 1);
+	expect_interrupt_wait_any(&mock_intr, 1);
+	expect_interrupt_wait_any(&mock_intr, 1);
+
+	expect_service_interrupt(&mock_dev, mock_read_buf, mock_read_buf, 0);
+
+	/* Check behavior when edge limit is reached */
+	rc = mcp23016_dispatcher_run(&mock_disp, NULL);
+
+	assert_int_equal(rc, 1);
+	assert_int_equal(mock_disp.state.current, 0x0003);
+
+	expect_interrupt_wait(&mock_intr, NULL, 1);
+	expect_interrupt_wait_any(&mock_intr, 0);
+
+	expect_service_interrupt(&mock_dev, mock_read_buf, mock_read_buf, 0);
+
+	/* Check behavior when coalescing window expires */
+	rc = mcp23016_dispatcher_run(&mock_disp, NULL);
+
+	assert_int_equal(rc, 1);
+
+	mcp23016_dispatcher_get_stats(&mock_disp, &stats);
+
+	assert_int_equal(stats.edges, 4);
+	assert_int_equal(stats.services, 2);
+	assert_int_equal(stats.merged, 2);
+}
+
+void test_mcp23016_dispatcher_run_coalesce_fail(void **state)
+{
+	struct mcp23016_device mock_dev = {
+		.i2c_addr = BASE_ADDR,
+		.i2c_dev = &(struct i2cd){0}
+	};
+	struct mcp23016_interrupt mock_intr;
+	struct mcp23016_dispatcher mock_disp = {
+		.dev = &mock_dev,
+		.intr = &mock_intr
+	};
+	int rc;
+
+	mock_interrupt_init(&mock_intr, MCP23016_INTERRUPT_EVENTS);
+
+	rc = mcp23016_dispatcher_set_coalesce(&mock_disp, 1000000000, 0);
+
+	assert_return_code(rc, 0);
+
+	expect_interrupt_wait(&mock_intr, NULL, 1);
+	expect_interrupt_wait_any(&mock_intr, -1);
+
+	/* Check behavior when mcp23016_interrupt_wait() fails */
+	rc = mcp23016_dispatcher_run(&mock_disp, NULL);
+
+	assert_int_equal(rc, -1);
+
+	mock_interrupt_init(&mock_intr, 0);
+
+	/* Check behavior when edge events are not enabled */
+	rc = mcp23016_dispatcher_set_coalesce(&mock_disp, 1000000000, 0);
+
+	assert_int_equal(rc, -1);
+	assert_int_equal(errno, EINVAL);
+}
+
+void test_mcp23016_dispatcher_run_level(void **state)
+{
+	struct mcp23016_device mock_dev = {
+		.i2c_addr = BASE_ADDR,
+		.i2c_dev = &(struct i2cd){0}
+	};
+	struct mcp23016_interrupt mock_intr;
+	struct mcp23016_dispatcher mock_disp = {
+		.dev = &mock_dev,
+		.intr = &mock_intr
+	};
+	int rc;
+
+	mock_interrupt_init(&mock_intr, 0);
+
+	expect_interrupt_value(&mock_intr, 0);
+
+	/* Check behavior when interrupt output is not asserted */
+	rc = mcp23016_dispatcher_run(&mock_disp, NULL);
+
+	assert_int_equal(rc, 0);
+
+	mock_disp.intr = NULL;
+
+	/* Check behavior when interrupt handle is not set */
+	rc = mcp23016_dispatcher_run(&mock_disp, NULL);
+
+	assert_int_equal(rc, -1);
+	assert_int_equal(errno, EINVAL);
+}
+
+int main(void)
+{
+	const struct CMUnitTest tests[] = {
+		cmocka_unit_test(test_mcp23016_dispatcher_create),
+		cmocka_unit_test(test_mcp23016_dispatcher_create_fail_calloc),
+		cmocka_unit_test(test_mcp23016_dispatcher_create_fail_port),
+		cmocka_unit_test(test_mcp23016_dispatcher_destroy),
+		cmocka_unit_test(test_mcp23016_dispatcher_set_pin_handler),
+		cmocka_unit_test(test_mcp23016_dispatcher_add_mask_handler),
+		cmocka_unit_test(test_mcp23016_dispatcher_dispatch),
+		cmocka_unit_test(test_mcp23016_dispatcher_dispatch_missed),
+		cmocka_unit_test(test_mcp23016_dispatcher_dispatch_fail),
+		cmocka_unit_test(test_mcp23016_dispatcher_dispatch_ring),
+		cmocka_unit_test(test_mcp23016_dispatcher_dispatch_snapshot),
+		cmocka_unit_test(test_mcp23016_dispatcher_run),
+		cmocka_unit_test(test_mcp23016_dispatcher_run_coalesce),
+		cmocka_unit_test(test_mcp23016_dispatcher_run_coalesce_fail),
+		cmocka_unit_test(test_mcp23016_dispatcher_run_level)
+	};
+
+	return cmocka_run_group_tests(tests, setup, teardown);
+}
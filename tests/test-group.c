@@ -0,0 +1,425 @@
+/* SPDX-License-Identifier: LGPL-2.1-or-later */
+/*
+ * Copyright (C) 2021 Steven Stallion <sstallion@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mcp23016-private.h"
+
+#include <errno.h>
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <cmocka.h>
+#include <gpiod.h>
+#include <i2cd.h>
+
+#include "hooks.h"
+#include "mocks.h"
+
+int setup(void **state)
+{
+	hook(calloc, mock_calloc);
+	hook(free, mock_free);
+	hook_gpiod();
+	hook(i2cd_open, mock_i2cd_open);
+	hook(i2cd_close, mock_i2cd_close);
+	hook(i2cd_write, mock_i2cd_write);
+	hook(i2cd_write_read, mock_i2cd_write_read);
+	hook(i2cd_transfer, mock_i2cd_transfer);
+	return 0;
+}
+
+int teardown(void **state)
+{
+	unhook(calloc);
+	unhook(free);
+	unhook_gpiod();
+	unhook(i2cd_open);
+	unhook(i2cd_close);
+	unhook(i2cd_write);
+	unhook(i2cd_write_read);
+	unhook(i2cd_transfer);
+	return 0;
+}
+
+struct group_call {
+	struct mcp23016_device *dev;
+	uint16_t val;
+	uint16_t changed;
+};
+
+struct group_calls {
+	struct group_call calls[MCP23016_DEVICE_MAX * 2];
+	size_t n;
+};
+
+static void group_handler(struct mcp23016_device *dev, uint16_t val, uint16_t changed,
+		void *arg)
+{
+	struct group_calls *calls = arg;
+
+	calls->calls[calls->n].dev = dev;
+	calls->calls[calls->n].val = val;
+	calls->calls[calls->n].changed = changed;
+	calls->n++;
+}
+
+static void expect_group_read(struct mcp23016_device *const *devs, size_t n, uint8_t *reg,
+		uint8_t (*mock_read_bufs)[2], int rc)
+{
+	size_t i;
+
+	expect_value(mock_i2cd_transfer, dev, devs[0]->i2c_dev);
+	expect_value(mock_i2cd_transfer, nmsgs, n * 2);
+	for (i = 0; i < n; i++) {
+		expect_i2cd_transfer_write(devs[i]->i2c_addr, reg, 1);
+		expect_i2cd_transfer_read(devs[i]->i2c_addr, mock_read_bufs[i], 2);
+	}
+	will_return(mock_i2cd_transfer, rc);
+}
+
+void test_mcp23016_group_create(void **state)
+{
+	struct i2cd mock_i2cd;
+	struct mcp23016_device mock_dev0 = {.i2c_addr = BASE_ADDR, .i2c_dev = &mock_i2cd};
+	struct mcp23016_device mock_dev1 = {.i2c_addr = BASE_ADDR + 1, .i2c_dev = &mock_i2cd};
+	struct mcp23016_device *devs[] = {&mock_dev0, &mock_dev1};
+	struct mcp23016_interrupt mock_intr = {0};
+	struct mcp23016_group mock_grp = {0};
+	uint8_t reg = REG_INTCAP0;
+	uint8_t mock_read_bufs[][2] = {{0x55, 0xaa}, {0x34, 0x12}};
+	struct mcp23016_group *grp;
+
+	expect_value(mock_calloc, nmemb, 1);
+	expect_value(mock_calloc, size, sizeof(mock_grp));
+	will_return(mock_calloc, &mock_grp);
+
+	expect_group_read(devs, ARRAY_SIZE(devs), &reg, mock_read_bufs, 0);
+
+	/* Check behavior when function succeeds */
+	grp = mcp23016_group_create(&mock_intr, devs, ARRAY_SIZE(devs));
+
+	assert_non_null(grp);
+	assert_ptr_equal(grp->intr, &mock_intr);
+	assert_int_equal(grp->num_devs, 2);
+	assert_ptr_equal(grp->devs[0], &mock_dev0);
+	assert_ptr_equal(grp->devs[1], &mock_dev1);
+	assert_int_equal(grp->last[0], 0xaa55);
+	assert_int_equal(grp->last[1], 0x1234);
+}
+
+void test_mcp23016_group_create_invalid(void **state)
+{
+	struct i2cd mock_i2cd0, mock_i2cd1;
+	struct mcp23016_device mock_dev0 = {.i2c_addr = BASE_ADDR, .i2c_dev = &mock_i2cd0};
+	struct mcp23016_device mock_dev1 = {.i2c_addr = BASE_ADDR + 1, .i2c_dev = &mock_i2cd1};
+	struct mcp23016_device *devs[] = {&mock_dev0, &mock_dev1};
+	struct mcp23016_interrupt mock_intr = {0};
+	struct mcp23016_group *grp;
+
+	/* Check behavior when no devices are specified */
+	grp = mcp23016_group_create(&mock_intr, devs, 0);
+
+	assert_null(grp);
+	assert_int_equal(errno, EINVAL);
+
+	/* Check behavior when too many devices are specified */
+	grp = mcp23016_group_create(&mock_intr, devs, MCP23016_DEVICE_MAX + 1);
+
+	assert_null(grp);
+	assert_int_equal(errno, EINVAL);
+
+	/* Check behavior when devices do not share a bus */
+	grp = mcp23016_group_create(&mock_intr, devs, ARRAY_SIZE(devs));
+
+	assert_null(grp);
+	assert_int_equal(errno, EINVAL);
+}
+
+void test_mcp23016_group_create_fail_transfer(void **state)
+{
+	struct i2cd mock_i2cd;
+	struct mcp23016_device mock_dev = {.i2c_addr = BASE_ADDR, .i2c_dev = &mock_i2cd};
+	struct mcp23016_device *devs[] = {&mock_dev};
+	struct mcp23016_interrupt mock_intr = {0};
+	struct mcp23016_group mock_grp = {0};
+	uint8_t reg = REG_INTCAP0;
+	uint8_t mock_read_bufs[][2] = {{0}};
+	struct mcp23016_group *grp;
+
+	expect_any(mock_calloc, nmemb);
+	expect_any(mock_calloc, size);
+	will_return(mock_calloc, &mock_grp);
+
+	expect_group_read(devs, ARRAY_SIZE(devs), &reg, mock_read_bufs, -1);
+
+	expect_value(mock_free, ptr, &mock_grp);
+
+	/* Check behavior when i2cd_transfer() fails */
+	grp = mcp23016_group_create(&mock_intr, devs, ARRAY_SIZE(devs));
+
+	assert_null(grp);
+}
+
+void test_mcp23016_group_destroy(void **state)
+{
+	struct mcp23016_group mock_grp = {0};
+
+	expect_value(mock_free, ptr, &mock_grp);
+
+	/* Check behavior when function succeeds */
+	mcp23016_group_destroy(&mock_grp);
+}
+
+void test_mcp23016_group_service(void **state)
+{
+	struct i2cd mock_i2cd;
+	struct mcp23016_device mock_dev0 = {.i2c_addr = BASE_ADDR, .i2c_dev = &mock_i2cd};
+	struct mcp23016_device mock_dev1 = {.i2c_addr = BASE_ADDR + 1, .i2c_dev = &mock_i2cd};
+	struct mcp23016_interrupt mock_intr;
+	struct mcp23016_group mock_grp = {
+		.intr = &mock_intr,
+		.devs = {&mock_dev0, &mock_dev1},
+		.num_devs = 2
+	};
+	uint8_t reg = REG_INTCAP0;
+	uint8_t mock_read_bufs1[][2] = {{0x01, 0x00}, {0x00, 0x00}};
+	uint8_t mock_read_bufs2[][2] = {{0x01, 0x00}, {0x00, 0x80}};
+	struct group_calls calls = {0};
+	int rc;
+
+	mock_interrupt_init(&mock_intr, 0);
+
+	/* First pass: device 0 asserted the interrupt output */
+	expect_group_read(mock_grp.devs, 2, &reg, mock_read_bufs1, 0);
+	expect_interrupt_value(&mock_intr, 1);
+
+	/* Second pass: device 1 asserted the interrupt output */
+	expect_group_read(mock_grp.devs, 2, &reg, mock_read_bufs2, 0);
+	expect_interrupt_value(&mock_intr, 0);
+
+	/* Check behavior when function succeeds */
+	rc = mcp23016_group_service(&mock_grp, group_handler, &calls);
+
+	assert_return_code(rc, 0);
+	assert_int_equal(calls.n, 2);
+	assert_ptr_equal(calls.calls[0].dev, &mock_dev0);
+	assert_int_equal(calls.calls[0].val, 0x0001);
+	assert_int_equal(calls.calls[0].changed, 0x0001);
+	assert_ptr_equal(calls.calls[1].dev, &mock_dev1);
+	assert_int_equal(calls.calls[1].val, 0x8000);
+	assert_int_equal(calls.calls[1].changed, 0x8000);
+	assert_int_equal(mock_grp.last[0], 0x0001);
+	assert_int_equal(mock_grp.last[1], 0x8000);
+}
+
+void test_mcp23016_group_service_idle(void **state)
+{
+	struct i2cd mock_i2cd;
+	struct mcp23016_device mock_dev0 = {.i2c_addr = BASE_ADDR, .i2c_dev = &mock_i2cd};
+	struct mcp23016_device mock_dev1 = {.i2c_addr = BASE_ADDR + 1, .i2c_dev = &mock_i2cd};
+	struct mcp23016_device *devs[] = {&mock_dev0, &mock_dev1};
+	struct mcp23016_interrupt mock_intr;
+	struct mcp23016_group mock_grp = {0};
+	uint8_t reg = REG_INTCAP0;
+	/* Device 1 last interrupted with 0x00ff captured; its port value has
+	 * since changed to 0x0000 without asserting the interrupt output.
+	 */
+	uint8_t mock_read_bufs1[][2] = {{0x00, 0x00}, {0xff, 0x00}};
+	uint8_t mock_read_bufs2[][2] = {{0x01, 0x00}, {0xff, 0x00}};
+	struct group_calls calls = {0};
+	struct mcp23016_group *grp;
+	int rc;
+
+	mock_interrupt_init(&mock_intr, 0);
+
+	expect_any(mock_calloc, nmemb);
+	expect_any(mock_calloc, size);
+	will_return(mock_calloc, &mock_grp);
+
+	expect_group_read(devs, ARRAY_SIZE(devs), &reg, mock_read_bufs1, 0);
+
+	grp = mcp23016_group_create(&mock_intr, devs, ARRAY_SIZE(devs));
+	assert_non_null(grp);
+
+	/* Device 0 asserted the interrupt output */
+	expect_group_read(devs, ARRAY_SIZE(devs), &reg, mock_read_bufs2, 0);
+	expect_interrupt_value(&mock_intr, 0);
+
+	/* Check behavior when idle device capture differs from port value */
+	rc = mcp23016_group_service(grp, group_handler, &calls);
+
+	assert_return_code(rc, 0);
+	assert_int_equal(calls.n, 1);
+	assert_ptr_equal(calls.calls[0].dev, &mock_dev0);
+	assert_int_equal(calls.calls[0].val, 0x0001);
+	assert_int_equal(calls.calls[0].changed, 0x0001);
+}
+
+void test_mcp23016_group_service_stuck(void **state)
+{
+	struct i2cd mock_i2cd;
+	struct mcp23016_device mock_dev = {.i2c_addr = BASE_ADDR, .i2c_dev = &mock_i2cd};
+	struct mcp23016_interrupt mock_intr;
+	struct mcp23016_group mock_grp = {
+		.intr = &mock_intr,
+		.devs = {&mock_dev},
+		.num_devs = 1
+	};
+	uint8_t reg = REG_INTCAP0;
+	uint8_t mock_read_bufs[][2] = {{0x00, 0x00}};
+	struct group_calls calls = {0};
+	int i, rc;
+
+	mock_interrupt_init(&mock_intr, 0);
+
+	for (i = 0; i < GROUP_PASS_MAX; i++) {
+		expect_group_read(mock_grp.devs, 1, &reg, mock_read_bufs, 0);
+		expect_interrupt_value(&mock_intr, 1);
+	}
+
+	/* Check behavior when interrupt output remains asserted */
+	rc = mcp23016_group_service(&mock_grp, group_handler, &calls);
+
+	assert_int_equal(rc, -1);
+	assert_int_equal(errno, EAGAIN);
+	assert_int_equal(calls.n, 0);
+}
+
+void test_mcp23016_group_service_fail_transfer(void **state)
+{
+	struct i2cd mock_i2cd;
+	struct mcp23016_device mock_dev = {.i2c_addr = BASE_ADDR, .i2c_dev = &mock_i2cd};
+	struct mcp23016_group mock_grp = {
+		.devs = {&mock_dev},
+		.last = {0x1234},
+		.num_devs = 1
+	};
+	uint8_t reg = REG_INTCAP0;
+	uint8_t mock_read_bufs[][2] = {{0}};
+	struct group_calls calls = {0};
+	int rc;
+
+	expect_group_read(mock_grp.devs, 1, &reg, mock_read_bufs, -1);
+
+	/* Check behavior when i2cd_transfer() fails */
+	rc = mcp23016_group_service(&mock_grp, group_handler, &calls);
+
+	assert_int_equal(rc, -1);
+	assert_int_equal(calls.n, 0);
+	assert_int_equal(mock_grp.last[0], 0x1234);
+}
+
+void test_mcp23016_group_service_ring(void **state)
+{
+	struct i2cd mock_i2cd;
+	struct mcp23016_device mock_dev0 = {.i2c_addr = BASE_ADDR, .i2c_dev = &mock_i2cd};
+	struct mcp23016_device mock_dev1 = {.i2c_addr = BASE_ADDR + 7, .i2c_dev = &mock_i2cd};
+	struct mcp23016_interrupt mock_intr;
+	struct mcp23016_group mock_grp = {
+		.intr = &mock_intr,
+		.devs = {&mock_dev0, &mock_dev1},
+		.num_devs = 2
+	};
+	uint8_t reg = REG_INTCAP0;
+	uint8_t mock_read_bufs[][2] = {{0x00, 0x00}, {0x02, 0x00}};
+	struct mcp23016_ring *ring;
+	struct mcp23016_event events[2];
+	size_t n;
+	int rc;
+
+	mock_interrupt_init(&mock_intr, 0);
+
+	ring = mcp23016_ring_create(2);
+	assert_non_null(ring);
+
+	mcp23016_group_set_ring(&mock_grp, ring);
+
+	expect_group_read(mock_grp.devs, 2, &reg, mock_read_bufs, 0);
+	expect_interrupt_value(&mock_intr, 0);
+
+	/* Check behavior when changes are only recorded to a ring */
+	rc = mcp23016_group_service(&mock_grp, NULL, NULL);
+
+	assert_return_code(rc, 0);
+
+	n = mcp23016_ring_pop(ring, events, ARRAY_SIZE(events));
+
+	assert_int_equal(n, 1);
+	assert_int_equal(events[0].device, 7);
+	assert_int_equal(events[0].intcap, 0x0002);
+	assert_int_equal(events[0].changed, 0x0002);
+
+	unhook(free);
+	mcp23016_ring_destroy(ring);
+	hook(free, mock_free);
+}
+
+void test_mcp23016_group_run(void **state)
+{
+	struct i2cd mock_i2cd;
+	struct mcp23016_device mock_dev = {.i2c_addr = BASE_ADDR, .i2c_dev = &mock_i2cd};
+	struct mcp23016_interrupt mock_intr;
+	struct mcp23016_group mock_grp = {
+		.intr = &mock_intr,
+		.devs = {&mock_dev},
+		.num_devs = 1
+	};
+	uint8_t reg = REG_INTCAP0;
+	uint8_t mock_read_bufs[][2] = {{0x10, 0x00}};
+	struct group_calls calls = {0};
+	int rc;
+
+	mock_interrupt_init(&mock_intr, MCP23016_INTERRUPT_EVENTS);
+
+	expect_interrupt_wait(&mock_intr, NULL, 1);
+
+	expect_group_read(mock_grp.devs, 1, &reg, mock_read_bufs, 0);
+	expect_interrupt_value(&mock_intr, 0);
+
+	/* Check behavior when edge event occurs */
+	rc = mcp23016_group_run(&mock_grp, NULL, group_handler, &calls);
+
+	assert_int_equal(rc, 1);
+	assert_int_equal(calls.n, 1);
+	assert_int_equal(calls.calls[0].changed, 0x0010);
+
+	expect_interrupt_wait(&mock_intr, NULL, 0);
+
+	/* Check behavior when timeout expires */
+	rc = mcp23016_group_run(&mock_grp, NULL, group_handler, &calls);
+
+	assert_int_equal(rc, 0);
+	assert_int_equal(calls.n, 1);
+}
+
+int main(void)
+{
+	const struct CMUnitTest tests[] = {
+		cmocka_unit_test(test_mcp23016_group_create),
+		cmocka_unit_test(test_mcp23016_group_create_invalid),
+		cmocka_unit_test(test_mcp23016_group_create_fail_transfer),
+		cmocka_unit_test(test_mcp23016_group_destroy),
+		cmocka_unit_test(test_mcp23016_group_service),
+		cmocka_unit_test(test_mcp23016_group_service_idle),
+		cmocka_unit_test(test_mcp23016_group_service_stuck),
+		cmocka_unit_test(test_mcp23016_group_service_fail_transfer),
+		cmocka_unit_test(test_mcp23016_group_service_ring),
+		cmocka_unit_test(test_mcp23016_group_run)
+	};
+
+	return cmocka_run_group_tests(tests, setup, teardown);
+}
@@ -0,0 +1,317 @@
+/* SPDX-License-Identifier: LGPL-2.1-or-later */
+/*
+ * Copyright (C) 2021 Steven Stallion <sstallion@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mcp23016-private.h"
+
+#include <errno.h>
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <cmocka.h>
+
+static const uint64_t sample_timestamps[] = {1000, 2000, 3000, 4000, 5000};
+static const uint16_t sample_vals[] = {0x0001, 0x0001, 0x0001, 0x0003, 0x0003};
+
+static const uint8_t sample_stream[] = {
+	0x02, 0xe8, 0x07,	/* change 0x0001 after 1000 */
+	0x05, 0xd0, 0x0f,	/* run of 2 over 2000 */
+	0x04, 0xe8, 0x07,	/* change 0x0002 after 1000 */
+	0x03, 0xe8, 0x07	/* run of 1 over 1000 */
+};
+
+void test_mcp23016_encoder_put(void **state)
+{
+	struct mcp23016_encoder *enc;
+	uint8_t buf[64];
+	size_t i, len = 0;
+
+	enc = mcp23016_encoder_create();
+	assert_non_null(enc);
+
+	/* Check behavior when function succeeds */
+	for (i = 0; i < ARRAY_SIZE(sample_vals); i++)
+		len += mcp23016_encoder_put(enc, sample_timestamps[i], sample_vals[i], buf + len);
+	len += mcp23016_encoder_flush(enc, buf + len);
+
+	assert_int_equal(len, sizeof(sample_stream));
+	assert_memory_equal(buf, sample_stream, sizeof(sample_stream));
+
+	/* Check behavior when no run is pending */
+	assert_int_equal(mcp23016_encoder_flush(enc, buf), 0);
+
+	mcp23016_encoder_reset(enc);
+
+	/* Check behavior when encoder is reset */
+	len = mcp23016_encoder_put(enc, sample_timestamps[0], sample_vals[0], buf);
+
+	assert_int_equal(len, 3);
+	assert_memory_equal(buf, sample_stream, 3);
+
+	mcp23016_encoder_destroy(enc);
+}
+
+void test_mcp23016_encoder_put_zero(void **state)
+{
+	static const uint64_t timestamps[] = {1000, 1001, 1002, 1003};
+	static const uint16_t vals[] = {0x0000, 0x0000, 0x0000, 0x0005};
+	static const uint8_t stream[] = {
+		0x00, 0xe8, 0x07,	/* change 0x0000 after 1000 */
+		0x05, 0x02,		/* run of 2 over 2 */
+		0x0a, 0x01		/* change 0x0005 after 1 */
+	};
+	struct mcp23016_encoder *enc;
+	struct mcp23016_decoder *dec;
+	uint64_t decoded_timestamps[8];
+	uint16_t decoded_vals[8];
+	uint8_t buf[64];
+	size_t i, n, len = 0;
+	int rc;
+
+	enc = mcp23016_encoder_create();
+	assert_non_null(enc);
+
+	/* Check behavior when the first samples are 0 */
+	for (i = 0; i < ARRAY_SIZE(vals); i++)
+		len += mcp23016_encoder_put(enc, timestamps[i], vals[i], buf + len);
+	len += mcp23016_encoder_flush(enc, buf + len);
+
+	assert_int_equal(len, sizeof(stream));
+	assert_memory_equal(buf, stream, sizeof(stream));
+
+	mcp23016_encoder_destroy(enc);
+
+	dec = mcp23016_decoder_create(buf, len);
+	assert_non_null(dec);
+
+	n = ARRAY_SIZE(decoded_vals);
+	rc = mcp23016_decoder_read(dec, decoded_timestamps, decoded_vals, &n);
+
+	assert_return_code(rc, 0);
+	assert_int_equal(n, ARRAY_SIZE(vals));
+	for (i = 0; i < n; i++) {
+		assert_int_equal(decoded_timestamps[i], timestamps[i]);
+		assert_int_equal(decoded_vals[i], vals[i]);
+	}
+
+	mcp23016_decoder_destroy(dec);
+}
+
+void test_mcp23016_encoder_put_max(void **state)
+{
+	struct mcp23016_encoder *enc;
+	uint8_t buf[MCP23016_ENCODE_MAX];
+	size_t len;
+
+	enc = mcp23016_encoder_create();
+	assert_non_null(enc);
+
+	mcp23016_encoder_put(enc, UINT64_MAX, 0xffff, buf);
+	mcp23016_encoder_put(enc, UINT64_MAX - 1, 0xffff, buf);
+
+	/* Check behavior when record sizes are largest */
+	len = mcp23016_encoder_put(enc, UINT64_MAX - 2, 0x0000, buf);
+
+	assert_int_equal(len, 24);
+
+	mcp23016_encoder_destroy(enc);
+}
+
+void test_mcp23016_decoder_read(void **state)
+{
+	struct mcp23016_decoder *dec;
+	uint64_t timestamps[8];
+	uint16_t vals[8];
+	size_t i, n;
+	int rc;
+
+	dec = mcp23016_decoder_create(sample_stream, sizeof(sample_stream));
+	assert_non_null(dec);
+
+	n = ARRAY_SIZE(vals);
+
+	/* Check behavior when function succeeds */
+	rc = mcp23016_decoder_read(dec, timestamps, vals, &n);
+
+	assert_return_code(rc, 0);
+	assert_int_equal(n, ARRAY_SIZE(sample_vals));
+	for (i = 0; i < n; i++) {
+		assert_int_equal(timestamps[i], sample_timestamps[i]);
+		assert_int_equal(vals[i], sample_vals[i]);
+	}
+
+	n = ARRAY_SIZE(vals);
+
+	/* Check behavior when end of stream is reached */
+	rc = mcp23016_decoder_read(dec, timestamps, vals, &n);
+
+	assert_return_code(rc, 0);
+	assert_int_equal(n, 0);
+
+	mcp23016_decoder_destroy(dec);
+}
+
+void test_mcp23016_decoder_read_partial(void **state)
+{
+	struct mcp23016_decoder *dec;
+	uint16_t vals[2];
+	size_t i = 0, n;
+	int rc;
+
+	dec = mcp23016_decoder_create(sample_stream, sizeof(sample_stream));
+	assert_non_null(dec);
+
+	/* Check behavior when runs span calls */
+	do {
+		n = ARRAY_SIZE(vals);
+		rc = mcp23016_decoder_read(dec, NULL, vals, &n);
+
+		assert_return_code(rc, 0);
+		if (n > 0)
+			assert_int_equal(vals[0], sample_vals[i]);
+		if (n > 1)
+			assert_int_equal(vals[1], sample_vals[i + 1]);
+		i += n;
+	} while (n > 0);
+
+	assert_int_equal(i, ARRAY_SIZE(sample_vals));
+
+	mcp23016_decoder_destroy(dec);
+}
+
+void test_mcp23016_decoder_read_invalid(void **state)
+{
+	static const uint8_t zero_change[] = {0x02, 0xe8, 0x07, 0x00, 0x01};
+	static const uint8_t leading_run[] = {0x03, 0xe8, 0x07};
+	struct mcp23016_decoder *dec;
+	uint16_t vals[8];
+	size_t n;
+	int rc;
+
+	dec = mcp23016_decoder_create(sample_stream, sizeof(sample_stream) - 1);
+	assert_non_null(dec);
+
+	n = ARRAY_SIZE(vals);
+
+	/* Check behavior when stream is truncated */
+	rc = mcp23016_decoder_read(dec, NULL, vals, &n);
+
+	assert_return_code(rc, 0);
+	assert_int_equal(n, 4);
+
+	n = ARRAY_SIZE(vals);
+	rc = mcp23016_decoder_read(dec, NULL, vals, &n);
+
+	assert_int_equal(rc, -1);
+	assert_int_equal(errno, EBADMSG);
+
+	mcp23016_decoder_destroy(dec);
+
+	dec = mcp23016_decoder_create(zero_change, sizeof(zero_change));
+	assert_non_null(dec);
+
+	n = ARRAY_SIZE(vals);
+
+	/* Check behavior when change is empty */
+	rc = mcp23016_decoder_read(dec, NULL, vals, &n);
+
+	assert_return_code(rc, 0);
+	assert_int_equal(n, 1);
+
+	n = ARRAY_SIZE(vals);
+	rc = mcp23016_decoder_read(dec, NULL, vals, &n);
+
+	assert_int_equal(rc, -1);
+	assert_int_equal(errno, EBADMSG);
+
+	mcp23016_decoder_destroy(dec);
+
+	dec = mcp23016_decoder_create(leading_run, sizeof(leading_run));
+	assert_non_null(dec);
+
+	n = ARRAY_SIZE(vals);
+
+	/* Check behavior when stream begins with a run */
+	rc = mcp23016_decoder_read(dec, NULL, vals, &n);
+
+	assert_int_equal(rc, -1);
+	assert_int_equal(errno, EBADMSG);
+
+	mcp23016_decoder_destroy(dec);
+}
+
+void test_mcp23016_history_roundtrip(void **state)
+{
+	static uint64_t timestamps[4096];
+	static uint16_t vals[4096];
+	static uint8_t buf[4096];
+	struct mcp23016_encoder *enc;
+	struct mcp23016_decoder *dec;
+	uint16_t val = 0x1234;
+	size_t i, n, len = 0;
+	int rc;
+
+	enc = mcp23016_encoder_create();
+	assert_non_null(enc);
+
+	/* Check behavior when few samples change */
+	for (i = 0; i < ARRAY_SIZE(vals); i++) {
+		if (i % 512 == 0)
+			val ^= BIT(i / 512);
+		len += mcp23016_encoder_put(enc, 1000000 * (i + 1), val, buf + len);
+		assert_true(len + MCP23016_ENCODE_MAX <= sizeof(buf));
+	}
+	len += mcp23016_encoder_flush(enc, buf + len);
+
+	assert_true(len < 128);
+
+	mcp23016_encoder_destroy(enc);
+
+	dec = mcp23016_decoder_create(buf, len);
+	assert_non_null(dec);
+
+	n = ARRAY_SIZE(vals);
+	rc = mcp23016_decoder_read(dec, timestamps, vals, &n);
+
+	assert_return_code(rc, 0);
+	assert_int_equal(n, ARRAY_SIZE(vals));
+
+	val = 0x1234;
+	for (i = 0; i < n; i++) {
+		if (i % 512 == 0)
+			val ^= BIT(i / 512);
+		assert_int_equal(timestamps[i], 1000000 * (i + 1));
+		assert_int_equal(vals[i], val);
+	}
+
+	mcp23016_decoder_destroy(dec);
+}
+
+int main(void)
+{
+	const struct CMUnitTest tests[] = {
+		cmocka_unit_test(test_mcp23016_encoder_put),
+		cmocka_unit_test(test_mcp23016_encoder_put_zero),
+		cmocka_unit_test(test_mcp23016_encoder_put_max),
+		cmocka_unit_test(test_mcp23016_decoder_read),
+		cmocka_unit_test(test_mcp23016_decoder_read_partial),
+		cmocka_unit_test(test_mcp23016_decoder_read_invalid),
+		cmocka_unit_test(test_mcp23016_history_roundtrip)
+	};
+
+	return cmocka_run_group_tests(tests, NULL, NULL);
+}
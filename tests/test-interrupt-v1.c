@@ -0,0 +1,419 @@
+/* SPDX-License-Identifier: LGPL-2.1-or-later */
+/*
+ * Copyright (C) 2021 Steven Stallion <sstallion@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mcp23016-private.h"
+
+#include <errno.h>
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <cmocka.h>
+#include <gpiod.h>
+
+#include "hooks.h"
+#include "mocks.h"
+
+int setup(void **state)
+{
+	hook(calloc, mock_calloc);
+	hook(free, mock_free);
+	hook_gpiod();
+	return 0;
+}
+
+int teardown(void **state)
+{
+	unhook(calloc);
+	unhook(free);
+	unhook_gpiod();
+	return 0;
+}
+
+void test_mcp23016_interrupt_open(void **state)
+{
+	struct mcp23016_interrupt mock_intr = {0};
+	struct gpiod_chip mock_gpiod_chip;
+	struct gpiod_line mock_gpiod_line;
+	struct mcp23016_interrupt *intr;
+
+	expect_value(mock_calloc, nmemb, 1);
+	expect_value(mock_calloc, size, sizeof(mock_intr));
+	will_return(mock_calloc, &mock_intr);
+
+	expect_string(mock_gpiod_chip_open, path, "/dev/gpiochip0");
+	will_return(mock_gpiod_chip_open, &mock_gpiod_chip);
+
+	expect_value(mock_gpiod_chip_get_line, chip, &mock_gpiod_chip);
+	expect_value(mock_gpiod_chip_get_line, offset, 0);
+	will_return(mock_gpiod_chip_get_line, &mock_gpiod_line);
+
+	expect_value(mock_gpiod_line_request_input_flags, line, &mock_gpiod_line);
+	expect_string(mock_gpiod_line_request_input_flags, consumer, CONSUMER);
+	expect_value(mock_gpiod_line_request_input_flags, flags, GPIOD_LINE_REQUEST_FLAG_ACTIVE_LOW);
+	will_return(mock_gpiod_line_request_input_flags, 0);
+
+	/* Check behavior when function succeeds */
+	intr = mcp23016_interrupt_open("/dev/gpiochip0", 0);
+
+	assert_non_null(intr);
+	assert_ptr_equal(intr->gpio_chip, &mock_gpiod_chip);
+	assert_ptr_equal(intr->gpio_line, &mock_gpiod_line);
+}
+
+void test_mcp23016_interrupt_open_fail_calloc(void **state)
+{
+	struct mcp23016_interrupt *intr;
+
+	expect_any(mock_calloc, nmemb);
+	expect_any(mock_calloc, size);
+	will_return(mock_calloc, NULL);
+
+	/* Check behavior when calloc() fails */
+	intr = mcp23016_interrupt_open("/dev/gpiochip0", 0);
+
+	assert_null(intr);
+}
+
+void test_mcp23016_interrupt_open_fail_gpio_chip(void **state)
+{
+	struct mcp23016_interrupt mock_intr = {0};
+	struct mcp23016_interrupt *intr;
+
+	expect_any(mock_calloc, nmemb);
+	expect_any(mock_calloc, size);
+	will_return(mock_calloc, &mock_intr);
+
+	expect_any(mock_gpiod_chip_open, path);
+	will_return(mock_gpiod_chip_open, NULL);
+
+	expect_value(mock_free, ptr, &mock_intr);
+
+	/* Check behavior when gpiod_chip_open() fails */
+	intr = mcp23016_interrupt_open("/dev/gpiochip0", 0);
+
+	assert_null(intr);
+}
+
+void test_mcp23016_interrupt_open_fail_gpio_line(void **state)
+{
+	struct mcp23016_interrupt mock_intr = {0};
+	struct gpiod_chip mock_gpiod_chip;
+	struct mcp23016_interrupt *intr;
+
+	expect_any(mock_calloc, nmemb);
+	expect_any(mock_calloc, size);
+	will_return(mock_calloc, &mock_intr);
+
+	expect_any(mock_gpiod_chip_open, path);
+	will_return(mock_gpiod_chip_open, &mock_gpiod_chip);
+
+	expect_any(mock_gpiod_chip_get_line, chip);
+	expect_any(mock_gpiod_chip_get_line, offset);
+	will_return(mock_gpiod_chip_get_line, NULL);
+
+	expect_value(mock_gpiod_chip_close, chip, &mock_gpiod_chip);
+	expect_value(mock_free, ptr, &mock_intr);
+
+	/* Check behavior when gpiod_chip_get_line() fails */
+	intr = mcp23016_interrupt_open("/dev/gpiochip0", 0);
+
+	assert_null(intr);
+}
+
+void test_mcp23016_interrupt_open_fail_gpio_line_flags(void **state)
+{
+	struct mcp23016_interrupt mock_intr = {0};
+	struct gpiod_chip mock_gpiod_chip;
+	struct gpiod_line mock_gpiod_line;
+	struct mcp23016_interrupt *intr;
+
+	expect_any(mock_calloc, nmemb);
+	expect_any(mock_calloc, size);
+	will_return(mock_calloc, &mock_intr);
+
+	expect_any(mock_gpiod_chip_open, path);
+	will_return(mock_gpiod_chip_open, &mock_gpiod_chip);
+
+	expect_any(mock_gpiod_chip_get_line, chip);
+	expect_any(mock_gpiod_chip_get_line, offset);
+	will_return(mock_gpiod_chip_get_line, &mock_gpiod_line);
+
+	expect_any(mock_gpiod_line_request_input_flags, line);
+	expect_any(mock_gpiod_line_request_input_flags, consumer);
+	expect_any(mock_gpiod_line_request_input_flags, flags);
+	will_return(mock_gpiod_line_request_input_flags, -1);
+
+	expect_value(mock_gpiod_line_release, line, &mock_gpiod_line);
+	expect_value(mock_gpiod_chip_close, chip, &mock_gpiod_chip);
+	expect_value(mock_free, ptr, &mock_intr);
+
+	/* Check behavior when gpiod_line_request_input_flags() fails */
+	intr = mcp23016_interrupt_open("/dev/gpiochip0", 0);
+
+	assert_null(intr);
+}
+
+void test_mcp23016_interrupt_close(void **state)
+{
+	struct mcp23016_interrupt mock_intr = {
+		.gpio_chip = &(struct gpiod_chip){0},
+		.gpio_line = &(struct gpiod_line){0}
+	};
+
+	expect_value(mock_gpiod_line_release, line, mock_intr.gpio_line);
+	expect_value(mock_gpiod_chip_close, chip, mock_intr.gpio_chip);
+	expect_value(mock_free, ptr, &mock_intr);
+
+	/* Check behavior when function succeeds */
+	mcp23016_interrupt_close(&mock_intr);
+}
+
+void test_mcp23016_has_interrupt(void **state)
+{
+	struct mcp23016_interrupt mock_intr = {
+		.gpio_chip = &(struct gpiod_chip){0},
+		.gpio_line = &(struct gpiod_line){0}
+	};
+	int res;
+
+	expect_value(mock_gpiod_line_get_value, line, mock_intr.gpio_line);
+	will_return(mock_gpiod_line_get_value, 0);
+
+	/* Check behavior when function succeeds */
+	res = mcp23016_has_interrupt(&mock_intr);
+
+	assert_int_equal(res, 0);
+}
+
+void test_mcp23016_interrupt_open_flags(void **state)
+{
+	struct mcp23016_interrupt mock_intr = {0};
+	struct gpiod_chip mock_gpiod_chip;
+	struct gpiod_line mock_gpiod_line;
+	struct mcp23016_interrupt *intr;
+
+	expect_value(mock_calloc, nmemb, 1);
+	expect_value(mock_calloc, size, sizeof(mock_intr));
+	will_return(mock_calloc, &mock_intr);
+
+	expect_string(mock_gpiod_chip_open, path, "/dev/gpiochip0");
+	will_return(mock_gpiod_chip_open, &mock_gpiod_chip);
+
+	expect_value(mock_gpiod_chip_get_line, chip, &mock_gpiod_chip);
+	expect_value(mock_gpiod_chip_get_line, offset, 0);
+	will_return(mock_gpiod_chip_get_line, &mock_gpiod_line);
+
+	expect_value(mock_gpiod_line_request_rising_edge_events_flags, line, &mock_gpiod_line);
+	expect_string(mock_gpiod_line_request_rising_edge_events_flags, consumer, CONSUMER);
+	expect_value(mock_gpiod_line_request_rising_edge_events_flags, flags,
+			GPIOD_LINE_REQUEST_FLAG_ACTIVE_LOW);
+	will_return(mock_gpiod_line_request_rising_edge_events_flags, 0);
+
+	/* Check behavior when function succeeds */
+	intr = mcp23016_interrupt_open_flags("/dev/gpiochip0", 0, MCP23016_INTERRUPT_EVENTS);
+
+	assert_non_null(intr);
+	assert_int_equal(intr->flags, MCP23016_INTERRUPT_EVENTS);
+	assert_ptr_equal(intr->gpio_chip, &mock_gpiod_chip);
+	assert_ptr_equal(intr->gpio_line, &mock_gpiod_line);
+}
+
+void test_mcp23016_interrupt_wait(void **state)
+{
+	struct mcp23016_interrupt mock_intr = {
+		.flags = MCP23016_INTERRUPT_EVENTS,
+		.gpio_chip = &(struct gpiod_chip){0},
+		.gpio_line = &(struct gpiod_line){0}
+	};
+	struct timespec timeout = {.tv_sec = 1};
+	int res;
+
+	expect_value(mock_gpiod_line_event_wait, line, mock_intr.gpio_line);
+	expect_value(mock_gpiod_line_event_wait, timeout, &timeout);
+	will_return(mock_gpiod_line_event_wait, 1);
+
+	expect_value(mock_gpiod_line_event_read, line, mock_intr.gpio_line);
+	expect_any(mock_gpiod_line_event_read, event);
+	will_return(mock_gpiod_line_event_read, 0);
+
+	/* Check behavior when edge event occurs */
+	res = mcp23016_interrupt_wait(&mock_intr, &timeout);
+
+	assert_int_equal(res, 1);
+
+	expect_value(mock_gpiod_line_event_wait, line, mock_intr.gpio_line);
+	expect_value(mock_gpiod_line_event_wait, timeout, &timeout);
+	will_return(mock_gpiod_line_event_wait, 0);
+
+	/* Check behavior when timeout expires */
+	res = mcp23016_interrupt_wait(&mock_intr, &timeout);
+
+	assert_int_equal(res, 0);
+}
+
+void test_mcp23016_interrupt_wait_fail_flags(void **state)
+{
+	struct mcp23016_interrupt mock_intr = {
+		.gpio_chip = &(struct gpiod_chip){0},
+		.gpio_line = &(struct gpiod_line){0}
+	};
+	int res;
+
+	/* Check behavior when edge events are not requested */
+	res = mcp23016_interrupt_wait(&mock_intr, NULL);
+
+	assert_int_equal(res, -1);
+	assert_int_equal(errno, EINVAL);
+}
+
+void test_mcp23016_interrupt_get_fd(void **state)
+{
+	struct mcp23016_interrupt mock_intr = {
+		.flags = MCP23016_INTERRUPT_EVENTS,
+		.gpio_chip = &(struct gpiod_chip){0},
+		.gpio_line = &(struct gpiod_line){0}
+	};
+	int fd;
+
+	expect_value(mock_gpiod_line_event_get_fd, line, mock_intr.gpio_line);
+	will_return(mock_gpiod_line_event_get_fd, 42);
+
+	/* Check behavior when function succeeds */
+	fd = mcp23016_interrupt_get_fd(&mock_intr);
+
+	assert_int_equal(fd, 42);
+}
+
+void test_mcp23016_interrupt_get_fd_fail_flags(void **state)
+{
+	struct mcp23016_interrupt mock_intr = {
+		.gpio_chip = &(struct gpiod_chip){0},
+		.gpio_line = &(struct gpiod_line){0}
+	};
+	int fd;
+
+	/* Check behavior when edge events are not requested */
+	fd = mcp23016_interrupt_get_fd(&mock_intr);
+
+	assert_int_equal(fd, -1);
+	assert_int_equal(errno, EINVAL);
+}
+
+void test_mcp23016_interrupt_read_events(void **state)
+{
+	struct mcp23016_interrupt mock_intr = {
+		.flags = MCP23016_INTERRUPT_EVENTS,
+		.gpio_chip = &(struct gpiod_chip){0},
+		.gpio_line = &(struct gpiod_line){0}
+	};
+	int res;
+
+	expect_value_count(mock_gpiod_line_event_wait, line, mock_intr.gpio_line, 3);
+	expect_any_count(mock_gpiod_line_event_wait, timeout, 3);
+	will_return(mock_gpiod_line_event_wait, 1);
+
+	expect_value(mock_gpiod_line_event_read_multiple, line, mock_intr.gpio_line);
+	expect_any(mock_gpiod_line_event_read_multiple, events);
+	expect_value(mock_gpiod_line_event_read_multiple, num_events, EVENT_CHUNK);
+	will_return(mock_gpiod_line_event_read_multiple, EVENT_CHUNK);
+
+	will_return(mock_gpiod_line_event_wait, 1);
+
+	expect_value(mock_gpiod_line_event_read_multiple, line, mock_intr.gpio_line);
+	expect_any(mock_gpiod_line_event_read_multiple, events);
+	expect_value(mock_gpiod_line_event_read_multiple, num_events, EVENT_CHUNK);
+	will_return(mock_gpiod_line_event_read_multiple, 2);
+
+	will_return(mock_gpiod_line_event_wait, 0);
+
+	/* Check behavior when function succeeds */
+	res = mcp23016_interrupt_read_events(&mock_intr);
+
+	assert_int_equal(res, EVENT_CHUNK + 2);
+}
+
+void test_mcp23016_interrupt_read_events_fail(void **state)
+{
+	struct mcp23016_interrupt mock_intr = {
+		.flags = MCP23016_INTERRUPT_EVENTS,
+		.gpio_chip = &(struct gpiod_chip){0},
+		.gpio_line = &(struct gpiod_line){0}
+	};
+	int res;
+
+	expect_any(mock_gpiod_line_event_wait, line);
+	expect_any(mock_gpiod_line_event_wait, timeout);
+	will_return(mock_gpiod_line_event_wait, 1);
+
+	expect_any(mock_gpiod_line_event_read_multiple, line);
+	expect_any(mock_gpiod_line_event_read_multiple, events);
+	expect_any(mock_gpiod_line_event_read_multiple, num_events);
+	will_return(mock_gpiod_line_event_read_multiple, -1);
+
+	/* Check behavior when gpiod_line_event_read_multiple() fails */
+	res = mcp23016_interrupt_read_events(&mock_intr);
+
+	assert_int_equal(res, -1);
+}
+
+void test_mcp23016_interrupt_open_config_unsupported(void **state)
+{
+	struct mcp23016_interrupt_config config = {
+		.flags = MCP23016_INTERRUPT_EVENTS,
+		.debounce_period = 1000
+	};
+	struct mcp23016_interrupt *intr;
+
+	/* Check behavior when debouncing is requested */
+	intr = mcp23016_interrupt_open_config("/dev/gpiochip0", 0, &config);
+
+	assert_null(intr);
+	assert_int_equal(errno, ENOTSUP);
+
+	config.debounce_period = 0;
+	config.event_clock = MCP23016_CLOCK_REALTIME;
+
+	/* Check behavior when event clock is requested */
+	intr = mcp23016_interrupt_open_config("/dev/gpiochip0", 0, &config);
+
+	assert_null(intr);
+	assert_int_equal(errno, ENOTSUP);
+}
+
+int main(void)
+{
+	const struct CMUnitTest tests[] = {
+		cmocka_unit_test(test_mcp23016_interrupt_open),
+		cmocka_unit_test(test_mcp23016_interrupt_open_fail_calloc),
+		cmocka_unit_test(test_mcp23016_interrupt_open_fail_gpio_chip),
+		cmocka_unit_test(test_mcp23016_interrupt_open_fail_gpio_line),
+		cmocka_unit_test(test_mcp23016_interrupt_open_fail_gpio_line_flags),
+		cmocka_unit_test(test_mcp23016_interrupt_close),
+		cmocka_unit_test(test_mcp23016_has_interrupt),
+		cmocka_unit_test(test_mcp23016_interrupt_open_flags),
+		cmocka_unit_test(test_mcp23016_interrupt_wait),
+		cmocka_unit_test(test_mcp23016_interrupt_wait_fail_flags),
+		cmocka_unit_test(test_mcp23016_interrupt_get_fd),
+		cmocka_unit_test(test_mcp23016_interrupt_get_fd_fail_flags),
+		cmocka_unit_test(test_mcp23016_interrupt_read_events),
+		cmocka_unit_test(test_mcp23016_interrupt_read_events_fail),
+		cmocka_unit_test(test_mcp23016_interrupt_open_config_unsupported)
+	};
+
+	return cmocka_run_group_tests(tests, setup, teardown);
+}
@@ -0,0 +1,441 @@
+/* SPDX-License-Identifier: LGPL-2.1-or-later */
+/*
+ * Copyright (C) 2021 Steven Stallion <sstallion@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mcp23016-private.h"
+
+#include <errno.h>
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <cmocka.h>
+#include <gpiod.h>
+
+#include "hooks.h"
+#include "mocks.h"
+
+int setup(void **state)
+{
+	hook(calloc, mock_calloc);
+	hook(free, mock_free);
+	hook_gpiod();
+	return 0;
+}
+
+int teardown(void **state)
+{
+	unhook(calloc);
+	unhook(free);
+	unhook_gpiod();
+	return 0;
+}
+
+static void expect_open_config(struct gpiod_chip *chip, struct gpiod_line_settings *settings,
+		struct gpiod_line_config *line_cfg, struct gpiod_request_config *req_cfg)
+{
+	expect_string(mock_gpiod_chip_open, path, "/dev/gpiochip0");
+	will_return(mock_gpiod_chip_open, chip);
+
+	will_return(mock_gpiod_line_settings_new, settings);
+	will_return(mock_gpiod_line_config_new, line_cfg);
+	expect_value(mock_gpiod_line_config_add_line_settings, num_offsets, 1);
+	will_return(mock_gpiod_request_config_new, req_cfg);
+}
+
+static void expect_open_config_free(struct gpiod_chip *chip, struct gpiod_line_settings *settings,
+		struct gpiod_line_config *line_cfg, struct gpiod_request_config *req_cfg)
+{
+	expect_value(mock_gpiod_request_config_free, config, req_cfg);
+	expect_value(mock_gpiod_line_config_free, config, line_cfg);
+	expect_value(mock_gpiod_line_settings_free, settings, settings);
+	expect_value(mock_gpiod_chip_close, chip, chip);
+}
+
+void test_mcp23016_interrupt_open(void **state)
+{
+	struct mcp23016_interrupt mock_intr = {0};
+	struct gpiod_chip mock_gpiod_chip;
+	struct gpiod_line_settings mock_gpiod_line_settings = {0};
+	struct gpiod_line_config mock_gpiod_line_config = {0};
+	struct gpiod_request_config mock_gpiod_request_config = {0};
+	struct gpiod_line_request mock_gpiod_line_request;
+	struct mcp23016_interrupt *intr;
+
+	expect_value(mock_calloc, nmemb, 1);
+	expect_value(mock_calloc, size, sizeof(mock_intr));
+	will_return(mock_calloc, &mock_intr);
+
+	expect_open_config(&mock_gpiod_chip, &mock_gpiod_line_settings,
+			&mock_gpiod_line_config, &mock_gpiod_request_config);
+
+	expect_value(mock_gpiod_chip_request_lines, chip, &mock_gpiod_chip);
+	expect_value(mock_gpiod_chip_request_lines, req_cfg, &mock_gpiod_request_config);
+	expect_value(mock_gpiod_chip_request_lines, line_cfg, &mock_gpiod_line_config);
+	will_return(mock_gpiod_chip_request_lines, &mock_gpiod_line_request);
+
+	expect_open_config_free(&mock_gpiod_chip, &mock_gpiod_line_settings,
+			&mock_gpiod_line_config, &mock_gpiod_request_config);
+
+	/* Check behavior when function succeeds */
+	intr = mcp23016_interrupt_open("/dev/gpiochip0", 3);
+
+	assert_non_null(intr);
+	assert_int_equal(intr->offset, 3);
+	assert_ptr_equal(intr->gpio_request, &mock_gpiod_line_request);
+	assert_null(intr->gpio_events);
+
+	assert_int_equal(mock_gpiod_line_config.offset, 3);
+	assert_int_equal(mock_gpiod_line_config.settings.direction, GPIOD_LINE_DIRECTION_INPUT);
+	assert_int_equal(mock_gpiod_line_config.settings.edge, 0);
+	assert_true(mock_gpiod_line_config.settings.active_low);
+	assert_int_equal(mock_gpiod_line_config.settings.debounce_period, 0);
+	assert_string_equal(mock_gpiod_request_config.consumer, CONSUMER);
+	assert_int_equal(mock_gpiod_request_config.event_buffer_size, EVENT_CHUNK);
+}
+
+void test_mcp23016_interrupt_open_config(void **state)
+{
+	const struct mcp23016_interrupt_config config = {
+		.flags = MCP23016_INTERRUPT_EVENTS,
+		.debounce_period = 500,
+		.event_buffer_size = 64,
+		.event_clock = MCP23016_CLOCK_REALTIME
+	};
+	struct mcp23016_interrupt mock_intr = {0};
+	struct gpiod_chip mock_gpiod_chip;
+	struct gpiod_line_settings mock_gpiod_line_settings = {0};
+	struct gpiod_line_config mock_gpiod_line_config = {0};
+	struct gpiod_request_config mock_gpiod_request_config = {0};
+	struct gpiod_line_request mock_gpiod_line_request;
+	struct gpiod_edge_event_buffer mock_gpiod_edge_event_buffer;
+	struct mcp23016_interrupt *intr;
+
+	expect_any(mock_calloc, nmemb);
+	expect_any(mock_calloc, size);
+	will_return(mock_calloc, &mock_intr);
+
+	expect_open_config(&mock_gpiod_chip, &mock_gpiod_line_settings,
+			&mock_gpiod_line_config, &mock_gpiod_request_config);
+
+	expect_any(mock_gpiod_chip_request_lines, chip);
+	expect_any(mock_gpiod_chip_request_lines, req_cfg);
+	expect_any(mock_gpiod_chip_request_lines, line_cfg);
+	will_return(mock_gpiod_chip_request_lines, &mock_gpiod_line_request);
+
+	expect_value(mock_gpiod_edge_event_buffer_new, capacity, 64);
+	will_return(mock_gpiod_edge_event_buffer_new, &mock_gpiod_edge_event_buffer);
+
+	expect_open_config_free(&mock_gpiod_chip, &mock_gpiod_line_settings,
+			&mock_gpiod_line_config, &mock_gpiod_request_config);
+
+	/* Check behavior when function succeeds */
+	intr = mcp23016_interrupt_open_config("/dev/gpiochip0", 0, &config);
+
+	assert_non_null(intr);
+	assert_int_equal(intr->flags, MCP23016_INTERRUPT_EVENTS);
+	assert_ptr_equal(intr->gpio_events, &mock_gpiod_edge_event_buffer);
+
+	assert_int_equal(mock_gpiod_line_config.settings.edge, GPIOD_LINE_EDGE_RISING);
+	assert_true(mock_gpiod_line_config.settings.active_low);
+	assert_int_equal(mock_gpiod_line_config.settings.debounce_period, 500);
+	assert_int_equal(mock_gpiod_line_config.settings.event_clock, GPIOD_LINE_CLOCK_REALTIME);
+	assert_int_equal(mock_gpiod_request_config.event_buffer_size, 64);
+}
+
+void test_mcp23016_interrupt_open_config_invalid(void **state)
+{
+	const struct mcp23016_interrupt_config config = {
+		.event_clock = MCP23016_CLOCK_HTE + 1
+	};
+	struct mcp23016_interrupt *intr;
+
+	/* Check behavior when event clock is invalid */
+	intr = mcp23016_interrupt_open_config("/dev/gpiochip0", 0, &config);
+
+	assert_null(intr);
+	assert_int_equal(errno, EINVAL);
+}
+
+void test_mcp23016_interrupt_open_fail_calloc(void **state)
+{
+	struct mcp23016_interrupt *intr;
+
+	expect_any(mock_calloc, nmemb);
+	expect_any(mock_calloc, size);
+	will_return(mock_calloc, NULL);
+
+	/* Check behavior when calloc() fails */
+	intr = mcp23016_interrupt_open("/dev/gpiochip0", 0);
+
+	assert_null(intr);
+}
+
+void test_mcp23016_interrupt_open_fail_gpio_chip(void **state)
+{
+	struct mcp23016_interrupt mock_intr = {0};
+	struct mcp23016_interrupt *intr;
+
+	expect_any(mock_calloc, nmemb);
+	expect_any(mock_calloc, size);
+	will_return(mock_calloc, &mock_intr);
+
+	expect_any(mock_gpiod_chip_open, path);
+	will_return(mock_gpiod_chip_open, NULL);
+
+	expect_value(mock_free, ptr, &mock_intr);
+
+	/* Check behavior when gpiod_chip_open() fails */
+	intr = mcp23016_interrupt_open("/dev/gpiochip0", 0);
+
+	assert_null(intr);
+}
+
+void test_mcp23016_interrupt_open_fail_gpio_request(void **state)
+{
+	struct mcp23016_interrupt mock_intr = {0};
+	struct gpiod_chip mock_gpiod_chip;
+	struct gpiod_line_settings mock_gpiod_line_settings = {0};
+	struct gpiod_line_config mock_gpiod_line_config = {0};
+	struct gpiod_request_config mock_gpiod_request_config = {0};
+	struct mcp23016_interrupt *intr;
+
+	expect_any(mock_calloc, nmemb);
+	expect_any(mock_calloc, size);
+	will_return(mock_calloc, &mock_intr);
+
+	expect_open_config(&mock_gpiod_chip, &mock_gpiod_line_settings,
+			&mock_gpiod_line_config, &mock_gpiod_request_config);
+
+	expect_any(mock_gpiod_chip_request_lines, chip);
+	expect_any(mock_gpiod_chip_request_lines, req_cfg);
+	expect_any(mock_gpiod_chip_request_lines, line_cfg);
+	will_return(mock_gpiod_chip_request_lines, NULL);
+
+	expect_open_config_free(&mock_gpiod_chip, &mock_gpiod_line_settings,
+			&mock_gpiod_line_config, &mock_gpiod_request_config);
+
+	expect_value(mock_free, ptr, &mock_intr);
+
+	/* Check behavior when gpiod_chip_request_lines() fails */
+	intr = mcp23016_interrupt_open("/dev/gpiochip0", 0);
+
+	assert_null(intr);
+}
+
+void test_mcp23016_interrupt_open_fail_gpio_events(void **state)
+{
+	struct mcp23016_interrupt mock_intr = {0};
+	struct gpiod_chip mock_gpiod_chip;
+	struct gpiod_line_settings mock_gpiod_line_settings = {0};
+	struct gpiod_line_config mock_gpiod_line_config = {0};
+	struct gpiod_request_config mock_gpiod_request_config = {0};
+	struct gpiod_line_request mock_gpiod_line_request;
+	struct mcp23016_interrupt *intr;
+
+	expect_any(mock_calloc, nmemb);
+	expect_any(mock_calloc, size);
+	will_return(mock_calloc, &mock_intr);
+
+	expect_open_config(&mock_gpiod_chip, &mock_gpiod_line_settings,
+			&mock_gpiod_line_config, &mock_gpiod_request_config);
+
+	expect_any(mock_gpiod_chip_request_lines, chip);
+	expect_any(mock_gpiod_chip_request_lines, req_cfg);
+	expect_any(mock_gpiod_chip_request_lines, line_cfg);
+	will_return(mock_gpiod_chip_request_lines, &mock_gpiod_line_request);
+
+	expect_value(mock_gpiod_edge_event_buffer_new, capacity, EVENT_CHUNK);
+	will_return(mock_gpiod_edge_event_buffer_new, NULL);
+
+	expect_value(mock_gpiod_line_request_release, request, &mock_gpiod_line_request);
+
+	expect_open_config_free(&mock_gpiod_chip, &mock_gpiod_line_settings,
+			&mock_gpiod_line_config, &mock_gpiod_request_config);
+
+	expect_value(mock_free, ptr, &mock_intr);
+
+	/* Check behavior when gpiod_edge_event_buffer_new() fails */
+	intr = mcp23016_interrupt_open_flags("/dev/gpiochip0", 0, MCP23016_INTERRUPT_EVENTS);
+
+	assert_null(intr);
+}
+
+void test_mcp23016_interrupt_close(void **state)
+{
+	struct mcp23016_interrupt mock_intr;
+
+	mock_interrupt_init(&mock_intr, MCP23016_INTERRUPT_EVENTS);
+
+	expect_value(mock_gpiod_edge_event_buffer_free, buffer, mock_intr.gpio_events);
+	expect_value(mock_gpiod_line_request_release, request, mock_intr.gpio_request);
+	expect_value(mock_free, ptr, &mock_intr);
+
+	/* Check behavior when function succeeds */
+	mcp23016_interrupt_close(&mock_intr);
+}
+
+void test_mcp23016_has_interrupt(void **state)
+{
+	struct mcp23016_interrupt mock_intr;
+	int rc;
+
+	mock_interrupt_init(&mock_intr, 0);
+	mock_intr.offset = 5;
+
+	expect_value(mock_gpiod_line_request_get_value, request, mock_intr.gpio_request);
+	expect_value(mock_gpiod_line_request_get_value, offset, 5);
+	will_return(mock_gpiod_line_request_get_value, GPIOD_LINE_VALUE_ACTIVE);
+
+	/* Check behavior when function succeeds */
+	rc = mcp23016_has_interrupt(&mock_intr);
+
+	assert_int_equal(rc, 1);
+}
+
+void test_mcp23016_interrupt_wait(void **state)
+{
+	const struct timespec timeout = {.tv_sec = 1, .tv_nsec = 500};
+	struct mcp23016_interrupt mock_intr;
+	int rc;
+
+	mock_interrupt_init(&mock_intr, MCP23016_INTERRUPT_EVENTS);
+
+	expect_value(mock_gpiod_line_request_wait_edge_events, request, mock_intr.gpio_request);
+	expect_value(mock_gpiod_line_request_wait_edge_events, timeout_ns, 1000000500);
+	will_return(mock_gpiod_line_request_wait_edge_events, 1);
+
+	expect_value(mock_gpiod_line_request_read_edge_events, request, mock_intr.gpio_request);
+	expect_value(mock_gpiod_line_request_read_edge_events, buffer, mock_intr.gpio_events);
+	expect_value(mock_gpiod_line_request_read_edge_events, max_events, 1);
+	will_return(mock_gpiod_line_request_read_edge_events, 1);
+
+	/* Check behavior when edge event occurs */
+	rc = mcp23016_interrupt_wait(&mock_intr, &timeout);
+
+	assert_int_equal(rc, 1);
+
+	expect_value(mock_gpiod_line_request_wait_edge_events, request, mock_intr.gpio_request);
+	expect_value(mock_gpiod_line_request_wait_edge_events, timeout_ns, -1);
+	will_return(mock_gpiod_line_request_wait_edge_events, 0);
+
+	/* Check behavior when timeout expires */
+	rc = mcp23016_interrupt_wait(&mock_intr, NULL);
+
+	assert_int_equal(rc, 0);
+}
+
+void test_mcp23016_interrupt_wait_fail_flags(void **state)
+{
+	struct mcp23016_interrupt mock_intr;
+	int rc;
+
+	mock_interrupt_init(&mock_intr, 0);
+
+	/* Check behavior when edge events are not requested */
+	rc = mcp23016_interrupt_wait(&mock_intr, NULL);
+
+	assert_int_equal(rc, -1);
+	assert_int_equal(errno, EINVAL);
+}
+
+void test_mcp23016_interrupt_get_fd(void **state)
+{
+	struct mcp23016_interrupt mock_intr;
+	int rc;
+
+	mock_interrupt_init(&mock_intr, MCP23016_INTERRUPT_EVENTS);
+
+	expect_value(mock_gpiod_line_request_get_fd, request, mock_intr.gpio_request);
+	will_return(mock_gpiod_line_request_get_fd, 42);
+
+	/* Check behavior when function succeeds */
+	rc = mcp23016_interrupt_get_fd(&mock_intr);
+
+	assert_int_equal(rc, 42);
+}
+
+void test_mcp23016_interrupt_read_events(void **state)
+{
+	struct mcp23016_interrupt mock_intr;
+	int rc;
+
+	mock_interrupt_init(&mock_intr, MCP23016_INTERRUPT_EVENTS);
+
+	expect_value_count(mock_gpiod_line_request_wait_edge_events, request,
+			mock_intr.gpio_request, 3);
+	expect_value_count(mock_gpiod_line_request_wait_edge_events, timeout_ns, 0, 3);
+	will_return(mock_gpiod_line_request_wait_edge_events, 1);
+	will_return(mock_gpiod_line_request_wait_edge_events, 1);
+	will_return(mock_gpiod_line_request_wait_edge_events, 0);
+
+	expect_value_count(mock_gpiod_line_request_read_edge_events, request,
+			mock_intr.gpio_request, 2);
+	expect_value_count(mock_gpiod_line_request_read_edge_events, buffer,
+			mock_intr.gpio_events, 2);
+	expect_value_count(mock_gpiod_line_request_read_edge_events, max_events, EVENT_CHUNK, 2);
+	will_return(mock_gpiod_line_request_read_edge_events, EVENT_CHUNK);
+	will_return(mock_gpiod_line_request_read_edge_events, 3);
+
+	/* Check behavior when function succeeds */
+	rc = mcp23016_interrupt_read_events(&mock_intr);
+
+	assert_int_equal(rc, EVENT_CHUNK + 3);
+}
+
+void test_mcp23016_interrupt_read_events_fail(void **state)
+{
+	struct mcp23016_interrupt mock_intr;
+	int rc;
+
+	mock_interrupt_init(&mock_intr, MCP23016_INTERRUPT_EVENTS);
+
+	expect_value(mock_gpiod_line_request_wait_edge_events, request, mock_intr.gpio_request);
+	expect_value(mock_gpiod_line_request_wait_edge_events, timeout_ns, 0);
+	will_return(mock_gpiod_line_request_wait_edge_events, 1);
+
+	expect_any(mock_gpiod_line_request_read_edge_events, request);
+	expect_any(mock_gpiod_line_request_read_edge_events, buffer);
+	expect_any(mock_gpiod_line_request_read_edge_events, max_events);
+	will_return(mock_gpiod_line_request_read_edge_events, -1);
+
+	/* Check behavior when gpiod_line_request_read_edge_events() fails */
+	rc = mcp23016_interrupt_read_events(&mock_intr);
+
+	assert_int_equal(rc, -1);
+}
+
+int main(void)
+{
+	const struct CMUnitTest tests[] = {
+		cmocka_unit_test(test_mcp23016_interrupt_open),
+		cmocka_unit_test(test_mcp23016_interrupt_open_config),
+		cmocka_unit_test(test_mcp23016_interrupt_open_config_invalid),
+		cmocka_unit_test(test_mcp23016_interrupt_open_fail_calloc),
+		cmocka_unit_test(test_mcp23016_interrupt_open_fail_gpio_chip),
+		cmocka_unit_test(test_mcp23016_interrupt_open_fail_gpio_request),
+		cmocka_unit_test(test_mcp23016_interrupt_open_fail_gpio_events),
+		cmocka_unit_test(test_mcp23016_interrupt_close),
+		cmocka_unit_test(test_mcp23016_has_interrupt),
+		cmocka_unit_test(test_mcp23016_interrupt_wait),
+		cmocka_unit_test(test_mcp23016_interrupt_wait_fail_flags),
+		cmocka_unit_test(test_mcp23016_interrupt_get_fd),
+		cmocka_unit_test(test_mcp23016_interrupt_read_events),
+		cmocka_unit_test(test_mcp23016_interrupt_read_events_fail)
+	};
+
+	return cmocka_run_group_tests(tests, setup, teardown);
+}
@@ -23,7 +23,6 @@
 #include <stdarg.h>
 #include <stddef.h>
 #include <cmocka.h>
-#include <gpiod.h>
 #include <i2cd.h>
 
 #include "hooks.h"
@@ -33,16 +32,11 @@ int setup(void **state)
 {
 	hook(calloc, mock_calloc);
 	hook(free, mock_free);
-	hook(gpiod_chip_open, mock_gpiod_chip_open);
-	hook(gpiod_chip_close, mock_gpiod_chip_close);
-	hook(gpiod_chip_get_line, mock_gpiod_chip_get_line);
-	hook(gpiod_line_release, mock_gpiod_line_release);
-	hook(gpiod_line_request_input_flags, mock_gpiod_line_request_input_flags);
-	hook(gpiod_line_get_value, mock_gpiod_line_get_value);
 	hook(i2cd_open, mock_i2cd_open);
 	hook(i2cd_close, mock_i2cd_close);
 	hook(i2cd_write, mock_i2cd_write);
 	hook(i2cd_write_read, mock_i2cd_write_read);
+	hook(i2cd_transfer, mock_i2cd_transfer);
 	return 0;
 }
 
@@ -50,16 +44,11 @@ int teardown(void **state)
 {
 	unhook(calloc);
 	unhook(free);
-	unhook(gpiod_chip_open);
-	unhook(gpiod_chip_close);
-	unhook(gpiod_chip_get_line);
-	unhook(gpiod_line_release);
-	unhook(gpiod_line_request_input_flags);
-	unhook(gpiod_line_get_value);
 	unhook(i2cd_open);
 	unhook(i2cd_close);
 	unhook(i2cd_write);
 	unhook(i2cd_write_read);
+	unhook(i2cd_transfer);
 	return 0;
 }
 
@@ -150,73 +139,860 @@ void test_mcp23016_close(void **state)
 	mcp23016_close(&mock_dev);
 }
 
+void test_mcp23016_bus_open(void **state)
+{
+	struct mcp23016_bus mock_bus = {0};
+	struct i2cd mock_i2cd;
+	struct mcp23016_bus *bus;
+
+	expect_value(mock_calloc, nmemb, 1);
+	expect_value(mock_calloc, size, sizeof(mock_bus));
+	will_return(mock_calloc, &mock_bus);
+
+	expect_string(mock_i2cd_open, path, "/dev/i2c-0");
+	will_return(mock_i2cd_open, &mock_i2cd);
+
+	/* Check behavior when function succeeds */
+	bus = mcp23016_bus_open("/dev/i2c-0");
+
+	assert_non_null(bus);
+	assert_ptr_equal(bus->i2c_dev, &mock_i2cd);
+	assert_int_equal(bus->refcnt, 1);
+}
+
+void test_mcp23016_bus_open_fail_calloc(void **state)
+{
+	struct mcp23016_bus *bus;
+
+	expect_any(mock_calloc, nmemb);
+	expect_any(mock_calloc, size);
+	will_return(mock_calloc, NULL);
+
+	/* Check behavior when calloc() fails */
+	bus = mcp23016_bus_open("/dev/i2c-0");
+
+	assert_null(bus);
+}
+
+void test_mcp23016_bus_open_fail_i2c_dev(void **state)
+{
+	struct mcp23016_bus mock_bus = {0};
+	struct mcp23016_bus *bus;
+
+	expect_any(mock_calloc, nmemb);
+	expect_any(mock_calloc, size);
+	will_return(mock_calloc, &mock_bus);
+
+	expect_any(mock_i2cd_open, path);
+	will_return(mock_i2cd_open, NULL);
+
+	expect_value(mock_free, ptr, &mock_bus);
+
+	/* Check behavior when i2cd_open() fails */
+	bus = mcp23016_bus_open("/dev/i2c-0");
+
+	assert_null(bus);
+}
+
+void test_mcp23016_bus_close(void **state)
+{
+	struct mcp23016_bus mock_bus = {
+		.i2c_dev = &(struct i2cd){0},
+		.refcnt = 2
+	};
+
+	/* Check behavior when references remain */
+	mcp23016_bus_close(&mock_bus);
+
+	assert_int_equal(mock_bus.refcnt, 1);
+
+	expect_value(mock_i2cd_close, dev, mock_bus.i2c_dev);
+	expect_value(mock_free, ptr, &mock_bus);
+
+	/* Check behavior when last reference is released */
+	mcp23016_bus_close(&mock_bus);
+}
+
+void test_mcp23016_open_on_bus(void **state)
+{
+	struct mcp23016_bus mock_bus = {
+		.i2c_dev = &(struct i2cd){0},
+		.refcnt = 1
+	};
+	struct mcp23016_device mock_dev = {0};
+	struct mcp23016_device *dev;
+
+	expect_value(mock_calloc, nmemb, 1);
+	expect_value(mock_calloc, size, sizeof(mock_dev));
+	will_return(mock_calloc, &mock_dev);
+
+	/* Check behavior when function succeeds */
+	dev = mcp23016_open_on_bus(&mock_bus, END_ADDR - BASE_ADDR);
+
+	assert_non_null(dev);
+	assert_int_equal(dev->i2c_addr, END_ADDR);
+	assert_ptr_equal(dev->i2c_dev, mock_bus.i2c_dev);
+	assert_ptr_equal(dev->bus, &mock_bus);
+	assert_int_equal(mock_bus.refcnt, 2);
+}
+
+void test_mcp23016_open_on_bus_fail_i2c_addr(void **state)
+{
+	struct mcp23016_bus mock_bus = {
+		.i2c_dev = &(struct i2cd){0},
+		.refcnt = 1
+	};
+	struct mcp23016_device mock_dev = {0};
+	struct mcp23016_device *dev;
+
+	expect_any(mock_calloc, nmemb);
+	expect_any(mock_calloc, size);
+	will_return(mock_calloc, &mock_dev);
+
+	expect_value(mock_free, ptr, &mock_dev);
+
+	/* Check behavior when I2C address invalid */
+	dev = mcp23016_open_on_bus(&mock_bus, (END_ADDR - BASE_ADDR) + 1);
+
+	assert_int_equal(errno, EINVAL);
+	assert_null(dev);
+	assert_int_equal(mock_bus.refcnt, 1);
+}
+
+void test_mcp23016_close_on_bus(void **state)
+{
+	struct mcp23016_bus mock_bus = {
+		.i2c_dev = &(struct i2cd){0},
+		.refcnt = 2
+	};
+	struct mcp23016_device mock_dev = {
+		.i2c_addr = BASE_ADDR,
+		.i2c_dev = mock_bus.i2c_dev,
+		.bus = &mock_bus
+	};
+
+	expect_value(mock_free, ptr, &mock_dev);
+
+	/* Check behavior when device is opened on a shared bus */
+	mcp23016_close(&mock_dev);
+
+	assert_int_equal(mock_bus.refcnt, 1);
+}
+
 void test_mcp23016_reset(void **state)
 {
 	struct mcp23016_device mock_dev = {
 		.i2c_addr = BASE_ADDR,
-		.i2c_dev = &(struct i2cd){0}
-	};
-	uint8_t mock_bufs[][3] = {
-		{REG_IODIR0,  0xff, 0xff},
-		{REG_OLAT0,   0x00, 0x00},
-		{REG_IPOL0,   0x00, 0x00},
-		{REG_IOCON0,  0x00, 0x00},
-		{REG_INTCAP0, 0x00, 0x00}
+		.i2c_dev = &(struct i2cd){0}
+	};
+	uint8_t mock_write_bufs[][3] = {
+		{REG_IOCON0,  0x00, 0x00},
+		{REG_IPOL0,   0x00, 0x00},
+		{REG_IODIR0,  0xff, 0xff},
+		{REG_OLAT0,   0x00, 0x00},
+		{REG_INTCAP0}
+	};
+	int rc;
+
+	/* I/O direction must be written before the output latches */
+	expect_value(mock_i2cd_transfer, dev, mock_dev.i2c_dev);
+	expect_value(mock_i2cd_transfer, nmsgs, 6);
+	expect_i2cd_transfer_write(mock_dev.i2c_addr, mock_write_bufs[0], 3);
+	expect_i2cd_transfer_write(mock_dev.i2c_addr, mock_write_bufs[1], 3);
+	expect_i2cd_transfer_write(mock_dev.i2c_addr, mock_write_bufs[2], 3);
+	expect_i2cd_transfer_write(mock_dev.i2c_addr, mock_write_bufs[3], 3);
+	expect_i2cd_transfer_write(mock_dev.i2c_addr, mock_write_bufs[4], 1);
+	expect_i2cd_transfer_read(mock_dev.i2c_addr, NULL, 2);
+	will_return(mock_i2cd_transfer, 0);
+
+	/* Check behavior when function succeeds */
+	rc = mcp23016_reset(&mock_dev);
+
+	assert_return_code(rc, 0);
+	assert_int_equal(mock_dev.cache_valid, CACHE_REGS);
+	assert_int_equal(mock_dev.cache[CACHE_INDEX(REG_IODIR0)], 0xffff);
+}
+
+void test_mcp23016_configure(void **state)
+{
+	struct mcp23016_device mock_dev = {
+		.i2c_addr = BASE_ADDR,
+		.i2c_dev = &(struct i2cd){0}
+	};
+	struct mcp23016_config config = {
+		.output = 0x1001,
+		.polarity = 0x2002,
+		.direction = 0x3003,
+		.control = MCP23016_CONTROL_IARES_FAST
+	};
+	uint8_t mock_write_bufs[][3] = {
+		{REG_IOCON0,  0x01, 0x00},
+		{REG_IPOL0,   0x02, 0x20},
+		{REG_OLAT0,   0x01, 0x10},
+		{REG_IODIR0,  0x03, 0x30},
+		{REG_INTCAP0}
+	};
+	int rc;
+
+	expect_value(mock_i2cd_transfer, dev, mock_dev.i2c_dev);
+	expect_value(mock_i2cd_transfer, nmsgs, 6);
+	expect_i2cd_transfer_write(mock_dev.i2c_addr, mock_write_bufs[0], 3);
+	expect_i2cd_transfer_write(mock_dev.i2c_addr, mock_write_bufs[1], 3);
+	expect_i2cd_transfer_write(mock_dev.i2c_addr, mock_write_bufs[2], 3);
+	expect_i2cd_transfer_write(mock_dev.i2c_addr, mock_write_bufs[3], 3);
+	expect_i2cd_transfer_write(mock_dev.i2c_addr, mock_write_bufs[4], 1);
+	expect_i2cd_transfer_read(mock_dev.i2c_addr, NULL, 2);
+	will_return(mock_i2cd_transfer, 0);
+
+	/* Check behavior when function succeeds */
+	rc = mcp23016_configure(&mock_dev, &config);
+
+	assert_return_code(rc, 0);
+	assert_int_equal(mock_dev.cache[CACHE_INDEX(REG_OLAT0)], 0x1001);
+	assert_int_equal(mock_dev.cache[CACHE_INDEX(REG_IPOL0)], 0x2002);
+	assert_int_equal(mock_dev.cache[CACHE_INDEX(REG_IODIR0)], 0x3003);
+	assert_int_equal(mock_dev.cache[CACHE_INDEX(REG_IOCON0)], 0x0001);
+}
+
+void test_mcp23016_configure_fail(void **state)
+{
+	struct mcp23016_device mock_dev = {
+		.i2c_addr = BASE_ADDR,
+		.i2c_dev = &(struct i2cd){0}
+	};
+	struct mcp23016_config config = {0};
+	int rc;
+
+	expect_any(mock_i2cd_transfer, dev);
+	expect_any(mock_i2cd_transfer, nmsgs);
+	expect_any_count(mock_i2cd_transfer, addr, 6);
+	expect_any_count(mock_i2cd_transfer, flags, 6);
+	expect_any_count(mock_i2cd_transfer, len, 6);
+	expect_any_count(mock_i2cd_transfer, buf, 5);
+	will_return(mock_i2cd_transfer, NULL); /* buf */
+	will_return(mock_i2cd_transfer, -1);
+
+	/* Check behavior when i2cd_transfer() fails */
+	rc = mcp23016_configure(&mock_dev, &config);
+
+	assert_int_equal(rc, -1);
+	assert_int_equal(mock_dev.cache_valid, 0);
+}
+
+void test_mcp23016_bus_set_output(void **state)
+{
+	struct mcp23016_bus mock_bus = {
+		.i2c_dev = &(struct i2cd){0},
+		.refcnt = 3
+	};
+	struct mcp23016_device mock_devs[] = {
+		{.i2c_addr = BASE_ADDR, .i2c_dev = mock_bus.i2c_dev, .bus = &mock_bus},
+		{.i2c_addr = END_ADDR, .i2c_dev = mock_bus.i2c_dev, .bus = &mock_bus}
+	};
+	struct mcp23016_output outputs[] = {
+		{.dev = &mock_devs[0], .val = 0xaa55},
+		{.dev = &mock_devs[1], .val = 0x1234}
+	};
+	uint8_t mock_write_bufs[][3] = {
+		{REG_OLAT0, 0x55, 0xaa},
+		{REG_OLAT0, 0x34, 0x12}
+	};
+	int rc;
+
+	expect_value(mock_i2cd_transfer, dev, mock_bus.i2c_dev);
+	expect_value(mock_i2cd_transfer, nmsgs, 2);
+	expect_i2cd_transfer_write(BASE_ADDR, mock_write_bufs[0], 3);
+	expect_i2cd_transfer_write(END_ADDR, mock_write_bufs[1], 3);
+	will_return(mock_i2cd_transfer, 0);
+
+	/* Check behavior when function succeeds */
+	rc = mcp23016_bus_set_output(&mock_bus, outputs, 2);
+
+	assert_return_code(rc, 0);
+	assert_int_equal(mock_devs[0].cache[CACHE_INDEX(REG_OLAT0)], 0xaa55);
+	assert_int_equal(mock_devs[1].cache[CACHE_INDEX(REG_OLAT0)], 0x1234);
+}
+
+void test_mcp23016_bus_set_output_fail_bus(void **state)
+{
+	struct mcp23016_bus mock_bus = {
+		.i2c_dev = &(struct i2cd){0},
+		.refcnt = 1
+	};
+	struct mcp23016_device mock_dev = {
+		.i2c_addr = BASE_ADDR,
+		.i2c_dev = &(struct i2cd){0}
+	};
+	struct mcp23016_output outputs[] = {
+		{.dev = &mock_dev, .val = 0xaa55}
+	};
+	int rc;
+
+	/* Check behavior when device is not opened on bus */
+	rc = mcp23016_bus_set_output(&mock_bus, outputs, 1);
+
+	assert_int_equal(rc, -1);
+	assert_int_equal(errno, EINVAL);
+
+	/* Check behavior when n exceeds MCP23016_DEVICE_MAX */
+	rc = mcp23016_bus_set_output(&mock_bus, outputs, MCP23016_DEVICE_MAX + 1);
+
+	assert_int_equal(rc, -1);
+	assert_int_equal(errno, EINVAL);
+}
+
+void test_mcp23016_get_port(void **state)
+{
+	struct mcp23016_device mock_dev = {
+		.i2c_addr = BASE_ADDR,
+		.i2c_dev = &(struct i2cd){0}
+	};
+	uint8_t mock_write_buf[] = {REG_GP0};
+	uint8_t mock_read_buf[] = {0x55, 0xaa};
+	uint16_t port;
+	int rc;
+
+	expect_value(mock_i2cd_write_read, dev, mock_dev.i2c_dev);
+	expect_value(mock_i2cd_write_read, addr, mock_dev.i2c_addr);
+	expect_memory(mock_i2cd_write_read, write_buf, mock_write_buf, sizeof(mock_write_buf));
+	expect_value(mock_i2cd_write_read, write_len, sizeof(mock_write_buf));
+	will_return(mock_i2cd_write_read, mock_read_buf); /* read_buf */
+	expect_value(mock_i2cd_write_read, read_len, sizeof(mock_read_buf));
+	will_return(mock_i2cd_write_read, 0);
+
+	/* Check behavior when function succeeds */
+	rc = mcp23016_get_port(&mock_dev, &port);
+
+	assert_return_code(rc, 0);
+	assert_int_equal(port, 0xaa55);
+}
+
+void test_mcp23016_set_port(void **state)
+{
+	struct mcp23016_device mock_dev = {
+		.i2c_addr = BASE_ADDR,
+		.i2c_dev = &(struct i2cd){0}
+	};
+	uint8_t mock_buf[] = {REG_GP0, 0x55, 0xaa};
+	int rc;
+
+	expect_value(mock_i2cd_write, dev, mock_dev.i2c_dev);
+	expect_value(mock_i2cd_write, addr, mock_dev.i2c_addr);
+	expect_memory(mock_i2cd_write, buf, mock_buf, sizeof(mock_buf));
+	expect_value(mock_i2cd_write, len, sizeof(mock_buf));
+	will_return(mock_i2cd_write, 0);
+
+	/* Check behavior when function succeeds */
+	rc = mcp23016_set_port(&mock_dev, 0xaa55);
+
+	assert_return_code(rc, 0);
+}
+
+void test_mcp23016_get_port_burst(void **state)
+{
+	struct mcp23016_device mock_dev = {
+		.i2c_addr = BASE_ADDR,
+		.i2c_dev = &(struct i2cd){0}
+	};
+	uint8_t mock_write_buf[] = {REG_GP0};
+	uint8_t mock_read_buf[] = {0x55, 0xaa, 0x01, 0x80, 0xff, 0x00};
+	uint16_t samples[3];
+	int rc;
+
+	expect_value(mock_i2cd_write_read, dev, mock_dev.i2c_dev);
+	expect_value(mock_i2cd_write_read, addr, mock_dev.i2c_addr);
+	expect_memory(mock_i2cd_write_read, write_buf, mock_write_buf, sizeof(mock_write_buf));
+	expect_value(mock_i2cd_write_read, write_len, sizeof(mock_write_buf));
+	will_return(mock_i2cd_write_read, mock_read_buf); /* read_buf */
+	expect_value(mock_i2cd_write_read, read_len, sizeof(mock_read_buf));
+	will_return(mock_i2cd_write_read, 0);
+
+	/* Check behavior when function succeeds */
+	rc = mcp23016_get_port_burst(&mock_dev, samples, 3);
+
+	assert_return_code(rc, 0);
+	assert_int_equal(samples[0], 0xaa55);
+	assert_int_equal(samples[1], 0x8001);
+	assert_int_equal(samples[2], 0x00ff);
+}
+
+void test_mcp23016_get_port_burst_fail_n(void **state)
+{
+	struct mcp23016_device mock_dev = {
+		.i2c_addr = BASE_ADDR,
+		.i2c_dev = &(struct i2cd){0}
+	};
+	uint16_t samples[1];
+	int rc;
+
+	/* Check behavior when n is zero */
+	rc = mcp23016_get_port_burst(&mock_dev, samples, 0);
+
+	assert_int_equal(rc, -1);
+	assert_int_equal(errno, EINVAL);
+
+	/* Check behavior when n exceeds MCP23016_BURST_MAX */
+	rc = mcp23016_get_port_burst(&mock_dev, samples, MCP23016_BURST_MAX + 1);
+
+	assert_int_equal(rc, -1);
+	assert_int_equal(errno, EINVAL);
+}
+
+void test_mcp23016_set_port_stream(void **state)
+{
+	struct mcp23016_device mock_dev = {
+		.i2c_addr = BASE_ADDR,
+		.i2c_dev = &(struct i2cd){0}
+	};
+	const uint16_t vals[] = {0x0001, 0x8000};
+	uint8_t mock_buf[] = {REG_GP0, 0x01, 0x00, 0x00, 0x80, 0x01, 0x00, 0x00, 0x80};
+	int rc;
+
+	expect_value(mock_i2cd_write, dev, mock_dev.i2c_dev);
+	expect_value(mock_i2cd_write, addr, mock_dev.i2c_addr);
+	expect_memory(mock_i2cd_write, buf, mock_buf, sizeof(mock_buf));
+	expect_value(mock_i2cd_write, len, sizeof(mock_buf));
+	will_return(mock_i2cd_write, 0);
+
+	/* Check behavior when function succeeds */
+	rc = mcp23016_set_port_stream(&mock_dev, vals, 2, 2);
+
+	assert_return_code(rc, 0);
+	assert_int_equal(mock_dev.cache_valid, CACHE_VALID(REG_OLAT0));
+	assert_int_equal(mock_dev.cache[CACHE_INDEX(REG_OLAT0)], 0x8000);
+}
+
+void test_mcp23016_set_port_stream_chunk(void **state)
+{
+	struct mcp23016_device mock_dev = {
+		.i2c_addr = BASE_ADDR,
+		.i2c_dev = &(struct i2cd){0}
+	};
+	const uint16_t vals[] = {0xaa55};
+	uint8_t mock_buf[] = {REG_GP0, 0x55, 0xaa};
+	int rc;
+
+	expect_value(mock_i2cd_write, dev, mock_dev.i2c_dev);
+	expect_value(mock_i2cd_write, addr, mock_dev.i2c_addr);
+	expect_memory(mock_i2cd_write, buf, mock_buf, sizeof(mock_buf));
+	expect_value(mock_i2cd_write, len, 1 + STREAM_CHUNK * 2);
+	will_return(mock_i2cd_write, 0);
+
+	expect_value(mock_i2cd_write, dev, mock_dev.i2c_dev);
+	expect_value(mock_i2cd_write, addr, mock_dev.i2c_addr);
+	expect_memory(mock_i2cd_write, buf, mock_buf, sizeof(mock_buf));
+	expect_value(mock_i2cd_write, len, sizeof(mock_buf));
+	will_return(mock_i2cd_write, 0);
+
+	/* Check behavior when values span multiple messages */
+	rc = mcp23016_set_port_stream(&mock_dev, vals, 1, STREAM_CHUNK + 1);
+
+	assert_return_code(rc, 0);
+}
+
+void test_mcp23016_set_port_stream_fail(void **state)
+{
+	struct mcp23016_device mock_dev = {
+		.i2c_addr = BASE_ADDR,
+		.i2c_dev = &(struct i2cd){0},
+		.cache_valid = CACHE_REGS
+	};
+	const uint16_t vals[] = {0xaa55};
+	int rc;
+
+	/* Check behavior when count is zero */
+	rc = mcp23016_set_port_stream(&mock_dev, vals, 1, 0);
+
+	assert_int_equal(rc, -1);
+	assert_int_equal(errno, EINVAL);
+
+	expect_any(mock_i2cd_write, dev);
+	expect_any(mock_i2cd_write, addr);
+	expect_any(mock_i2cd_write, buf);
+	expect_any(mock_i2cd_write, len);
+	will_return(mock_i2cd_write, -1);
+
+	/* Check behavior when i2cd_write() fails */
+	rc = mcp23016_set_port_stream(&mock_dev, vals, 1, 1);
+
+	assert_int_equal(rc, -1);
+	assert_int_equal(mock_dev.cache_valid, CACHE_REGS & ~CACHE_VALID(REG_OLAT0));
+}
+
+void test_mcp23016_get_port8(void **state)
+{
+	struct mcp23016_device mock_dev = {
+		.i2c_addr = BASE_ADDR,
+		.i2c_dev = &(struct i2cd){0}
+	};
+	uint8_t mock_write_buf[] = {REG_GP1};
+	uint8_t mock_read_buf[] = {0xaa};
+	uint8_t port;
+	int rc;
+
+	expect_value(mock_i2cd_write_read, dev, mock_dev.i2c_dev);
+	expect_value(mock_i2cd_write_read, addr, mock_dev.i2c_addr);
+	expect_memory(mock_i2cd_write_read, write_buf, mock_write_buf, sizeof(mock_write_buf));
+	expect_value(mock_i2cd_write_read, write_len, sizeof(mock_write_buf));
+	will_return(mock_i2cd_write_read, mock_read_buf); /* read_buf */
+	expect_value(mock_i2cd_write_read, read_len, sizeof(mock_read_buf));
+	will_return(mock_i2cd_write_read, 0);
+
+	/* Check behavior when function succeeds */
+	rc = mcp23016_get_port8(&mock_dev, MCP23016_PORT_1, &port);
+
+	assert_return_code(rc, 0);
+	assert_int_equal(port, 0xaa);
+}
+
+void test_mcp23016_get_port8_fail_port(void **state)
+{
+	struct mcp23016_device mock_dev = {
+		.i2c_addr = BASE_ADDR,
+		.i2c_dev = &(struct i2cd){0}
+	};
+	uint8_t port;
+	int rc;
+
+	/* Check behavior when port invalid */
+	rc = mcp23016_get_port8(&mock_dev, MCP23016_PORT_1 + 1, &port);
+
+	assert_int_equal(rc, -1);
+	assert_int_equal(errno, EINVAL);
+}
+
+void test_mcp23016_set_port8(void **state)
+{
+	struct mcp23016_device mock_dev = {
+		.i2c_addr = BASE_ADDR,
+		.i2c_dev = &(struct i2cd){0},
+		.cache_valid = CACHE_VALID(REG_OLAT0),
+		.cache[CACHE_INDEX(REG_OLAT0)] = 0x0000
+	};
+	uint8_t mock_buf[] = {REG_GP1, 0xaa};
+	int rc;
+
+	expect_value(mock_i2cd_write, dev, mock_dev.i2c_dev);
+	expect_value(mock_i2cd_write, addr, mock_dev.i2c_addr);
+	expect_memory(mock_i2cd_write, buf, mock_buf, sizeof(mock_buf));
+	expect_value(mock_i2cd_write, len, sizeof(mock_buf));
+	will_return(mock_i2cd_write, 0);
+
+	/* Check behavior when function succeeds */
+	rc = mcp23016_set_port8(&mock_dev, MCP23016_PORT_1, 0xaa);
+
+	assert_return_code(rc, 0);
+	assert_int_equal(mock_dev.cache[CACHE_INDEX(REG_OLAT0)], 0xaa00);
+}
+
+void test_mcp23016_get_output(void **state)
+{
+	struct mcp23016_device mock_dev = {
+		.i2c_addr = BASE_ADDR,
+		.i2c_dev = &(struct i2cd){0}
+	};
+	uint8_t mock_write_buf[] = {REG_OLAT0};
+	uint8_t mock_read_buf[] = {0x55, 0xaa};
+	uint16_t output;
+	int rc;
+
+	expect_value(mock_i2cd_write_read, dev, mock_dev.i2c_dev);
+	expect_value(mock_i2cd_write_read, addr, mock_dev.i2c_addr);
+	expect_memory(mock_i2cd_write_read, write_buf, mock_write_buf, sizeof(mock_write_buf));
+	expect_value(mock_i2cd_write_read, write_len, sizeof(mock_write_buf));
+	will_return(mock_i2cd_write_read, mock_read_buf); /* read_buf */
+	expect_value(mock_i2cd_write_read, read_len, sizeof(mock_read_buf));
+	will_return(mock_i2cd_write_read, 0);
+
+	/* Check behavior when function succeeds */
+	rc = mcp23016_get_output(&mock_dev, &output);
+
+	assert_return_code(rc, 0);
+	assert_int_equal(output, 0xaa55);
+}
+
+void test_mcp23016_set_output(void **state)
+{
+	struct mcp23016_device mock_dev = {
+		.i2c_addr = BASE_ADDR,
+		.i2c_dev = &(struct i2cd){0}
+	};
+	uint8_t mock_buf[] = {REG_OLAT0, 0x55, 0xaa};
+	int rc;
+
+	expect_value(mock_i2cd_write, dev, mock_dev.i2c_dev);
+	expect_value(mock_i2cd_write, addr, mock_dev.i2c_addr);
+	expect_memory(mock_i2cd_write, buf, mock_buf, sizeof(mock_buf));
+	expect_value(mock_i2cd_write, len, sizeof(mock_buf));
+	will_return(mock_i2cd_write, 0);
+
+	/* Check behavior when function succeeds */
+	rc = mcp23016_set_output(&mock_dev, 0xaa55);
+
+	assert_return_code(rc, 0);
+}
+
+void test_mcp23016_get_output8(void **state)
+{
+	struct mcp23016_device mock_dev = {
+		.i2c_addr = BASE_ADDR,
+		.i2c_dev = &(struct i2cd){0}
+	};
+	uint8_t mock_write_buf[] = {REG_OLAT0};
+	uint8_t mock_read_buf[] = {0x55};
+	uint8_t output;
+	int rc;
+
+	expect_value(mock_i2cd_write_read, dev, mock_dev.i2c_dev);
+	expect_value(mock_i2cd_write_read, addr, mock_dev.i2c_addr);
+	expect_memory(mock_i2cd_write_read, write_buf, mock_write_buf, sizeof(mock_write_buf));
+	expect_value(mock_i2cd_write_read, write_len, sizeof(mock_write_buf));
+	will_return(mock_i2cd_write_read, mock_read_buf); /* read_buf */
+	expect_value(mock_i2cd_write_read, read_len, sizeof(mock_read_buf));
+	will_return(mock_i2cd_write_read, 0);
+
+	/* Check behavior when function succeeds */
+	rc = mcp23016_get_output8(&mock_dev, MCP23016_PORT_0, &output);
+
+	assert_return_code(rc, 0);
+	assert_int_equal(output, 0x55);
+	assert_int_equal(mock_dev.cache_valid, BIT(REG_OLAT0));
+}
+
+void test_mcp23016_get_output8_cached(void **state)
+{
+	struct mcp23016_device mock_dev = {
+		.i2c_addr = BASE_ADDR,
+		.i2c_dev = &(struct i2cd){0},
+		.cache_enabled = 1,
+		.cache_valid = BIT(REG_OLAT1),
+		.cache[CACHE_INDEX(REG_OLAT0)] = 0xaa00
+	};
+	uint8_t output;
+	int rc;
+
+	/* Check behavior when register is cached */
+	rc = mcp23016_get_output8(&mock_dev, MCP23016_PORT_1, &output);
+
+	assert_return_code(rc, 0);
+	assert_int_equal(output, 0xaa);
+}
+
+void test_mcp23016_get_output_cached_partial(void **state)
+{
+	struct mcp23016_device mock_dev = {
+		.i2c_addr = BASE_ADDR,
+		.i2c_dev = &(struct i2cd){0},
+		.cache_enabled = 1,
+		.cache_valid = BIT(REG_OLAT1),
+		.cache[CACHE_INDEX(REG_OLAT0)] = 0xaa00
+	};
+	uint8_t mock_write_buf[] = {REG_OLAT0};
+	uint8_t mock_read_buf[] = {0x55, 0xaa};
+	uint16_t output;
+	int rc;
+
+	expect_value(mock_i2cd_write_read, dev, mock_dev.i2c_dev);
+	expect_value(mock_i2cd_write_read, addr, mock_dev.i2c_addr);
+	expect_memory(mock_i2cd_write_read, write_buf, mock_write_buf, sizeof(mock_write_buf));
+	expect_value(mock_i2cd_write_read, write_len, sizeof(mock_write_buf));
+	will_return(mock_i2cd_write_read, mock_read_buf); /* read_buf */
+	expect_value(mock_i2cd_write_read, read_len, sizeof(mock_read_buf));
+	will_return(mock_i2cd_write_read, 0);
+
+	/* Check behavior when register is partially cached */
+	rc = mcp23016_get_output(&mock_dev, &output);
+
+	assert_return_code(rc, 0);
+	assert_int_equal(output, 0xaa55);
+	assert_int_equal(mock_dev.cache_valid, CACHE_VALID(REG_OLAT0));
+}
+
+void test_mcp23016_set_output8(void **state)
+{
+	struct mcp23016_device mock_dev = {
+		.i2c_addr = BASE_ADDR,
+		.i2c_dev = &(struct i2cd){0}
+	};
+	uint8_t mock_buf[] = {REG_OLAT1, 0xaa};
+	int rc;
+
+	expect_value(mock_i2cd_write, dev, mock_dev.i2c_dev);
+	expect_value(mock_i2cd_write, addr, mock_dev.i2c_addr);
+	expect_memory(mock_i2cd_write, buf, mock_buf, sizeof(mock_buf));
+	expect_value(mock_i2cd_write, len, sizeof(mock_buf));
+	will_return(mock_i2cd_write, 0);
+
+	/* Check behavior when function succeeds */
+	rc = mcp23016_set_output8(&mock_dev, MCP23016_PORT_1, 0xaa);
+
+	assert_return_code(rc, 0);
+	assert_int_equal(mock_dev.cache_valid, BIT(REG_OLAT1));
+	assert_int_equal(mock_dev.cache[CACHE_INDEX(REG_OLAT0)], 0xaa00);
+}
+
+void test_mcp23016_write_pins(void **state)
+{
+	struct mcp23016_device mock_dev = {
+		.i2c_addr = BASE_ADDR,
+		.i2c_dev = &(struct i2cd){0}
+	};
+	uint8_t mock_write_buf[] = {REG_OLAT0};
+	uint8_t mock_read_buf[] = {0x0f, 0xf0};
+	uint8_t mock_bufs[][3] = {
+		{REG_OLAT0, 0xaf, 0xfa},
+		{REG_OLAT0, 0x55},
+		{REG_OLAT1, 0x0a}
+	};
+	int rc;
+
+	/* mcp23016_get_output() */
+	expect_value(mock_i2cd_write_read, dev, mock_dev.i2c_dev);
+	expect_value(mock_i2cd_write_read, addr, mock_dev.i2c_addr);
+	expect_memory(mock_i2cd_write_read, write_buf, mock_write_buf, sizeof(mock_write_buf));
+	expect_value(mock_i2cd_write_read, write_len, sizeof(mock_write_buf));
+	will_return(mock_i2cd_write_read, mock_read_buf); /* read_buf */
+	expect_value(mock_i2cd_write_read, read_len, sizeof(mock_read_buf));
+	will_return(mock_i2cd_write_read, 0);
+
+	expect_value(mock_i2cd_write, dev, mock_dev.i2c_dev);
+	expect_value(mock_i2cd_write, addr, mock_dev.i2c_addr);
+	expect_memory(mock_i2cd_write, buf, mock_bufs[0], 3);
+	expect_value(mock_i2cd_write, len, 3);
+	will_return(mock_i2cd_write, 0);
+
+	/* Check behavior when output latch value is unknown */
+	rc = mcp23016_write_pins(&mock_dev, 0x0ff0, 0x5aa5);
+
+	assert_return_code(rc, 0);
+	assert_int_equal(mock_dev.cache[CACHE_INDEX(REG_OLAT0)], 0xfaaf);
+
+	expect_value(mock_i2cd_write, dev, mock_dev.i2c_dev);
+	expect_value(mock_i2cd_write, addr, mock_dev.i2c_addr);
+	expect_memory(mock_i2cd_write, buf, mock_bufs[1], 2);
+	expect_value(mock_i2cd_write, len, 2);
+	will_return(mock_i2cd_write, 0);
+
+	/* Check behavior when pins are confined to port 0 */
+	rc = mcp23016_write_pins(&mock_dev, 0x00ff, 0xaa55);
+
+	assert_return_code(rc, 0);
+	assert_int_equal(mock_dev.cache[CACHE_INDEX(REG_OLAT0)], 0xfa55);
+
+	expect_value(mock_i2cd_write, dev, mock_dev.i2c_dev);
+	expect_value(mock_i2cd_write, addr, mock_dev.i2c_addr);
+	expect_memory(mock_i2cd_write, buf, mock_bufs[2], 2);
+	expect_value(mock_i2cd_write, len, 2);
+	will_return(mock_i2cd_write, 0);
+
+	/* Check behavior when pins are confined to port 1 */
+	rc = mcp23016_write_pins(&mock_dev, 0xf000, 0x0000);
+
+	assert_return_code(rc, 0);
+	assert_int_equal(mock_dev.cache[CACHE_INDEX(REG_OLAT0)], 0x0a55);
+}
+
+void test_mcp23016_set_pins(void **state)
+{
+	struct mcp23016_device mock_dev = {
+		.i2c_addr = BASE_ADDR,
+		.i2c_dev = &(struct i2cd){0},
+		.cache_valid = CACHE_VALID(REG_OLAT0),
+		.cache[CACHE_INDEX(REG_OLAT0)] = 0x0ff0
 	};
+	uint8_t mock_buf[] = {REG_OLAT0, 0xf1, 0x8f};
 	int rc;
 
-	/* mcp23016_set_direction() */
-	expect_any(mock_i2cd_write, dev);
-	expect_any(mock_i2cd_write, addr);
-	expect_memory(mock_i2cd_write, buf, mock_bufs[0], sizeof(mock_bufs[0]));
-	expect_value(mock_i2cd_write, len, sizeof(mock_bufs[0]));
+	expect_value(mock_i2cd_write, dev, mock_dev.i2c_dev);
+	expect_value(mock_i2cd_write, addr, mock_dev.i2c_addr);
+	expect_memory(mock_i2cd_write, buf, mock_buf, sizeof(mock_buf));
+	expect_value(mock_i2cd_write, len, sizeof(mock_buf));
 	will_return(mock_i2cd_write, 0);
 
-	/* mcp23016_set_output() */
-	expect_any(mock_i2cd_write, dev);
-	expect_any(mock_i2cd_write, addr);
-	expect_memory(mock_i2cd_write, buf, mock_bufs[1], sizeof(mock_bufs[1]));
-	expect_value(mock_i2cd_write, len, sizeof(mock_bufs[1]));
-	will_return(mock_i2cd_write, 0);
+	/* Check behavior when function succeeds */
+	rc = mcp23016_set_pins(&mock_dev, 0x8001);
 
-	/* mcp23016_set_polarity() */
-	expect_any(mock_i2cd_write, dev);
-	expect_any(mock_i2cd_write, addr);
-	expect_memory(mock_i2cd_write, buf, mock_bufs[2], sizeof(mock_bufs[2]));
-	expect_value(mock_i2cd_write, len, sizeof(mock_bufs[2]));
+	assert_return_code(rc, 0);
+}
+
+void test_mcp23016_clear_pins(void **state)
+{
+	struct mcp23016_device mock_dev = {
+		.i2c_addr = BASE_ADDR,
+		.i2c_dev = &(struct i2cd){0},
+		.cache_valid = CACHE_VALID(REG_OLAT0),
+		.cache[CACHE_INDEX(REG_OLAT0)] = 0x0ff0
+	};
+	uint8_t mock_buf[] = {REG_OLAT0, 0xe0, 0x07};
+	int rc;
+
+	expect_value(mock_i2cd_write, dev, mock_dev.i2c_dev);
+	expect_value(mock_i2cd_write, addr, mock_dev.i2c_addr);
+	expect_memory(mock_i2cd_write, buf, mock_buf, sizeof(mock_buf));
+	expect_value(mock_i2cd_write, len, sizeof(mock_buf));
 	will_return(mock_i2cd_write, 0);
 
-	/* mcp23016_set_control() */
-	expect_any(mock_i2cd_write, dev);
-	expect_any(mock_i2cd_write, addr);
-	expect_memory(mock_i2cd_write, buf, mock_bufs[3], sizeof(mock_bufs[3]));
-	expect_value(mock_i2cd_write, len, sizeof(mock_bufs[3]));
+	/* Check behavior when function succeeds */
+	rc = mcp23016_clear_pins(&mock_dev, 0x0810);
+
+	assert_return_code(rc, 0);
+}
+
+void test_mcp23016_toggle_pins(void **state)
+{
+	struct mcp23016_device mock_dev = {
+		.i2c_addr = BASE_ADDR,
+		.i2c_dev = &(struct i2cd){0},
+		.cache_valid = CACHE_VALID(REG_OLAT0),
+		.cache[CACHE_INDEX(REG_OLAT0)] = 0x0ff0
+	};
+	uint8_t mock_buf[] = {REG_OLAT0, 0x0f, 0xf0};
+	int rc;
+
+	expect_value(mock_i2cd_write, dev, mock_dev.i2c_dev);
+	expect_value(mock_i2cd_write, addr, mock_dev.i2c_addr);
+	expect_memory(mock_i2cd_write, buf, mock_buf, sizeof(mock_buf));
+	expect_value(mock_i2cd_write, len, sizeof(mock_buf));
 	will_return(mock_i2cd_write, 0);
 
-	/* mcp23016_clear_interrupt() */
+	/* Check behavior when function succeeds */
+	rc = mcp23016_toggle_pins(&mock_dev, 0xffff);
+
+	assert_return_code(rc, 0);
+	assert_int_equal(mock_dev.cache[CACHE_INDEX(REG_OLAT0)], 0xf00f);
+}
+
+void test_mcp23016_toggle_pins_fail(void **state)
+{
+	struct mcp23016_device mock_dev = {
+		.i2c_addr = BASE_ADDR,
+		.i2c_dev = &(struct i2cd){0}
+	};
+	int rc;
+
 	expect_any(mock_i2cd_write_read, dev);
 	expect_any(mock_i2cd_write_read, addr);
-	expect_memory(mock_i2cd_write_read, write_buf, mock_bufs[4], 1);
-	expect_value(mock_i2cd_write_read, write_len, 1);
+	expect_any(mock_i2cd_write_read, write_buf);
+	expect_any(mock_i2cd_write_read, write_len);
 	will_return(mock_i2cd_write_read, NULL); /* read_buf */
 	expect_any(mock_i2cd_write_read, read_len);
-	will_return(mock_i2cd_write_read, 0);
+	will_return(mock_i2cd_write_read, -1);
 
-	/* Check behavior when function succeeds */
-	rc = mcp23016_reset(&mock_dev);
+	/* Check behavior when output latch value cannot be read */
+	rc = mcp23016_toggle_pins(&mock_dev, 0xffff);
 
-	assert_return_code(rc, 0);
+	assert_int_equal(rc, -1);
 }
 
-void test_mcp23016_get_port(void **state)
+void test_mcp23016_get_polarity(void **state)
 {
 	struct mcp23016_device mock_dev = {
 		.i2c_addr = BASE_ADDR,
 		.i2c_dev = &(struct i2cd){0}
 	};
-	uint8_t mock_write_buf[] = {REG_GP0};
+	uint8_t mock_write_buf[] = {REG_IPOL0};
 	uint8_t mock_read_buf[] = {0x55, 0xaa};
-	uint16_t port;
+	uint16_t polarity;
 	int rc;
 
 	expect_value(mock_i2cd_write_read, dev, mock_dev.i2c_dev);
@@ -228,19 +1004,19 @@ void test_mcp23016_get_port(void **state)
 	will_return(mock_i2cd_write_read, 0);
 
 	/* Check behavior when function succeeds */
-	rc = mcp23016_get_port(&mock_dev, &port);
+	rc = mcp23016_get_polarity(&mock_dev, &polarity);
 
 	assert_return_code(rc, 0);
-	assert_int_equal(port, 0xaa55);
+	assert_int_equal(polarity, 0xaa55);
 }
 
-void test_mcp23016_set_port(void **state)
+void test_mcp23016_set_polarity(void **state)
 {
 	struct mcp23016_device mock_dev = {
 		.i2c_addr = BASE_ADDR,
 		.i2c_dev = &(struct i2cd){0}
 	};
-	uint8_t mock_buf[] = {REG_GP0, 0x55, 0xaa};
+	uint8_t mock_buf[] = {REG_IPOL0, 0x55, 0xaa};
 	int rc;
 
 	expect_value(mock_i2cd_write, dev, mock_dev.i2c_dev);
@@ -250,20 +1026,20 @@ void test_mcp23016_set_port(void **state)
 	will_return(mock_i2cd_write, 0);
 
 	/* Check behavior when function succeeds */
-	rc = mcp23016_set_port(&mock_dev, 0xaa55);
+	rc = mcp23016_set_polarity(&mock_dev, 0xaa55);
 
 	assert_return_code(rc, 0);
 }
 
-void test_mcp23016_get_output(void **state)
+void test_mcp23016_get_polarity8(void **state)
 {
 	struct mcp23016_device mock_dev = {
 		.i2c_addr = BASE_ADDR,
 		.i2c_dev = &(struct i2cd){0}
 	};
-	uint8_t mock_write_buf[] = {REG_OLAT0};
-	uint8_t mock_read_buf[] = {0x55, 0xaa};
-	uint16_t output;
+	uint8_t mock_write_buf[] = {REG_IPOL1};
+	uint8_t mock_read_buf[] = {0xaa};
+	uint8_t polarity;
 	int rc;
 
 	expect_value(mock_i2cd_write_read, dev, mock_dev.i2c_dev);
@@ -275,19 +1051,19 @@ void test_mcp23016_get_output(void **state)
 	will_return(mock_i2cd_write_read, 0);
 
 	/* Check behavior when function succeeds */
-	rc = mcp23016_get_output(&mock_dev, &output);
+	rc = mcp23016_get_polarity8(&mock_dev, MCP23016_PORT_1, &polarity);
 
 	assert_return_code(rc, 0);
-	assert_int_equal(output, 0xaa55);
+	assert_int_equal(polarity, 0xaa);
 }
 
-void test_mcp23016_set_output(void **state)
+void test_mcp23016_set_polarity8(void **state)
 {
 	struct mcp23016_device mock_dev = {
 		.i2c_addr = BASE_ADDR,
 		.i2c_dev = &(struct i2cd){0}
 	};
-	uint8_t mock_buf[] = {REG_OLAT0, 0x55, 0xaa};
+	uint8_t mock_buf[] = {REG_IPOL0, 0x55};
 	int rc;
 
 	expect_value(mock_i2cd_write, dev, mock_dev.i2c_dev);
@@ -297,20 +1073,20 @@ void test_mcp23016_set_output(void **state)
 	will_return(mock_i2cd_write, 0);
 
 	/* Check behavior when function succeeds */
-	rc = mcp23016_set_output(&mock_dev, 0xaa55);
+	rc = mcp23016_set_polarity8(&mock_dev, MCP23016_PORT_0, 0x55);
 
 	assert_return_code(rc, 0);
 }
 
-void test_mcp23016_get_polarity(void **state)
+void test_mcp23016_get_direction(void **state)
 {
 	struct mcp23016_device mock_dev = {
 		.i2c_addr = BASE_ADDR,
 		.i2c_dev = &(struct i2cd){0}
 	};
-	uint8_t mock_write_buf[] = {REG_IPOL0};
+	uint8_t mock_write_buf[] = {REG_IODIR0};
 	uint8_t mock_read_buf[] = {0x55, 0xaa};
-	uint16_t polarity;
+	uint16_t direction;
 	int rc;
 
 	expect_value(mock_i2cd_write_read, dev, mock_dev.i2c_dev);
@@ -322,19 +1098,19 @@ void test_mcp23016_get_polarity(void **state)
 	will_return(mock_i2cd_write_read, 0);
 
 	/* Check behavior when function succeeds */
-	rc = mcp23016_get_polarity(&mock_dev, &polarity);
+	rc = mcp23016_get_direction(&mock_dev, &direction);
 
 	assert_return_code(rc, 0);
-	assert_int_equal(polarity, 0xaa55);
+	assert_int_equal(direction, 0xaa55);
 }
 
-void test_mcp23016_set_polarity(void **state)
+void test_mcp23016_set_direction(void **state)
 {
 	struct mcp23016_device mock_dev = {
 		.i2c_addr = BASE_ADDR,
 		.i2c_dev = &(struct i2cd){0}
 	};
-	uint8_t mock_buf[] = {REG_IPOL0, 0x55, 0xaa};
+	uint8_t mock_buf[] = {REG_IODIR0, 0x55, 0xaa};
 	int rc;
 
 	expect_value(mock_i2cd_write, dev, mock_dev.i2c_dev);
@@ -344,20 +1120,20 @@ void test_mcp23016_set_polarity(void **state)
 	will_return(mock_i2cd_write, 0);
 
 	/* Check behavior when function succeeds */
-	rc = mcp23016_set_polarity(&mock_dev, 0xaa55);
+	rc = mcp23016_set_direction(&mock_dev, 0xaa55);
 
 	assert_return_code(rc, 0);
 }
 
-void test_mcp23016_get_direction(void **state)
+void test_mcp23016_get_direction8(void **state)
 {
 	struct mcp23016_device mock_dev = {
 		.i2c_addr = BASE_ADDR,
 		.i2c_dev = &(struct i2cd){0}
 	};
-	uint8_t mock_write_buf[] = {REG_IODIR0};
-	uint8_t mock_read_buf[] = {0x55, 0xaa};
-	uint16_t direction;
+	uint8_t mock_write_buf[] = {REG_IODIR1};
+	uint8_t mock_read_buf[] = {0xaa};
+	uint8_t direction;
 	int rc;
 
 	expect_value(mock_i2cd_write_read, dev, mock_dev.i2c_dev);
@@ -369,19 +1145,19 @@ void test_mcp23016_get_direction(void **state)
 	will_return(mock_i2cd_write_read, 0);
 
 	/* Check behavior when function succeeds */
-	rc = mcp23016_get_direction(&mock_dev, &direction);
+	rc = mcp23016_get_direction8(&mock_dev, MCP23016_PORT_1, &direction);
 
 	assert_return_code(rc, 0);
-	assert_int_equal(direction, 0xaa55);
+	assert_int_equal(direction, 0xaa);
 }
 
-void test_mcp23016_set_direction(void **state)
+void test_mcp23016_set_direction8(void **state)
 {
 	struct mcp23016_device mock_dev = {
 		.i2c_addr = BASE_ADDR,
 		.i2c_dev = &(struct i2cd){0}
 	};
-	uint8_t mock_buf[] = {REG_IODIR0, 0x55, 0xaa};
+	uint8_t mock_buf[] = {REG_IODIR0, 0x55};
 	int rc;
 
 	expect_value(mock_i2cd_write, dev, mock_dev.i2c_dev);
@@ -391,7 +1167,7 @@ void test_mcp23016_set_direction(void **state)
 	will_return(mock_i2cd_write, 0);
 
 	/* Check behavior when function succeeds */
-	rc = mcp23016_set_direction(&mock_dev, 0xaa55);
+	rc = mcp23016_set_direction8(&mock_dev, MCP23016_PORT_0, 0x55);
 
 	assert_return_code(rc, 0);
 }
@@ -422,6 +1198,69 @@ void test_mcp23016_get_interrupt(void **state)
 	assert_int_equal(interrupt, 0xaa55);
 }
 
+void test_mcp23016_service_interrupt(void **state)
+{
+	struct mcp23016_device mock_dev = {
+		.i2c_addr = BASE_ADDR,
+		.i2c_dev = &(struct i2cd){0}
+	};
+	struct mcp23016_interrupt_state intr_state = {
+		.current = 0x00f0
+	};
+	uint8_t mock_intcap_reg = REG_INTCAP0;
+	uint8_t mock_gp_reg = REG_GP0;
+	uint8_t mock_intcap_buf[] = {0x0f, 0x00};
+	uint8_t mock_gp_buf[] = {0x03, 0x00};
+	int rc;
+
+	expect_value(mock_i2cd_transfer, dev, mock_dev.i2c_dev);
+	expect_value(mock_i2cd_transfer, nmsgs, 4);
+	expect_i2cd_transfer_write(mock_dev.i2c_addr, &mock_intcap_reg, 1);
+	expect_i2cd_transfer_read(mock_dev.i2c_addr, mock_intcap_buf, 2);
+	expect_i2cd_transfer_write(mock_dev.i2c_addr, &mock_gp_reg, 1);
+	expect_i2cd_transfer_read(mock_dev.i2c_addr, mock_gp_buf, 2);
+	will_return(mock_i2cd_transfer, 0);
+
+	/* Check behavior when function succeeds */
+	rc = mcp23016_service_interrupt(&mock_dev, &intr_state);
+
+	assert_return_code(rc, 0);
+	assert_int_equal(intr_state.previous, 0x00f0);
+	assert_int_equal(intr_state.captured, 0x000f);
+	assert_int_equal(intr_state.current, 0x0003);
+	assert_int_equal(intr_state.changed, 0x00ff);
+	assert_int_equal(intr_state.missed, 0x000c);
+}
+
+void test_mcp23016_service_interrupt_fail(void **state)
+{
+	struct mcp23016_device mock_dev = {
+		.i2c_addr = BASE_ADDR,
+		.i2c_dev = &(struct i2cd){0}
+	};
+	struct mcp23016_interrupt_state intr_state = {
+		.current = 0x00f0
+	};
+	uint8_t mock_intcap_reg = REG_INTCAP0;
+	uint8_t mock_gp_reg = REG_GP0;
+	uint8_t mock_read_buf[] = {0x0f, 0x00};
+	int rc;
+
+	expect_value(mock_i2cd_transfer, dev, mock_dev.i2c_dev);
+	expect_value(mock_i2cd_transfer, nmsgs, 4);
+	expect_i2cd_transfer_write(mock_dev.i2c_addr, &mock_intcap_reg, 1);
+	expect_i2cd_transfer_read(mock_dev.i2c_addr, mock_read_buf, 2);
+	expect_i2cd_transfer_write(mock_dev.i2c_addr, &mock_gp_reg, 1);
+	expect_i2cd_transfer_read(mock_dev.i2c_addr, mock_read_buf, 2);
+	will_return(mock_i2cd_transfer, -1);
+
+	/* Check behavior when i2cd_transfer() fails */
+	rc = mcp23016_service_interrupt(&mock_dev, &intr_state);
+
+	assert_int_equal(rc, -1);
+	assert_int_equal(intr_state.current, 0x00f0);
+}
+
 void test_mcp23016_get_control(void **state)
 {
 	struct mcp23016_device mock_dev = {
@@ -469,160 +1308,207 @@ void test_mcp23016_set_control(void **state)
 	assert_return_code(rc, 0);
 }
 
-void test_mcp23016_interrupt_open(void **state)
+void test_mcp23016_enable_cache(void **state)
 {
-	struct mcp23016_interrupt mock_intr = {0};
-	struct gpiod_chip mock_gpiod_chip;
-	struct gpiod_line mock_gpiod_line;
-	struct mcp23016_interrupt *intr;
-
-	expect_value(mock_calloc, nmemb, 1);
-	expect_value(mock_calloc, size, sizeof(mock_intr));
-	will_return(mock_calloc, &mock_intr);
-
-	expect_string(mock_gpiod_chip_open, path, "/dev/gpiochip0");
-	will_return(mock_gpiod_chip_open, &mock_gpiod_chip);
-
-	expect_value(mock_gpiod_chip_get_line, chip, &mock_gpiod_chip);
-	expect_value(mock_gpiod_chip_get_line, offset, 0);
-	will_return(mock_gpiod_chip_get_line, &mock_gpiod_line);
-
-	expect_value(mock_gpiod_line_request_input_flags, line, &mock_gpiod_line);
-	expect_string(mock_gpiod_line_request_input_flags, consumer, CONSUMER);
-	expect_value(mock_gpiod_line_request_input_flags, flags, GPIOD_LINE_REQUEST_FLAG_ACTIVE_LOW);
-	will_return(mock_gpiod_line_request_input_flags, 0);
+	struct mcp23016_device mock_dev = {
+		.i2c_addr = BASE_ADDR,
+		.i2c_dev = &(struct i2cd){0}
+	};
 
 	/* Check behavior when function succeeds */
-	intr = mcp23016_interrupt_open("/dev/gpiochip0", 0);
+	mcp23016_enable_cache(&mock_dev);
 
-	assert_non_null(intr);
-	assert_ptr_equal(intr->gpio_chip, &mock_gpiod_chip);
-	assert_ptr_equal(intr->gpio_line, &mock_gpiod_line);
+	assert_true(mock_dev.cache_enabled);
 }
 
-void test_mcp23016_interrupt_open_fail_calloc(void **state)
+void test_mcp23016_disable_cache(void **state)
 {
-	struct mcp23016_interrupt *intr;
-
-	expect_any(mock_calloc, nmemb);
-	expect_any(mock_calloc, size);
-	will_return(mock_calloc, NULL);
+	struct mcp23016_device mock_dev = {
+		.i2c_addr = BASE_ADDR,
+		.i2c_dev = &(struct i2cd){0},
+		.cache_enabled = 1
+	};
 
-	/* Check behavior when calloc() fails */
-	intr = mcp23016_interrupt_open("/dev/gpiochip0", 0);
+	/* Check behavior when function succeeds */
+	mcp23016_disable_cache(&mock_dev);
 
-	assert_null(intr);
+	assert_false(mock_dev.cache_enabled);
 }
 
-void test_mcp23016_interrupt_open_fail_gpio_chip(void **state)
+void test_mcp23016_invalidate_cache(void **state)
 {
-	struct mcp23016_interrupt mock_intr = {0};
-	struct mcp23016_interrupt *intr;
-
-	expect_any(mock_calloc, nmemb);
-	expect_any(mock_calloc, size);
-	will_return(mock_calloc, &mock_intr);
-
-	expect_any(mock_gpiod_chip_open, path);
-	will_return(mock_gpiod_chip_open, NULL);
-
-	expect_value(mock_free, ptr, &mock_intr);
+	struct mcp23016_device mock_dev = {
+		.i2c_addr = BASE_ADDR,
+		.i2c_dev = &(struct i2cd){0},
+		.cache_enabled = 1,
+		.cache_valid = CACHE_REGS
+	};
 
-	/* Check behavior when gpiod_chip_open() fails */
-	intr = mcp23016_interrupt_open("/dev/gpiochip0", 0);
+	/* Check behavior when function succeeds */
+	mcp23016_invalidate_cache(&mock_dev);
 
-	assert_null(intr);
+	assert_true(mock_dev.cache_enabled);
+	assert_int_equal(mock_dev.cache_valid, 0);
 }
 
-void test_mcp23016_interrupt_open_fail_gpio_line(void **state)
+void test_mcp23016_refresh_cache(void **state)
 {
-	struct mcp23016_interrupt mock_intr = {0};
-	struct gpiod_chip mock_gpiod_chip;
-	struct mcp23016_interrupt *intr;
+	struct mcp23016_device mock_dev = {
+		.i2c_addr = BASE_ADDR,
+		.i2c_dev = &(struct i2cd){0},
+		.cache_enabled = 1,
+		.cache_valid = CACHE_REGS
+	};
+	uint8_t mock_write_bufs[][1] = {
+		{REG_OLAT0},
+		{REG_IPOL0},
+		{REG_IODIR0},
+		{REG_IOCON0}
+	};
+	uint8_t mock_read_bufs[][2] = {
+		{0x01, 0x10},
+		{0x02, 0x20},
+		{0x03, 0x30},
+		{0x04, 0x40}
+	};
+	size_t i;
+	int rc;
 
-	expect_any(mock_calloc, nmemb);
-	expect_any(mock_calloc, size);
-	will_return(mock_calloc, &mock_intr);
+	for (i = 0; i < 4; i++) {
+		expect_value(mock_i2cd_write_read, dev, mock_dev.i2c_dev);
+		expect_value(mock_i2cd_write_read, addr, mock_dev.i2c_addr);
+		expect_memory(mock_i2cd_write_read, write_buf, mock_write_bufs[i], sizeof(mock_write_bufs[i]));
+		expect_value(mock_i2cd_write_read, write_len, sizeof(mock_write_bufs[i]));
+		will_return(mock_i2cd_write_read, mock_read_bufs[i]); /* read_buf */
+		expect_value(mock_i2cd_write_read, read_len, sizeof(mock_read_bufs[i]));
+		will_return(mock_i2cd_write_read, 0);
+	}
 
-	expect_any(mock_gpiod_chip_open, path);
-	will_return(mock_gpiod_chip_open, &mock_gpiod_chip);
+	/* Check behavior when function succeeds */
+	rc = mcp23016_refresh_cache(&mock_dev);
 
-	expect_any(mock_gpiod_chip_get_line, chip);
-	expect_any(mock_gpiod_chip_get_line, offset);
-	will_return(mock_gpiod_chip_get_line, NULL);
+	assert_return_code(rc, 0);
+	assert_int_equal(mock_dev.cache_valid, CACHE_REGS);
+	assert_int_equal(mock_dev.cache[CACHE_INDEX(REG_OLAT0)], 0x1001);
+	assert_int_equal(mock_dev.cache[CACHE_INDEX(REG_IPOL0)], 0x2002);
+	assert_int_equal(mock_dev.cache[CACHE_INDEX(REG_IODIR0)], 0x3003);
+	assert_int_equal(mock_dev.cache[CACHE_INDEX(REG_IOCON0)], 0x4004);
+}
 
-	expect_value(mock_gpiod_chip_close, chip, &mock_gpiod_chip);
-	expect_value(mock_free, ptr, &mock_intr);
+void test_mcp23016_get_output_cached(void **state)
+{
+	struct mcp23016_device mock_dev = {
+		.i2c_addr = BASE_ADDR,
+		.i2c_dev = &(struct i2cd){0},
+		.cache_enabled = 1,
+		.cache_valid = CACHE_VALID(REG_OLAT0),
+		.cache[CACHE_INDEX(REG_OLAT0)] = 0xaa55
+	};
+	uint16_t output;
+	int rc;
 
-	/* Check behavior when gpiod_chip_get_line() fails */
-	intr = mcp23016_interrupt_open("/dev/gpiochip0", 0);
+	/* Check behavior when register is cached */
+	rc = mcp23016_get_output(&mock_dev, &output);
 
-	assert_null(intr);
+	assert_return_code(rc, 0);
+	assert_int_equal(output, 0xaa55);
 }
 
-void test_mcp23016_interrupt_open_fail_gpio_line_flags(void **state)
+void test_mcp23016_get_port_cached(void **state)
 {
-	struct mcp23016_interrupt mock_intr = {0};
-	struct gpiod_chip mock_gpiod_chip;
-	struct gpiod_line mock_gpiod_line;
-	struct mcp23016_interrupt *intr;
+	struct mcp23016_device mock_dev = {
+		.i2c_addr = BASE_ADDR,
+		.i2c_dev = &(struct i2cd){0},
+		.cache_enabled = 1,
+		.cache_valid = CACHE_REGS
+	};
+	uint8_t mock_write_buf[] = {REG_GP0};
+	uint8_t mock_read_buf[] = {0x55, 0xaa};
+	uint16_t port;
+	int rc;
 
-	expect_any(mock_calloc, nmemb);
-	expect_any(mock_calloc, size);
-	will_return(mock_calloc, &mock_intr);
+	expect_value(mock_i2cd_write_read, dev, mock_dev.i2c_dev);
+	expect_value(mock_i2cd_write_read, addr, mock_dev.i2c_addr);
+	expect_memory(mock_i2cd_write_read, write_buf, mock_write_buf, sizeof(mock_write_buf));
+	expect_value(mock_i2cd_write_read, write_len, sizeof(mock_write_buf));
+	will_return(mock_i2cd_write_read, mock_read_buf); /* read_buf */
+	expect_value(mock_i2cd_write_read, read_len, sizeof(mock_read_buf));
+	will_return(mock_i2cd_write_read, 0);
 
-	expect_any(mock_gpiod_chip_open, path);
-	will_return(mock_gpiod_chip_open, &mock_gpiod_chip);
+	/* Check behavior when register is not cacheable */
+	rc = mcp23016_get_port(&mock_dev, &port);
 
-	expect_any(mock_gpiod_chip_get_line, chip);
-	expect_any(mock_gpiod_chip_get_line, offset);
-	will_return(mock_gpiod_chip_get_line, &mock_gpiod_line);
+	assert_return_code(rc, 0);
+	assert_int_equal(port, 0xaa55);
+	assert_int_equal(mock_dev.cache_valid, CACHE_REGS);
+}
 
-	expect_any(mock_gpiod_line_request_input_flags, line);
-	expect_any(mock_gpiod_line_request_input_flags, consumer);
-	expect_any(mock_gpiod_line_request_input_flags, flags);
-	will_return(mock_gpiod_line_request_input_flags, -1);
+void test_mcp23016_set_port_cached(void **state)
+{
+	struct mcp23016_device mock_dev = {
+		.i2c_addr = BASE_ADDR,
+		.i2c_dev = &(struct i2cd){0},
+		.cache_enabled = 1
+	};
+	int rc;
 
-	expect_value(mock_gpiod_line_release, line, &mock_gpiod_line);
-	expect_value(mock_gpiod_chip_close, chip, &mock_gpiod_chip);
-	expect_value(mock_free, ptr, &mock_intr);
+	expect_any(mock_i2cd_write, dev);
+	expect_any(mock_i2cd_write, addr);
+	expect_any(mock_i2cd_write, buf);
+	expect_any(mock_i2cd_write, len);
+	will_return(mock_i2cd_write, 0);
 
-	/* Check behavior when gpiod_line_request_input_flags() fails */
-	intr = mcp23016_interrupt_open("/dev/gpiochip0", 0);
+	/* Check behavior when output latches are modified */
+	rc = mcp23016_set_port(&mock_dev, 0xaa55);
 
-	assert_null(intr);
+	assert_return_code(rc, 0);
+	assert_int_equal(mock_dev.cache_valid, CACHE_VALID(REG_OLAT0));
+	assert_int_equal(mock_dev.cache[CACHE_INDEX(REG_OLAT0)], 0xaa55);
 }
 
-void test_mcp23016_interrupt_close(void **state)
+void test_mcp23016_set_output_cached(void **state)
 {
-	struct mcp23016_interrupt mock_intr = {
-		.gpio_chip = &(struct gpiod_chip){0},
-		.gpio_line = &(struct gpiod_line){0}
+	struct mcp23016_device mock_dev = {
+		.i2c_addr = BASE_ADDR,
+		.i2c_dev = &(struct i2cd){0},
+		.cache_enabled = 1
 	};
+	int rc;
+
+	expect_any(mock_i2cd_write, dev);
+	expect_any(mock_i2cd_write, addr);
+	expect_any(mock_i2cd_write, buf);
+	expect_any(mock_i2cd_write, len);
+	will_return(mock_i2cd_write, 0);
 
-	expect_value(mock_gpiod_line_release, line, mock_intr.gpio_line);
-	expect_value(mock_gpiod_chip_close, chip, mock_intr.gpio_chip);
-	expect_value(mock_free, ptr, &mock_intr);
+	/* Check behavior when register is cacheable */
+	rc = mcp23016_set_output(&mock_dev, 0xaa55);
 
-	/* Check behavior when function succeeds */
-	mcp23016_interrupt_close(&mock_intr);
+	assert_return_code(rc, 0);
+	assert_int_equal(mock_dev.cache_valid, CACHE_VALID(REG_OLAT0));
+	assert_int_equal(mock_dev.cache[CACHE_INDEX(REG_OLAT0)], 0xaa55);
 }
 
-void test_mcp23016_has_interrupt(void **state)
+void test_mcp23016_set_output_cached_fail(void **state)
 {
-	struct mcp23016_interrupt mock_intr = {
-		.gpio_chip = &(struct gpiod_chip){0},
-		.gpio_line = &(struct gpiod_line){0}
+	struct mcp23016_device mock_dev = {
+		.i2c_addr = BASE_ADDR,
+		.i2c_dev = &(struct i2cd){0},
+		.cache_enabled = 1
 	};
-	int res;
+	int rc;
 
-	expect_value(mock_gpiod_line_get_value, line, mock_intr.gpio_line);
-	will_return(mock_gpiod_line_get_value, 0);
+	expect_any(mock_i2cd_write, dev);
+	expect_any(mock_i2cd_write, addr);
+	expect_any(mock_i2cd_write, buf);
+	expect_any(mock_i2cd_write, len);
+	will_return(mock_i2cd_write, -1);
 
-	/* Check behavior when function succeeds */
-	res = mcp23016_has_interrupt(&mock_intr);
+	/* Check behavior when i2cd_write() fails */
+	rc = mcp23016_set_output(&mock_dev, 0xaa55);
 
-	assert_int_equal(res, 0);
+	assert_int_equal(rc, -1);
+	assert_int_equal(mock_dev.cache_valid, 0);
 }
 
 int main(void)
@@ -633,25 +1519,61 @@ int main(void)
 		cmocka_unit_test(test_mcp23016_open_fail_i2c_addr),
 		cmocka_unit_test(test_mcp23016_open_fail_i2c_dev),
 		cmocka_unit_test(test_mcp23016_close),
+		cmocka_unit_test(test_mcp23016_bus_open),
+		cmocka_unit_test(test_mcp23016_bus_open_fail_calloc),
+		cmocka_unit_test(test_mcp23016_bus_open_fail_i2c_dev),
+		cmocka_unit_test(test_mcp23016_bus_close),
+		cmocka_unit_test(test_mcp23016_open_on_bus),
+		cmocka_unit_test(test_mcp23016_open_on_bus_fail_i2c_addr),
+		cmocka_unit_test(test_mcp23016_close_on_bus),
 		cmocka_unit_test(test_mcp23016_reset),
+		cmocka_unit_test(test_mcp23016_configure),
+		cmocka_unit_test(test_mcp23016_configure_fail),
+		cmocka_unit_test(test_mcp23016_bus_set_output),
+		cmocka_unit_test(test_mcp23016_bus_set_output_fail_bus),
 		cmocka_unit_test(test_mcp23016_get_port),
 		cmocka_unit_test(test_mcp23016_set_port),
+		cmocka_unit_test(test_mcp23016_get_port_burst),
+		cmocka_unit_test(test_mcp23016_get_port_burst_fail_n),
+		cmocka_unit_test(test_mcp23016_set_port_stream),
+		cmocka_unit_test(test_mcp23016_set_port_stream_chunk),
+		cmocka_unit_test(test_mcp23016_set_port_stream_fail),
+		cmocka_unit_test(test_mcp23016_get_port8),
+		cmocka_unit_test(test_mcp23016_get_port8_fail_port),
+		cmocka_unit_test(test_mcp23016_set_port8),
 		cmocka_unit_test(test_mcp23016_get_output),
 		cmocka_unit_test(test_mcp23016_set_output),
+		cmocka_unit_test(test_mcp23016_get_output8),
+		cmocka_unit_test(test_mcp23016_get_output8_cached),
+		cmocka_unit_test(test_mcp23016_get_output_cached_partial),
+		cmocka_unit_test(test_mcp23016_set_output8),
+		cmocka_unit_test(test_mcp23016_write_pins),
+		cmocka_unit_test(test_mcp23016_set_pins),
+		cmocka_unit_test(test_mcp23016_clear_pins),
+		cmocka_unit_test(test_mcp23016_toggle_pins),
+		cmocka_unit_test(test_mcp23016_toggle_pins_fail),
 		cmocka_unit_test(test_mcp23016_get_polarity),
 		cmocka_unit_test(test_mcp23016_set_polarity),
+		cmocka_unit_test(test_mcp23016_get_polarity8),
+		cmocka_unit_test(test_mcp23016_set_polarity8),
 		cmocka_unit_test(test_mcp23016_get_direction),
 		cmocka_unit_test(test_mcp23016_set_direction),
+		cmocka_unit_test(test_mcp23016_get_direction8),
+		cmocka_unit_test(test_mcp23016_set_direction8),
 		cmocka_unit_test(test_mcp23016_get_interrupt),
+		cmocka_unit_test(test_mcp23016_service_interrupt),
+		cmocka_unit_test(test_mcp23016_service_interrupt_fail),
 		cmocka_unit_test(test_mcp23016_get_control),
 		cmocka_unit_test(test_mcp23016_set_control),
-		cmocka_unit_test(test_mcp23016_interrupt_open),
-		cmocka_unit_test(test_mcp23016_interrupt_open_fail_calloc),
-		cmocka_unit_test(test_mcp23016_interrupt_open_fail_gpio_chip),
-		cmocka_unit_test(test_mcp23016_interrupt_open_fail_gpio_line),
-		cmocka_unit_test(test_mcp23016_interrupt_open_fail_gpio_line_flags),
-		cmocka_unit_test(test_mcp23016_interrupt_close),
-		cmocka_unit_test(test_mcp23016_has_interrupt)
+		cmocka_unit_test(test_mcp23016_enable_cache),
+		cmocka_unit_test(test_mcp23016_disable_cache),
+		cmocka_unit_test(test_mcp23016_invalidate_cache),
+		cmocka_unit_test(test_mcp23016_refresh_cache),
+		cmocka_unit_test(test_mcp23016_get_output_cached),
+		cmocka_unit_test(test_mcp23016_get_port_cached),
+		cmocka_unit_test(test_mcp23016_set_port_cached),
+		cmocka_unit_test(test_mcp23016_set_output_cached),
+		cmocka_unit_test(test_mcp23016_set_output_cached_fail)
 	};
 
 	return cmocka_run_group_tests(tests, setup, teardown);
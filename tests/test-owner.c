@@ -0,0 +1,245 @@
+/* SPDX-License-Identifier: LGPL-2.1-or-later */
+/*
+ * Copyright (C) 2021 Steven Stallion <sstallion@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mcp23016-private.h"
+
+#include <errno.h>
+#include <semaphore.h>
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <time.h>
+#include <cmocka.h>
+#include <i2cd.h>
+
+#include "hooks.h"
+#include "mocks.h"
+
+static sem_t write_entered;
+static sem_t write_gate;
+static atomic_int write_calls;
+
+/* Holds the bus owner thread in the first register write, which permits
+ * commands to be enqueued while the thread is busy.
+ */
+static int gate_i2cd_write(struct i2cd *dev, uint16_t addr, const void *buf, size_t len)
+{
+	if (atomic_fetch_add(&write_calls, 1) == 0) {
+		sem_post(&write_entered);
+		sem_wait(&write_gate);
+	}
+	return mock_i2cd_write(dev, addr, buf, len);
+}
+
+int setup(void **state)
+{
+	sem_init(&write_entered, 0, 0);
+	sem_init(&write_gate, 0, 0);
+	atomic_init(&write_calls, 0);
+	hook(i2cd_write, gate_i2cd_write);
+	hook(i2cd_write_read, mock_i2cd_write_read);
+	return 0;
+}
+
+int teardown(void **state)
+{
+	unhook(i2cd_write);
+	unhook(i2cd_write_read);
+	sem_destroy(&write_gate);
+	sem_destroy(&write_entered);
+	return 0;
+}
+
+static void mock_bus_init(struct mcp23016_bus *bus, struct i2cd *i2c_dev)
+{
+	bus->i2c_dev = i2c_dev;
+	atomic_init(&bus->refcnt, 1);
+}
+
+static void expect_register_write(struct mcp23016_device *dev, uint8_t *mock_buf)
+{
+	expect_value(mock_i2cd_write, dev, dev->i2c_dev);
+	expect_value(mock_i2cd_write, addr, dev->i2c_addr);
+	expect_memory(mock_i2cd_write, buf, mock_buf, 3);
+	expect_value(mock_i2cd_write, len, 3);
+	will_return(mock_i2cd_write, 0);
+}
+
+static void wait_writes(struct mcp23016_owner *owner, uint64_t writes,
+		struct mcp23016_owner_stats *stats)
+{
+	static const struct timespec delay = {.tv_nsec = 1000000};
+	unsigned int i;
+
+	for (i = 0; i < 1000; i++) {
+		mcp23016_owner_get_stats(owner, stats);
+		if (stats->writes == writes)
+			break;
+		nanosleep(&delay, NULL);
+	}
+}
+
+void test_mcp23016_owner_create(void **state)
+{
+	struct mcp23016_bus mock_bus;
+	struct mcp23016_owner *owner;
+
+	mock_bus_init(&mock_bus, &(struct i2cd){0});
+
+	/* Check behavior when function succeeds */
+	owner = mcp23016_owner_create(&mock_bus, 4);
+
+	assert_non_null(owner);
+	assert_int_equal((uintptr_t)owner % CACHE_LINE, 0);
+	assert_ptr_equal(owner->bus, &mock_bus);
+	assert_int_equal(atomic_load(&mock_bus.refcnt), 2);
+
+	mcp23016_owner_destroy(owner);
+
+	assert_int_equal(atomic_load(&mock_bus.refcnt), 1);
+}
+
+void test_mcp23016_owner_create_invalid(void **state)
+{
+	struct mcp23016_bus mock_bus;
+	struct mcp23016_owner *owner;
+
+	mock_bus_init(&mock_bus, &(struct i2cd){0});
+
+	/* Check behavior when capacity is not a power of two */
+	owner = mcp23016_owner_create(&mock_bus, 3);
+
+	assert_null(owner);
+	assert_int_equal(errno, EINVAL);
+	assert_int_equal(atomic_load(&mock_bus.refcnt), 1);
+}
+
+void test_mcp23016_owner_write(void **state)
+{
+	struct mcp23016_bus mock_bus;
+	struct mcp23016_device mock_dev = {
+		.i2c_addr = BASE_ADDR,
+		.bus = &mock_bus,
+		.cache_enabled = 1
+	};
+	struct mcp23016_owner_stats stats;
+	struct mcp23016_owner *owner;
+	uint8_t mock_buf1[] = {REG_OLAT0, 0x00, 0x00};
+	uint8_t mock_buf2[] = {REG_OLAT0, 0x0c, 0x00};
+	uint8_t mock_buf3[] = {REG_IODIR0, 0xff, 0x00};
+	uint8_t mock_buf4[] = {REG_OLAT0, 0x0c, 0x01};
+	int rc;
+
+	mock_bus_init(&mock_bus, &(struct i2cd){0});
+	mock_dev.i2c_dev = mock_bus.i2c_dev;
+
+	expect_register_write(&mock_dev, mock_buf1);
+	expect_register_write(&mock_dev, mock_buf2);
+	expect_register_write(&mock_dev, mock_buf3);
+	expect_register_write(&mock_dev, mock_buf4);
+
+	owner = mcp23016_owner_create(&mock_bus, 4);
+	assert_non_null(owner);
+
+	/* Check behavior when function succeeds */
+	rc = mcp23016_owner_write(owner, &mock_dev, MCP23016_REGISTER_OUTPUT, 0xffff, 0x0000);
+
+	assert_return_code(rc, 0);
+
+	sem_wait(&write_entered);
+
+	/* Check behavior when commands are merged */
+	rc = mcp23016_owner_write(owner, &mock_dev, MCP23016_REGISTER_OUTPUT, 0x000f, 0x000f);
+
+	assert_return_code(rc, 0);
+
+	rc = mcp23016_owner_write(owner, &mock_dev, MCP23016_REGISTER_OUTPUT, 0x0003, 0x0000);
+
+	assert_return_code(rc, 0);
+
+	/* Check behavior when commands to other registers are interleaved */
+	rc = mcp23016_owner_write(owner, &mock_dev, MCP23016_REGISTER_DIRECTION, 0xffff, 0x00ff);
+
+	assert_return_code(rc, 0);
+
+	rc = mcp23016_owner_write(owner, &mock_dev, MCP23016_REGISTER_OUTPUT, 0x0100, 0x0100);
+
+	assert_return_code(rc, 0);
+
+	/* Check behavior when queue is full */
+	rc = mcp23016_owner_write(owner, &mock_dev, MCP23016_REGISTER_OUTPUT, 0xffff, 0x0000);
+
+	assert_int_equal(rc, -1);
+	assert_int_equal(errno, EAGAIN);
+
+	sem_post(&write_gate);
+
+	wait_writes(owner, 4, &stats);
+
+	assert_int_equal(stats.commands, 5);
+	assert_int_equal(stats.writes, 4);
+	assert_int_equal(stats.errors, 0);
+
+	mcp23016_owner_destroy(owner);
+}
+
+void test_mcp23016_owner_write_invalid(void **state)
+{
+	struct mcp23016_bus mock_bus, other_bus;
+	struct mcp23016_device mock_dev = {.i2c_addr = BASE_ADDR, .bus = &mock_bus};
+	struct mcp23016_device other_dev = {.i2c_addr = BASE_ADDR, .bus = &other_bus};
+	struct mcp23016_owner *owner;
+	int rc;
+
+	mock_bus_init(&mock_bus, &(struct i2cd){0});
+	mock_bus_init(&other_bus, &(struct i2cd){0});
+
+	owner = mcp23016_owner_create(&mock_bus, 4);
+	assert_non_null(owner);
+
+	/* Check behavior when device is on another bus */
+	rc = mcp23016_owner_write(owner, &other_dev, MCP23016_REGISTER_OUTPUT, 0xffff, 0);
+
+	assert_int_equal(rc, -1);
+	assert_int_equal(errno, EINVAL);
+
+	/* Check behavior when register is not writable */
+	rc = mcp23016_owner_write(owner, &mock_dev, MCP23016_REGISTER_INTERRUPT, 0xffff, 0);
+
+	assert_int_equal(rc, -1);
+	assert_int_equal(errno, EINVAL);
+
+	rc = mcp23016_owner_write(owner, &mock_dev, MCP23016_REGISTER_PORT, 0xffff, 0);
+
+	assert_int_equal(rc, -1);
+	assert_int_equal(errno, EINVAL);
+
+	mcp23016_owner_destroy(owner);
+}
+
+int main(void)
+{
+	const struct CMUnitTest tests[] = {
+		cmocka_unit_test(test_mcp23016_owner_create),
+		cmocka_unit_test(test_mcp23016_owner_create_invalid),
+		cmocka_unit_test(test_mcp23016_owner_write),
+		cmocka_unit_test(test_mcp23016_owner_write_invalid)
+	};
+
+	return cmocka_run_group_tests(tests, setup, teardown);
+}
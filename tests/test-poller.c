@@ -0,0 +1,356 @@
+/* SPDX-License-Identifier: LGPL-2.1-or-later */
+/*
+ * Copyright (C) 2021 Steven Stallion <sstallion@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mcp23016-private.h"
+
+#include <errno.h>
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <time.h>
+#include <cmocka.h>
+#include <i2cd.h>
+
+#include "hooks.h"
+#include "mocks.h"
+
+int setup(void **state)
+{
+	hook(i2cd_transfer, mock_i2cd_transfer);
+	return 0;
+}
+
+int teardown(void **state)
+{
+	unhook(i2cd_transfer);
+	return 0;
+}
+
+struct poller_call {
+	struct mcp23016_device *dev;
+	uint16_t val;
+	uint16_t changed;
+};
+
+struct poller_calls {
+	struct poller_call calls[MCP23016_DEVICE_MAX];
+	size_t n;
+};
+
+static void poller_handler(struct mcp23016_device *dev, uint16_t val, uint16_t changed,
+		void *arg)
+{
+	struct poller_calls *calls = arg;
+
+	calls->calls[calls->n].dev = dev;
+	calls->calls[calls->n].val = val;
+	calls->calls[calls->n].changed = changed;
+	calls->n++;
+}
+
+static void mock_bus_init(struct mcp23016_bus *bus, struct i2cd *i2c_dev)
+{
+	bus->i2c_dev = i2c_dev;
+	atomic_init(&bus->refcnt, 1);
+}
+
+static void expect_poller_sample(struct mcp23016_device *const *devs, size_t n,
+		uint8_t (*mock_read_bufs)[2], int rc)
+{
+	static uint8_t reg = REG_GP0;
+	size_t i;
+
+	expect_value(mock_i2cd_transfer, dev, devs[0]->i2c_dev);
+	expect_value(mock_i2cd_transfer, nmsgs, n * 2);
+	for (i = 0; i < n; i++) {
+		expect_i2cd_transfer_write(devs[i]->i2c_addr, &reg, 1);
+		expect_i2cd_transfer_read(devs[i]->i2c_addr, mock_read_bufs[i], 2);
+	}
+	will_return(mock_i2cd_transfer, rc);
+}
+
+/* Reads a fixed port value for each device; the poller thread may take any
+ * number of samples.
+ */
+static int sample_i2cd_transfer(struct i2cd *dev, struct i2c_msg *msgs, size_t nmsgs)
+{
+	size_t i;
+
+	for (i = 0; i < nmsgs; i++) {
+		if (msgs[i].flags & I2C_M_RD) {
+			msgs[i].buf[0] = 0x55;
+			msgs[i].buf[1] = 0xaa;
+		}
+	}
+	return 0;
+}
+
+void test_mcp23016_poller_create(void **state)
+{
+	struct mcp23016_bus mock_bus;
+	struct mcp23016_poller_config config = {
+		.min_period = 1000000,
+		.max_period = 8000000,
+		.bandwidth = 5000
+	};
+	struct mcp23016_device mock_dev0 = {.i2c_addr = BASE_ADDR, .bus = &mock_bus};
+	struct mcp23016_device mock_dev1 = {.i2c_addr = BASE_ADDR + 1, .bus = &mock_bus};
+	struct mcp23016_poller_stats stats;
+	struct mcp23016_poller *poller;
+	int rc;
+
+	mock_bus_init(&mock_bus, &(struct i2cd){0});
+
+	/* Check behavior when function succeeds */
+	poller = mcp23016_poller_create(&mock_bus, &config);
+
+	assert_non_null(poller);
+	assert_ptr_equal(poller->bus, &mock_bus);
+	assert_int_equal(atomic_load(&mock_bus.refcnt), 2);
+
+	rc = mcp23016_poller_add_device(poller, &mock_dev0, NULL);
+
+	assert_return_code(rc, 0);
+
+	mcp23016_poller_get_stats(poller, &stats);
+
+	assert_int_equal(stats.period, 1000000);
+
+	/* Check behavior when bandwidth limits the minimum period */
+	rc = mcp23016_poller_add_device(poller, &mock_dev1, NULL);
+
+	assert_return_code(rc, 0);
+
+	mcp23016_poller_get_stats(poller, &stats);
+
+	assert_int_equal(stats.period, 2000000);
+
+	mcp23016_poller_destroy(poller);
+
+	assert_int_equal(atomic_load(&mock_bus.refcnt), 1);
+}
+
+void test_mcp23016_poller_create_invalid(void **state)
+{
+	struct mcp23016_bus mock_bus;
+	struct mcp23016_poller_config config = {0};
+	struct mcp23016_poller *poller;
+
+	mock_bus_init(&mock_bus, &(struct i2cd){0});
+
+	/* Check behavior when minimum period is zero */
+	poller = mcp23016_poller_create(&mock_bus, &config);
+
+	assert_null(poller);
+	assert_int_equal(errno, EINVAL);
+
+	config.min_period = 2000000;
+	config.max_period = 1000000;
+
+	/* Check behavior when maximum period is less than minimum period */
+	poller = mcp23016_poller_create(&mock_bus, &config);
+
+	assert_null(poller);
+	assert_int_equal(errno, EINVAL);
+	assert_int_equal(atomic_load(&mock_bus.refcnt), 1);
+}
+
+void test_mcp23016_poller_add_device_invalid(void **state)
+{
+	struct mcp23016_bus mock_bus, other_bus;
+	struct mcp23016_poller_config config = {
+		.min_period = 1000000,
+		.max_period = 8000000
+	};
+	struct mcp23016_device other_dev = {.i2c_addr = BASE_ADDR, .bus = &other_bus};
+	struct mcp23016_poller *poller;
+	int rc;
+
+	mock_bus_init(&mock_bus, &(struct i2cd){0});
+	mock_bus_init(&other_bus, &(struct i2cd){0});
+
+	poller = mcp23016_poller_create(&mock_bus, &config);
+	assert_non_null(poller);
+
+	/* Check behavior when device is on another bus */
+	rc = mcp23016_poller_add_device(poller, &other_dev, NULL);
+
+	assert_int_equal(rc, -1);
+	assert_int_equal(errno, EINVAL);
+
+	/* Check behavior when no devices are added */
+	rc = mcp23016_poller_start(poller);
+
+	assert_int_equal(rc, -1);
+	assert_int_equal(errno, EINVAL);
+
+	mcp23016_poller_destroy(poller);
+}
+
+void test_mcp23016_poller_sample(void **state)
+{
+	struct mcp23016_bus mock_bus;
+	struct mcp23016_poller_config config = {
+		.min_period = 1000000,
+		.max_period = 3000000
+	};
+	struct mcp23016_device mock_dev0 = {.i2c_addr = BASE_ADDR, .bus = &mock_bus};
+	struct mcp23016_device mock_dev1 = {.i2c_addr = BASE_ADDR + 1, .bus = &mock_bus};
+	struct mcp23016_device *devs[] = {&mock_dev0, &mock_dev1};
+	uint8_t mock_read_bufs1[][2] = {{0x00, 0x00}, {0xff, 0x00}};
+	uint8_t mock_read_bufs2[][2] = {{0x01, 0x00}, {0xff, 0x00}};
+	struct poller_calls calls = {0};
+	struct mcp23016_poller_stats stats;
+	struct mcp23016_snapshot *snap;
+	struct mcp23016_poller *poller;
+	struct mcp23016_input input;
+	int rc;
+
+	mock_bus_init(&mock_bus, &(struct i2cd){0});
+	mock_dev0.i2c_dev = mock_bus.i2c_dev;
+	mock_dev1.i2c_dev = mock_bus.i2c_dev;
+
+	snap = mcp23016_snapshot_create();
+	assert_non_null(snap);
+
+	poller = mcp23016_poller_create(&mock_bus, &config);
+	assert_non_null(poller);
+
+	mcp23016_poller_add_device(poller, &mock_dev0, snap);
+	mcp23016_poller_add_device(poller, &mock_dev1, NULL);
+	mcp23016_poller_set_handler(poller, poller_handler, &calls);
+
+	expect_poller_sample(devs, ARRAY_SIZE(devs), mock_read_bufs1, 0);
+
+	/* Check behavior when initial port values are sampled */
+	rc = mcp23016_poller_sample(poller);
+
+	assert_return_code(rc, 0);
+	assert_int_equal(calls.n, 0);
+
+	mcp23016_poller_get_stats(poller, &stats);
+
+	assert_int_equal(stats.period, 2000000);
+
+	expect_poller_sample(devs, ARRAY_SIZE(devs), mock_read_bufs1, 0);
+
+	/* Check behavior when period reaches the maximum */
+	rc = mcp23016_poller_sample(poller);
+
+	assert_return_code(rc, 0);
+
+	mcp23016_poller_get_stats(poller, &stats);
+
+	assert_int_equal(stats.period, 3000000);
+
+	expect_poller_sample(devs, ARRAY_SIZE(devs), mock_read_bufs2, 0);
+
+	/* Check behavior when pins change state */
+	rc = mcp23016_poller_sample(poller);
+
+	assert_return_code(rc, 0);
+	assert_int_equal(calls.n, 1);
+	assert_ptr_equal(calls.calls[0].dev, &mock_dev0);
+	assert_int_equal(calls.calls[0].val, 0x0001);
+	assert_int_equal(calls.calls[0].changed, 0x0001);
+
+	mcp23016_snapshot_read(snap, &input);
+
+	assert_int_equal(input.sequence, 3);
+	assert_int_equal(input.port, 0x0001);
+
+	expect_poller_sample(devs, ARRAY_SIZE(devs), mock_read_bufs2, -1);
+
+	/* Check behavior when i2cd_transfer() fails */
+	rc = mcp23016_poller_sample(poller);
+
+	assert_int_equal(rc, -1);
+
+	mcp23016_poller_get_stats(poller, &stats);
+
+	assert_int_equal(stats.samples, 3);
+	assert_int_equal(stats.changes, 1);
+	assert_int_equal(stats.errors, 1);
+	assert_int_equal(stats.period, 1000000);
+
+	mcp23016_poller_destroy(poller);
+	mcp23016_snapshot_destroy(snap);
+}
+
+void test_mcp23016_poller_start(void **state)
+{
+	static const struct timespec delay = {.tv_nsec = 1000000};
+	struct mcp23016_bus mock_bus;
+	struct mcp23016_poller_config config = {
+		.min_period = 100000,
+		.max_period = 100000
+	};
+	struct mcp23016_device mock_dev = {.i2c_addr = BASE_ADDR, .bus = &mock_bus};
+	struct mcp23016_poller_stats stats;
+	struct mcp23016_poller *poller;
+	unsigned int i;
+	int rc;
+
+	mock_bus_init(&mock_bus, &(struct i2cd){0});
+	mock_dev.i2c_dev = mock_bus.i2c_dev;
+
+	hook(i2cd_transfer, sample_i2cd_transfer);
+
+	poller = mcp23016_poller_create(&mock_bus, &config);
+	assert_non_null(poller);
+
+	mcp23016_poller_add_device(poller, &mock_dev, NULL);
+
+	/* Check behavior when function succeeds */
+	rc = mcp23016_poller_start(poller);
+
+	assert_return_code(rc, 0);
+
+	for (i = 0; i < 1000; i++) {
+		mcp23016_poller_get_stats(poller, &stats);
+		if (stats.samples >= 2)
+			break;
+		nanosleep(&delay, NULL);
+	}
+
+	assert_true(stats.samples >= 2);
+	assert_int_equal(stats.changes, 0);
+
+	/* Check behavior when poller is started */
+	rc = mcp23016_poller_add_device(poller, &mock_dev, NULL);
+
+	assert_int_equal(rc, -1);
+	assert_int_equal(errno, EBUSY);
+
+	mcp23016_poller_destroy(poller);
+
+	hook(i2cd_transfer, mock_i2cd_transfer);
+}
+
+int main(void)
+{
+	const struct CMUnitTest tests[] = {
+		cmocka_unit_test(test_mcp23016_poller_create),
+		cmocka_unit_test(test_mcp23016_poller_create_invalid),
+		cmocka_unit_test(test_mcp23016_poller_add_device_invalid),
+		cmocka_unit_test(test_mcp23016_poller_sample),
+		cmocka_unit_test(test_mcp23016_poller_start)
+	};
+
+	return cmocka_run_group_tests(tests, setup, teardown);
+}
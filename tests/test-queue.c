@@ -0,0 +1,260 @@
+/* SPDX-License-Identifier: LGPL-2.1-or-later */
+/*
+ * Copyright (C) 2021 Steven Stallion <sstallion@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mcp23016-private.h"
+
+#include <errno.h>
+#include <poll.h>
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <cmocka.h>
+#include <i2cd.h>
+
+#include "hooks.h"
+#include "mocks.h"
+
+int setup(void **state)
+{
+	hook(i2cd_write, mock_i2cd_write);
+	hook(i2cd_write_read, mock_i2cd_write_read);
+	return 0;
+}
+
+int teardown(void **state)
+{
+	unhook(i2cd_write);
+	unhook(i2cd_write_read);
+	return 0;
+}
+
+static void mock_bus_init(struct mcp23016_bus *bus, struct i2cd *i2c_dev)
+{
+	bus->i2c_dev = i2c_dev;
+	atomic_init(&bus->refcnt, 1);
+}
+
+static size_t wait_reap(struct mcp23016_queue *queue, struct mcp23016_request **reqs, size_t n)
+{
+	struct pollfd pfd = {
+		.fd = mcp23016_queue_get_fd(queue),
+		.events = POLLIN
+	};
+	size_t i = 0;
+
+	while (i < n) {
+		assert_int_equal(poll(&pfd, 1, 1000), 1);
+		i += mcp23016_queue_reap(queue, &reqs[i], n - i);
+	}
+	return i;
+}
+
+static void request_callback(struct mcp23016_request *req, void *arg)
+{
+	unsigned int *calls = arg;
+
+	(*calls)++;
+}
+
+void test_mcp23016_queue_create(void **state)
+{
+	struct mcp23016_bus mock_bus;
+	struct mcp23016_queue *queue;
+
+	mock_bus_init(&mock_bus, &(struct i2cd){0});
+
+	/* Check behavior when function succeeds */
+	queue = mcp23016_queue_create(&mock_bus);
+
+	assert_non_null(queue);
+	assert_ptr_equal(queue->bus, &mock_bus);
+	assert_int_equal(atomic_load(&mock_bus.refcnt), 2);
+	assert_return_code(mcp23016_queue_get_fd(queue), 0);
+
+	mcp23016_queue_destroy(queue);
+
+	assert_int_equal(atomic_load(&mock_bus.refcnt), 1);
+}
+
+void test_mcp23016_queue_submit(void **state)
+{
+	struct mcp23016_bus mock_bus;
+	struct mcp23016_device mock_dev0 = {.i2c_addr = BASE_ADDR, .bus = &mock_bus};
+	struct mcp23016_device mock_dev1 = {.i2c_addr = BASE_ADDR + 1, .bus = &mock_bus};
+	struct mcp23016_request req0 = {
+		.dev = &mock_dev0,
+		.op = MCP23016_REQUEST_GET,
+		.reg = MCP23016_REGISTER_PORT
+	};
+	struct mcp23016_request req1 = {
+		.dev = &mock_dev1,
+		.op = MCP23016_REQUEST_SET,
+		.reg = MCP23016_REGISTER_OUTPUT,
+		.val = 0xaa55
+	};
+	struct mcp23016_request *reqs[2];
+	struct mcp23016_queue *queue;
+	uint8_t mock_write_buf0[] = {REG_GP0};
+	uint8_t mock_read_buf0[] = {0x34, 0x12};
+	uint8_t mock_write_buf1[] = {REG_OLAT0, 0x55, 0xaa};
+	int rc;
+
+	mock_bus_init(&mock_bus, &(struct i2cd){0});
+	mock_dev0.i2c_dev = mock_bus.i2c_dev;
+	mock_dev1.i2c_dev = mock_bus.i2c_dev;
+
+	expect_value(mock_i2cd_write_read, dev, mock_dev0.i2c_dev);
+	expect_value(mock_i2cd_write_read, addr, mock_dev0.i2c_addr);
+	expect_memory(mock_i2cd_write_read, write_buf, mock_write_buf0, sizeof(mock_write_buf0));
+	expect_value(mock_i2cd_write_read, write_len, sizeof(mock_write_buf0));
+	will_return(mock_i2cd_write_read, mock_read_buf0); /* read_buf */
+	expect_value(mock_i2cd_write_read, read_len, sizeof(mock_read_buf0));
+	will_return(mock_i2cd_write_read, 0);
+
+	expect_value(mock_i2cd_write, dev, mock_dev1.i2c_dev);
+	expect_value(mock_i2cd_write, addr, mock_dev1.i2c_addr);
+	expect_memory(mock_i2cd_write, buf, mock_write_buf1, sizeof(mock_write_buf1));
+	expect_value(mock_i2cd_write, len, sizeof(mock_write_buf1));
+	will_return(mock_i2cd_write, 0);
+
+	queue = mcp23016_queue_create(&mock_bus);
+	assert_non_null(queue);
+
+	/* Check behavior when function succeeds */
+	rc = mcp23016_queue_submit(queue, &req0);
+
+	assert_return_code(rc, 0);
+
+	rc = mcp23016_queue_submit(queue, &req1);
+
+	assert_return_code(rc, 0);
+
+	/* Check behavior when requests complete */
+	assert_int_equal(wait_reap(queue, reqs, ARRAY_SIZE(reqs)), 2);
+
+	assert_ptr_equal(reqs[0], &req0);
+	assert_int_equal(req0.error, 0);
+	assert_int_equal(req0.val, 0x1234);
+	assert_ptr_equal(reqs[1], &req1);
+	assert_int_equal(req1.error, 0);
+
+	/* Check behavior when no requests are complete */
+	assert_int_equal(mcp23016_queue_reap(queue, reqs, ARRAY_SIZE(reqs)), 0);
+
+	mcp23016_queue_destroy(queue);
+}
+
+void test_mcp23016_queue_submit_callback(void **state)
+{
+	struct mcp23016_bus mock_bus;
+	struct mcp23016_device mock_dev = {.i2c_addr = BASE_ADDR, .bus = &mock_bus};
+	unsigned int calls = 0;
+	struct mcp23016_request req = {
+		.dev = &mock_dev,
+		.op = MCP23016_REQUEST_SET,
+		.reg = MCP23016_REGISTER_DIRECTION,
+		.val = 0x00ff,
+		.fn = request_callback,
+		.arg = &calls
+	};
+	struct mcp23016_queue *queue;
+	uint8_t mock_write_buf[] = {REG_IODIR0, 0xff, 0x00};
+	int rc;
+
+	mock_bus_init(&mock_bus, &(struct i2cd){0});
+	mock_dev.i2c_dev = mock_bus.i2c_dev;
+
+	expect_value(mock_i2cd_write, dev, mock_dev.i2c_dev);
+	expect_value(mock_i2cd_write, addr, mock_dev.i2c_addr);
+	expect_memory(mock_i2cd_write, buf, mock_write_buf, sizeof(mock_write_buf));
+	expect_value(mock_i2cd_write, len, sizeof(mock_write_buf));
+	will_return(mock_i2cd_write, 0);
+
+	queue = mcp23016_queue_create(&mock_bus);
+	assert_non_null(queue);
+
+	/* Check behavior when completion function is set */
+	rc = mcp23016_queue_submit(queue, &req);
+
+	assert_return_code(rc, 0);
+
+	/* Pending requests are completed before the queue is destroyed. */
+	mcp23016_queue_destroy(queue);
+
+	assert_int_equal(calls, 1);
+	assert_int_equal(req.error, 0);
+}
+
+void test_mcp23016_queue_submit_invalid(void **state)
+{
+	struct mcp23016_bus mock_bus, other_bus;
+	struct mcp23016_device mock_dev = {.i2c_addr = BASE_ADDR, .bus = &mock_bus};
+	struct mcp23016_device other_dev = {.i2c_addr = BASE_ADDR, .bus = &other_bus};
+	struct mcp23016_request req = {0};
+	struct mcp23016_queue *queue;
+	int rc;
+
+	mock_bus_init(&mock_bus, &(struct i2cd){0});
+	mock_bus_init(&other_bus, &(struct i2cd){0});
+
+	queue = mcp23016_queue_create(&mock_bus);
+	assert_non_null(queue);
+
+	req.dev = &other_dev;
+	req.op = MCP23016_REQUEST_GET;
+	req.reg = MCP23016_REGISTER_PORT;
+
+	/* Check behavior when device is on another bus */
+	rc = mcp23016_queue_submit(queue, &req);
+
+	assert_int_equal(rc, -1);
+	assert_int_equal(errno, EINVAL);
+
+	req.dev = &mock_dev;
+	req.op = MCP23016_REQUEST_SET;
+	req.reg = MCP23016_REGISTER_INTERRUPT;
+
+	/* Check behavior when register is read-only */
+	rc = mcp23016_queue_submit(queue, &req);
+
+	assert_int_equal(rc, -1);
+	assert_int_equal(errno, EINVAL);
+
+	req.op = MCP23016_REQUEST_GET;
+	req.reg = MCP23016_REGISTER_CONTROL + 1;
+
+	/* Check behavior when register is invalid */
+	rc = mcp23016_queue_submit(queue, &req);
+
+	assert_int_equal(rc, -1);
+	assert_int_equal(errno, EINVAL);
+
+	mcp23016_queue_destroy(queue);
+}
+
+int main(void)
+{
+	const struct CMUnitTest tests[] = {
+		cmocka_unit_test(test_mcp23016_queue_create),
+		cmocka_unit_test(test_mcp23016_queue_submit),
+		cmocka_unit_test(test_mcp23016_queue_submit_callback),
+		cmocka_unit_test(test_mcp23016_queue_submit_invalid)
+	};
+
+	return cmocka_run_group_tests(tests, setup, teardown);
+}
@@ -0,0 +1,214 @@
+/* SPDX-License-Identifier: LGPL-2.1-or-later */
+/*
+ * Copyright (C) 2021 Steven Stallion <sstallion@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mcp23016-private.h"
+
+#include <errno.h>
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <cmocka.h>
+
+static struct mcp23016_event make_event(unsigned int n)
+{
+	struct mcp23016_event event = {
+		.timestamp = n,
+		.device = n % MCP23016_DEVICE_MAX,
+		.intcap = n,
+		.changed = ~n
+	};
+
+	return event;
+}
+
+static void assert_event_equal(const struct mcp23016_event *event, unsigned int n)
+{
+	assert_int_equal(event->timestamp, n);
+	assert_int_equal(event->device, n % MCP23016_DEVICE_MAX);
+	assert_int_equal(event->intcap, (uint16_t)n);
+	assert_int_equal(event->changed, (uint16_t)~n);
+}
+
+void test_mcp23016_ring_create(void **state)
+{
+	struct mcp23016_ring *ring;
+
+	/* Check behavior when function succeeds */
+	ring = mcp23016_ring_create(8);
+
+	assert_non_null(ring);
+	assert_int_equal((uintptr_t)ring % CACHE_LINE, 0);
+	assert_int_equal(mcp23016_ring_capacity(ring), 8);
+	assert_int_equal(mcp23016_ring_get_overflow(ring), 0);
+
+	mcp23016_ring_destroy(ring);
+}
+
+void test_mcp23016_ring_create_invalid(void **state)
+{
+	struct mcp23016_ring *ring;
+
+	/* Check behavior when capacity is zero */
+	ring = mcp23016_ring_create(0);
+
+	assert_null(ring);
+	assert_int_equal(errno, EINVAL);
+
+	/* Check behavior when capacity is not a power of two */
+	ring = mcp23016_ring_create(6);
+
+	assert_null(ring);
+	assert_int_equal(errno, EINVAL);
+}
+
+void test_mcp23016_ring_push_pop(void **state)
+{
+	struct mcp23016_ring *ring;
+	struct mcp23016_event event, events[4];
+	unsigned int i;
+	size_t n;
+	int rc;
+
+	ring = mcp23016_ring_create(4);
+	assert_non_null(ring);
+
+	/* Check behavior when ring is empty */
+	n = mcp23016_ring_pop(ring, events, ARRAY_SIZE(events));
+
+	assert_int_equal(n, 0);
+
+	for (i = 0; i < 3; i++) {
+		event = make_event(i);
+		rc = mcp23016_ring_push(ring, &event);
+
+		assert_return_code(rc, 0);
+	}
+
+	/* Check behavior when fewer events are requested than available */
+	n = mcp23016_ring_pop(ring, events, 2);
+
+	assert_int_equal(n, 2);
+	assert_event_equal(&events[0], 0);
+	assert_event_equal(&events[1], 1);
+
+	/* Check behavior when events wrap */
+	for (i = 3; i < 6; i++) {
+		event = make_event(i);
+		rc = mcp23016_ring_push(ring, &event);
+
+		assert_return_code(rc, 0);
+	}
+
+	n = mcp23016_ring_pop(ring, events, ARRAY_SIZE(events));
+
+	assert_int_equal(n, 4);
+	for (i = 0; i < n; i++)
+		assert_event_equal(&events[i], i + 2);
+
+	assert_int_equal(mcp23016_ring_get_overflow(ring), 0);
+
+	mcp23016_ring_destroy(ring);
+}
+
+void test_mcp23016_ring_push_overflow(void **state)
+{
+	struct mcp23016_ring *ring;
+	struct mcp23016_event event, events[2];
+	unsigned int i;
+	size_t n;
+	int rc;
+
+	ring = mcp23016_ring_create(2);
+	assert_non_null(ring);
+
+	for (i = 0; i < 2; i++) {
+		event = make_event(i);
+		rc = mcp23016_ring_push(ring, &event);
+
+		assert_return_code(rc, 0);
+	}
+
+	/* Check behavior when ring is full */
+	event = make_event(2);
+	rc = mcp23016_ring_push(ring, &event);
+
+	assert_int_equal(rc, -1);
+	assert_int_equal(errno, ENOBUFS);
+
+	rc = mcp23016_ring_push(ring, &event);
+
+	assert_int_equal(rc, -1);
+	assert_int_equal(mcp23016_ring_get_overflow(ring), 2);
+
+	/* Check behavior when space is made available */
+	n = mcp23016_ring_pop(ring, events, 1);
+
+	assert_int_equal(n, 1);
+	assert_event_equal(&events[0], 0);
+
+	rc = mcp23016_ring_push(ring, &event);
+
+	assert_return_code(rc, 0);
+
+	n = mcp23016_ring_pop(ring, events, ARRAY_SIZE(events));
+
+	assert_int_equal(n, 2);
+	assert_event_equal(&events[0], 1);
+	assert_event_equal(&events[1], 2);
+
+	mcp23016_ring_destroy(ring);
+}
+
+void test_mcp23016_ring_record(void **state)
+{
+	struct mcp23016_device mock_dev = {.i2c_addr = BASE_ADDR + 5};
+	struct mcp23016_ring *ring;
+	struct mcp23016_event events[2];
+	size_t n;
+
+	ring = mcp23016_ring_create(1);
+	assert_non_null(ring);
+
+	mcp23016_ring_record(ring, &mock_dev, 0x1234, 0x0204);
+	mcp23016_ring_record(ring, &mock_dev, 0x1230, 0x0004);
+
+	/* Check behavior when events are recorded */
+	n = mcp23016_ring_pop(ring, events, ARRAY_SIZE(events));
+
+	assert_int_equal(n, 1);
+	assert_int_not_equal(events[0].timestamp, 0);
+	assert_int_equal(events[0].device, 5);
+	assert_int_equal(events[0].intcap, 0x1234);
+	assert_int_equal(events[0].changed, 0x0204);
+	assert_int_equal(mcp23016_ring_get_overflow(ring), 1);
+
+	mcp23016_ring_destroy(ring);
+}
+
+int main(void)
+{
+	const struct CMUnitTest tests[] = {
+		cmocka_unit_test(test_mcp23016_ring_create),
+		cmocka_unit_test(test_mcp23016_ring_create_invalid),
+		cmocka_unit_test(test_mcp23016_ring_push_pop),
+		cmocka_unit_test(test_mcp23016_ring_push_overflow),
+		cmocka_unit_test(test_mcp23016_ring_record)
+	};
+
+	return cmocka_run_group_tests(tests, NULL, NULL);
+}
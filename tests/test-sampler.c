@@ -0,0 +1,368 @@
+/* SPDX-License-Identifier: LGPL-2.1-or-later */
+/*
+ * Copyright (C) 2021 Steven Stallion <sstallion@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mcp23016-private.h"
+
+#include <errno.h>
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include <cmocka.h>
+#include <i2cd.h>
+
+#include "hooks.h"
+#include "mocks.h"
+
+static atomic_uint sample_count;
+
+int setup(void **state)
+{
+	hook(i2cd_transfer, mock_i2cd_transfer);
+	return 0;
+}
+
+int teardown(void **state)
+{
+	unhook(i2cd_transfer);
+	return 0;
+}
+
+static void mock_bus_init(struct mcp23016_bus *bus, struct i2cd *i2c_dev)
+{
+	bus->i2c_dev = i2c_dev;
+	atomic_init(&bus->refcnt, 1);
+}
+
+/* Reads the number of transfers as the port value of each device; the
+ * sampler thread may take any number of samples.
+ */
+static int sample_i2cd_transfer(struct i2cd *dev, struct i2c_msg *msgs, size_t nmsgs)
+{
+	unsigned int count = atomic_fetch_add(&sample_count, 1);
+	size_t i;
+
+	for (i = 0; i < nmsgs; i++) {
+		if (msgs[i].flags & I2C_M_RD) {
+			msgs[i].buf[0] = LOW(count);
+			msgs[i].buf[1] = HIGH(count);
+		}
+	}
+	return 0;
+}
+
+void test_mcp23016_sampler_create(void **state)
+{
+	struct mcp23016_bus mock_bus;
+	struct mcp23016_sampler_config config = {
+		.period = 1000000,
+		.cpu = -1
+	};
+	struct mcp23016_sampler *sampler;
+
+	mock_bus_init(&mock_bus, &(struct i2cd){0});
+
+	/* Check behavior when function succeeds */
+	sampler = mcp23016_sampler_create(&mock_bus, &config);
+
+	assert_non_null(sampler);
+	assert_ptr_equal(sampler->bus, &mock_bus);
+	assert_int_equal(atomic_load(&mock_bus.refcnt), 2);
+
+	mcp23016_sampler_destroy(sampler);
+
+	assert_int_equal(atomic_load(&mock_bus.refcnt), 1);
+}
+
+void test_mcp23016_sampler_create_invalid(void **state)
+{
+	struct mcp23016_bus mock_bus;
+	struct mcp23016_sampler_config config = {
+		.period = 0,
+		.cpu = -1
+	};
+	struct mcp23016_sampler *sampler;
+
+	mock_bus_init(&mock_bus, &(struct i2cd){0});
+
+	/* Check behavior when period is zero */
+	sampler = mcp23016_sampler_create(&mock_bus, &config);
+
+	assert_null(sampler);
+	assert_int_equal(errno, EINVAL);
+
+	config.period = 1000000;
+	config.cpu = -2;
+
+	/* Check behavior when CPU is invalid */
+	sampler = mcp23016_sampler_create(&mock_bus, &config);
+
+	assert_null(sampler);
+	assert_int_equal(errno, EINVAL);
+	assert_int_equal(atomic_load(&mock_bus.refcnt), 1);
+}
+
+void test_mcp23016_sampler_start(void **state)
+{
+	static const struct timespec delay = {.tv_nsec = 1000000};
+	struct mcp23016_bus mock_bus;
+	struct mcp23016_sampler_config config = {
+		.period = 200000,
+		.cpu = 0
+	};
+	struct mcp23016_device mock_dev0 = {.i2c_addr = BASE_ADDR, .bus = &mock_bus};
+	struct mcp23016_device mock_dev1 = {.i2c_addr = BASE_ADDR + 3, .bus = &mock_bus};
+	struct mcp23016_sampler_stats stats;
+	struct mcp23016_sampler *sampler;
+	struct mcp23016_ring *ring;
+	struct mcp23016_event events[64];
+	size_t i, n;
+	int rc;
+
+	mock_bus_init(&mock_bus, &(struct i2cd){0});
+	mock_dev0.i2c_dev = mock_bus.i2c_dev;
+	mock_dev1.i2c_dev = mock_bus.i2c_dev;
+
+	atomic_init(&sample_count, 0);
+	hook(i2cd_transfer, sample_i2cd_transfer);
+
+	ring = mcp23016_ring_create(ARRAY_SIZE(events));
+	assert_non_null(ring);
+
+	sampler = mcp23016_sampler_create(&mock_bus, &config);
+	assert_non_null(sampler);
+
+	mcp23016_sampler_add_device(sampler, &mock_dev0);
+	mcp23016_sampler_add_device(sampler, &mock_dev1);
+
+	/* Check behavior when function succeeds */
+	rc = mcp23016_sampler_start(sampler, ring);
+
+	assert_return_code(rc, 0);
+
+	for (i = 0; i < 1000; i++) {
+		mcp23016_sampler_get_stats(sampler, &stats);
+		if (stats.samples >= 4)
+			break;
+		nanosleep(&delay, NULL);
+	}
+
+	/* Check behavior when sampler is started */
+	rc = mcp23016_sampler_add_device(sampler, &mock_dev0);
+
+	assert_int_equal(rc, -1);
+	assert_int_equal(errno, EBUSY);
+
+	mcp23016_sampler_destroy(sampler);
+
+	n = mcp23016_ring_pop(ring, events, ARRAY_SIZE(events));
+
+	assert_true(n >= 8);
+	assert_int_equal(n % 2, 0);
+
+	for (i = 0; i < n; i += 2) {
+		assert_int_equal(events[i].device, 0);
+		assert_int_equal(events[i + 1].device, 3);
+		assert_int_equal(events[i].timestamp, events[i + 1].timestamp);
+		assert_int_equal(events[i].intcap, i / 2 + 1);
+		assert_int_equal(events[i].changed, (i / 2 + 1) ^ (i / 2));
+		if (i > 0)
+			assert_true(events[i].timestamp > events[i - 2].timestamp);
+	}
+
+	mcp23016_ring_destroy(ring);
+
+	hook(i2cd_transfer, mock_i2cd_transfer);
+}
+
+void test_mcp23016_sampler_start_capture(void **state)
+{
+	static const struct timespec delay = {.tv_nsec = 1000000};
+	char path[] = "/tmp/test-sampler-XXXXXX";
+	struct mcp23016_bus mock_bus;
+	struct mcp23016_sampler_config config = {
+		.period = 200000,
+		.cpu = -1
+	};
+	struct mcp23016_capture_info info = {
+		.devices = {0, 3},
+		.num_devices = 2,
+		.period = 200000,
+		.clock = CLOCK_MONOTONIC,
+		.capacity = 64
+	};
+	struct mcp23016_device mock_dev0 = {.i2c_addr = BASE_ADDR, .bus = &mock_bus};
+	struct mcp23016_device mock_dev1 = {.i2c_addr = BASE_ADDR + 3, .bus = &mock_bus};
+	struct mcp23016_sampler_stats stats;
+	struct mcp23016_sampler *sampler;
+	struct mcp23016_capture *cap;
+	uint16_t vals[MCP23016_DEVICE_MAX];
+	uint64_t timestamp, last = 0;
+	uint64_t i, n;
+	int fd, rc;
+
+	mock_bus_init(&mock_bus, &(struct i2cd){0});
+	mock_dev0.i2c_dev = mock_bus.i2c_dev;
+	mock_dev1.i2c_dev = mock_bus.i2c_dev;
+
+	fd = mkstemp(path);
+	assert_return_code(fd, 0);
+	close(fd);
+
+	atomic_init(&sample_count, 0);
+	hook(i2cd_transfer, sample_i2cd_transfer);
+
+	cap = mcp23016_capture_create(path, &info);
+	assert_non_null(cap);
+
+	sampler = mcp23016_sampler_create(&mock_bus, &config);
+	assert_non_null(sampler);
+
+	mcp23016_sampler_add_device(sampler, &mock_dev1);
+	mcp23016_sampler_add_device(sampler, &mock_dev0);
+	mcp23016_sampler_set_capture(sampler, cap);
+
+	/* Check behavior when devices do not match the capture file */
+	rc = mcp23016_sampler_start(sampler, NULL);
+
+	assert_int_equal(rc, -1);
+	assert_int_equal(errno, EINVAL);
+
+	mcp23016_sampler_destroy(sampler);
+
+	sampler = mcp23016_sampler_create(&mock_bus, &config);
+	assert_non_null(sampler);
+
+	mcp23016_sampler_add_device(sampler, &mock_dev0);
+	mcp23016_sampler_add_device(sampler, &mock_dev1);
+
+	/* Check behavior when neither a ring nor a capture file is given */
+	rc = mcp23016_sampler_start(sampler, NULL);
+
+	assert_int_equal(rc, -1);
+	assert_int_equal(errno, EINVAL);
+
+	mcp23016_sampler_set_capture(sampler, cap);
+
+	/* Check behavior when function succeeds */
+	rc = mcp23016_sampler_start(sampler, NULL);
+
+	assert_return_code(rc, 0);
+
+	for (i = 0; i < 1000; i++) {
+		mcp23016_sampler_get_stats(sampler, &stats);
+		if (stats.samples >= 4)
+			break;
+		nanosleep(&delay, NULL);
+	}
+
+	/* Check behavior when sampler is started */
+	rc = mcp23016_sampler_set_capture(sampler, NULL);
+
+	assert_int_equal(rc, -1);
+	assert_int_equal(errno, EBUSY);
+
+	mcp23016_sampler_destroy(sampler);
+
+	n = mcp23016_capture_count(cap);
+
+	assert_true(n >= 4);
+
+	for (i = 0; i < n; i++) {
+		rc = mcp23016_capture_read(cap, i, &timestamp, vals);
+
+		assert_return_code(rc, 0);
+		assert_int_equal(vals[0], i + 1);
+		assert_int_equal(vals[1], i + 1);
+		assert_true(timestamp > last);
+		last = timestamp;
+	}
+
+	mcp23016_capture_close(cap);
+	unlink(path);
+
+	hook(i2cd_transfer, mock_i2cd_transfer);
+}
+
+void test_mcp23016_sampler_start_fail(void **state)
+{
+	struct mcp23016_bus mock_bus;
+	struct mcp23016_sampler_config config = {
+		.period = 1000000,
+		.cpu = -1
+	};
+	struct mcp23016_device mock_dev = {.i2c_addr = BASE_ADDR, .bus = &mock_bus};
+	struct mcp23016_device other_dev = {.i2c_addr = BASE_ADDR};
+	struct mcp23016_sampler *sampler;
+	struct mcp23016_ring *ring;
+	uint8_t reg = REG_GP0;
+	uint8_t mock_read_buf[] = {0x55, 0xaa};
+	int rc;
+
+	mock_bus_init(&mock_bus, &(struct i2cd){0});
+	mock_dev.i2c_dev = mock_bus.i2c_dev;
+
+	ring = mcp23016_ring_create(4);
+	assert_non_null(ring);
+
+	sampler = mcp23016_sampler_create(&mock_bus, &config);
+	assert_non_null(sampler);
+
+	/* Check behavior when no devices are added */
+	rc = mcp23016_sampler_start(sampler, ring);
+
+	assert_int_equal(rc, -1);
+	assert_int_equal(errno, EINVAL);
+
+	/* Check behavior when device is on another bus */
+	rc = mcp23016_sampler_add_device(sampler, &other_dev);
+
+	assert_int_equal(rc, -1);
+	assert_int_equal(errno, EINVAL);
+
+	mcp23016_sampler_add_device(sampler, &mock_dev);
+
+	expect_value(mock_i2cd_transfer, dev, mock_dev.i2c_dev);
+	expect_value(mock_i2cd_transfer, nmsgs, 2);
+	expect_i2cd_transfer_write(mock_dev.i2c_addr, &reg, 1);
+	expect_i2cd_transfer_read(mock_dev.i2c_addr, mock_read_buf, 2);
+	will_return(mock_i2cd_transfer, -1);
+
+	/* Check behavior when i2cd_transfer() fails */
+	rc = mcp23016_sampler_start(sampler, ring);
+
+	assert_int_equal(rc, -1);
+
+	mcp23016_sampler_destroy(sampler);
+	mcp23016_ring_destroy(ring);
+}
+
+int main(void)
+{
+	const struct CMUnitTest tests[] = {
+		cmocka_unit_test(test_mcp23016_sampler_create),
+		cmocka_unit_test(test_mcp23016_sampler_create_invalid),
+		cmocka_unit_test(test_mcp23016_sampler_start),
+		cmocka_unit_test(test_mcp23016_sampler_start_capture),
+		cmocka_unit_test(test_mcp23016_sampler_start_fail)
+	};
+
+	return cmocka_run_group_tests(tests, setup, teardown);
+}
@@ -0,0 +1,130 @@
+/* SPDX-License-Identifier: LGPL-2.1-or-later */
+/*
+ * Copyright (C) 2021 Steven Stallion <sstallion@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mcp23016-private.h"
+
+#include <pthread.h>
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <cmocka.h>
+
+#define PUBLISH_COUNT	100000
+
+static void *publish_thread(void *arg)
+{
+	struct mcp23016_snapshot *snap = arg;
+	unsigned int i;
+
+	for (i = 1; i <= PUBLISH_COUNT; i++)
+		mcp23016_snapshot_publish(snap, i, ~i);
+
+	return NULL;
+}
+
+void test_mcp23016_snapshot_create(void **state)
+{
+	struct mcp23016_snapshot *snap;
+	struct mcp23016_input input;
+
+	/* Check behavior when function succeeds */
+	snap = mcp23016_snapshot_create();
+
+	assert_non_null(snap);
+	assert_int_equal((uintptr_t)snap % CACHE_LINE, 0);
+
+	mcp23016_snapshot_read(snap, &input);
+
+	assert_int_equal(input.sequence, 0);
+	assert_int_equal(input.timestamp, 0);
+	assert_int_equal(input.port, 0);
+	assert_int_equal(input.intcap, 0);
+
+	mcp23016_snapshot_destroy(snap);
+}
+
+void test_mcp23016_snapshot_publish(void **state)
+{
+	struct mcp23016_snapshot *snap;
+	struct mcp23016_input input;
+	uint64_t timestamp;
+
+	snap = mcp23016_snapshot_create();
+	assert_non_null(snap);
+
+	/* Check behavior when function succeeds */
+	mcp23016_snapshot_publish(snap, 0x1234, 0x5678);
+	mcp23016_snapshot_read(snap, &input);
+
+	assert_int_equal(input.sequence, 1);
+	assert_int_not_equal(input.timestamp, 0);
+	assert_int_equal(input.port, 0x1234);
+	assert_int_equal(input.intcap, 0x5678);
+
+	timestamp = input.timestamp;
+
+	mcp23016_snapshot_publish(snap, 0xaa55, 0x55aa);
+	mcp23016_snapshot_read(snap, &input);
+
+	assert_int_equal(input.sequence, 2);
+	assert_true(input.timestamp >= timestamp);
+	assert_int_equal(input.port, 0xaa55);
+	assert_int_equal(input.intcap, 0x55aa);
+
+	mcp23016_snapshot_destroy(snap);
+}
+
+void test_mcp23016_snapshot_concurrent(void **state)
+{
+	struct mcp23016_snapshot *snap;
+	struct mcp23016_input input;
+	uint64_t sequence = 0;
+	pthread_t thread;
+
+	snap = mcp23016_snapshot_create();
+	assert_non_null(snap);
+
+	assert_int_equal(pthread_create(&thread, NULL, publish_thread, snap), 0);
+
+	/* Check behavior when snapshot is published while being read */
+	while (sequence < PUBLISH_COUNT) {
+		mcp23016_snapshot_read(snap, &input);
+
+		assert_true(input.sequence >= sequence);
+		assert_int_equal(input.port, (uint16_t)input.sequence);
+		if (input.sequence != 0)
+			assert_int_equal(input.intcap, (uint16_t)~input.sequence);
+
+		sequence = input.sequence;
+	}
+
+	pthread_join(thread, NULL);
+
+	mcp23016_snapshot_destroy(snap);
+}
+
+int main(void)
+{
+	const struct CMUnitTest tests[] = {
+		cmocka_unit_test(test_mcp23016_snapshot_create),
+		cmocka_unit_test(test_mcp23016_snapshot_publish),
+		cmocka_unit_test(test_mcp23016_snapshot_concurrent)
+	};
+
+	return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -0,0 +1,164 @@
+/* SPDX-License-Identifier: LGPL-2.1-or-later */
+/*
+ * Copyright (C) 2021 Steven Stallion <sstallion@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mcp23016-private.h"
+
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <string.h>
+#include <cmocka.h>
+
+#define SAMPLE_MAX	1000
+
+static uint16_t samples[SAMPLE_MAX];
+static uint64_t bits[16 * ((SAMPLE_MAX + 63) / 64)];
+
+/* Samples are generated by a linear congruential generator so that every
+ * pin takes both states.
+ */
+static void make_samples(size_t n)
+{
+	uint32_t x = 0x12345678;
+	size_t i;
+
+	for (i = 0; i < n; i++) {
+		x = x * 1103515245 + 12345;
+		samples[i] = x >> 16;
+	}
+}
+
+static void assert_bits_equal(size_t n)
+{
+	size_t words = mcp23016_bitstream_words(n);
+	size_t i, k;
+
+	for (k = 0; k < 16; k++) {
+		for (i = 0; i < n; i++)
+			assert_int_equal((bits[k * words + i / 64] >> (i % 64)) & 1,
+					 (samples[i] >> k) & 1);
+		if (n % 64 != 0)
+			assert_int_equal(bits[k * words + words - 1] >> (n % 64), 0);
+	}
+}
+
+void test_mcp23016_bitstream_words(void **state)
+{
+	/* Check behavior when function succeeds */
+	assert_int_equal(mcp23016_bitstream_words(0), 0);
+	assert_int_equal(mcp23016_bitstream_words(1), 1);
+	assert_int_equal(mcp23016_bitstream_words(64), 1);
+	assert_int_equal(mcp23016_bitstream_words(65), 2);
+}
+
+void test_mcp23016_transpose(void **state)
+{
+	static const size_t sizes[] = {1, 15, 63, 64, 65, 128, 200, SAMPLE_MAX};
+	uint16_t vals[SAMPLE_MAX];
+	size_t i, n;
+
+	/* Check behavior when function succeeds */
+	for (i = 0; i < ARRAY_SIZE(sizes); i++) {
+		n = sizes[i];
+		make_samples(n);
+		memset(bits, 0xff, sizeof(bits));
+
+		mcp23016_transpose(samples, n, bits);
+
+		assert_bits_equal(n);
+
+		mcp23016_untranspose(bits, n, vals);
+
+		assert_memory_equal(vals, samples, n * sizeof(*vals));
+	}
+}
+
+void test_mcp23016_bitstream_high(void **state)
+{
+	uint64_t high;
+	size_t words, i, k;
+
+	make_samples(SAMPLE_MAX);
+	mcp23016_transpose(samples, SAMPLE_MAX, bits);
+	words = mcp23016_bitstream_words(SAMPLE_MAX);
+
+	/* Check behavior when function succeeds */
+	for (k = 0; k < 16; k++) {
+		high = 0;
+		for (i = 0; i < SAMPLE_MAX; i++)
+			high += (samples[i] >> k) & 1;
+
+		assert_int_equal(mcp23016_bitstream_high(bits + k * words, SAMPLE_MAX), high);
+	}
+
+	/* Check behavior when bits beyond the last sample are set */
+	bits[0] = UINT64_MAX;
+
+	assert_int_equal(mcp23016_bitstream_high(bits, 10), 10);
+}
+
+void test_mcp23016_bitstream_edges(void **state)
+{
+	uint64_t rising, falling, r, f;
+	size_t words, i, k;
+
+	make_samples(SAMPLE_MAX);
+	mcp23016_transpose(samples, SAMPLE_MAX, bits);
+	words = mcp23016_bitstream_words(SAMPLE_MAX);
+
+	/* Check behavior when function succeeds */
+	for (k = 0; k < 16; k++) {
+		r = 0;
+		f = 0;
+		for (i = 1; i < SAMPLE_MAX; i++) {
+			r += !((samples[i - 1] >> k) & 1) && ((samples[i] >> k) & 1);
+			f += ((samples[i - 1] >> k) & 1) && !((samples[i] >> k) & 1);
+		}
+
+		mcp23016_bitstream_edges(bits + k * words, SAMPLE_MAX, &rising, &falling);
+
+		assert_int_equal(rising, r);
+		assert_int_equal(falling, f);
+	}
+
+	/* Check behavior when first sample is high */
+	bits[0] = 0x3;
+
+	mcp23016_bitstream_edges(bits, 4, &rising, &falling);
+
+	assert_int_equal(rising, 0);
+	assert_int_equal(falling, 1);
+
+	/* Check behavior when no samples are given */
+	mcp23016_bitstream_edges(bits, 0, &rising, &falling);
+
+	assert_int_equal(rising, 0);
+	assert_int_equal(falling, 0);
+}
+
+int main(void)
+{
+	const struct CMUnitTest tests[] = {
+		cmocka_unit_test(test_mcp23016_bitstream_words),
+		cmocka_unit_test(test_mcp23016_transpose),
+		cmocka_unit_test(test_mcp23016_bitstream_high),
+		cmocka_unit_test(test_mcp23016_bitstream_edges)
+	};
+
+	return cmocka_run_group_tests(tests, NULL, NULL);
+}
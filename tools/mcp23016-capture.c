@@ -0,0 +1,137 @@
+/* SPDX-License-Identifier: LGPL-2.1-or-later */
+/*
+ * Copyright (C) 2021 Steven Stallion <sstallion@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Prints the records of a capture file as CSV, one line per record with the
+ * timestamp followed by the port value of each device. The description of
+ * the capture file is printed first as comment lines unless -q is given.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <errno.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <mcp23016.h>
+
+static void usage(const char *progname)
+{
+	fprintf(stderr, "usage: %s [-q] file\n", progname);
+}
+
+static const char *clock_name(clockid_t clock)
+{
+	switch (clock) {
+	case CLOCK_REALTIME:
+		return "realtime";
+	case CLOCK_MONOTONIC:
+		return "monotonic";
+	case CLOCK_BOOTTIME:
+		return "boottime";
+	default:
+		return "unknown";
+	}
+}
+
+static void print_info(const struct mcp23016_capture_info *info, uint64_t count)
+{
+	size_t i;
+
+	printf("# devices:");
+	for (i = 0; i < info->num_devices; i++)
+		printf(" %u", info->devices[i]);
+	printf("\n");
+	printf("# period: %" PRIu64 "\n", info->period);
+	printf("# clock: %s\n", clock_name(info->clock));
+	printf("# capacity: %" PRIu64 "%s\n", info->capacity,
+	       (info->flags & MCP23016_CAPTURE_WRAP) ? " (wrap)" : "");
+	printf("# records: %" PRIu64 "\n", count);
+
+	printf("timestamp");
+	for (i = 0; i < info->num_devices; i++)
+		printf(",port%u", info->devices[i]);
+	printf("\n");
+}
+
+int main(int argc, char *argv[])
+{
+	struct mcp23016_capture_info info;
+	struct mcp23016_capture *cap;
+	uint16_t vals[MCP23016_DEVICE_MAX];
+	uint64_t first, count, timestamp, record;
+	int quiet = 0;
+	size_t i;
+	int opt;
+
+	while ((opt = getopt(argc, argv, "q")) != -1) {
+		switch (opt) {
+		case 'q':
+			quiet = 1;
+			break;
+		default:
+			usage(argv[0]);
+			return EXIT_FAILURE;
+		}
+	}
+
+	if (optind != argc - 1) {
+		usage(argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	cap = mcp23016_capture_open(argv[optind]);
+	if (cap == NULL) {
+		fprintf(stderr, "%s: %s\n", argv[optind], strerror(errno));
+		return EXIT_FAILURE;
+	}
+
+	mcp23016_capture_get_info(cap, &info);
+	first = mcp23016_capture_first(cap);
+	count = mcp23016_capture_count(cap);
+	if (!quiet)
+		print_info(&info, count);
+
+	/* Records are read by number so that records appended while reading
+	 * do not shift those that remain; records overwritten while reading
+	 * a capture file that is still being appended to are skipped.
+	 */
+	for (record = first; record < first + count; record++) {
+		if (mcp23016_capture_read_record(cap, record, &timestamp, vals) < 0) {
+			if (errno == EAGAIN)
+				continue;
+			fprintf(stderr, "%s: %s\n", argv[optind], strerror(errno));
+			mcp23016_capture_close(cap);
+			return EXIT_FAILURE;
+		}
+
+		printf("%" PRIu64, timestamp);
+		for (i = 0; i < info.num_devices; i++)
+			printf(",0x%04" PRIx16, vals[i]);
+		printf("\n");
+	}
+
+	mcp23016_capture_close(cap);
+
+	return EXIT_SUCCESS;
+}